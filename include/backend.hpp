@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdlib.h> // for malloc
+#include <string.h> // for memcpy
+#include <chrono> // for backend timing
+
+// Solver backends behind one interface, for tools that run the same batch on the CPU and on the
+// GPU.
+//
+// A backend owns its memory: buffers come from allocate and are filled and read back with
+// copy_to_backend and copy_to_host (memcpy for the CPU backends, hipMemcpy for rocSOLVER).
+// solve_eigen, solve_eigen_dc and solve_svd take backend buffers and may return before the work is done;
+// synchronize waits for it, and backend_timer_start / backend_timer_stop synchronize on both
+// ends so the time covers the solve only. Only the backends whose library is available are
+// compiled; backends.hpp lists them.
+
+// A strided batch. Eigen problems are N x N (M == N): A is overwritten with the eigenvectors and
+// W gets the N eigenvalues of every matrix in ascending order; solve_eigen_dc solves the same problem
+// by divide and conquer (ssyevd) and is NULL on the backends without it. SVD (economy size, k = min(M, N)):
+// S gets k singular values in descending order, U is M x k (ldu = M) and VT is k x N (ldvt = k),
+// strideS = k, strideU = M * k and strideVT = k * N. QR (geqrf, double like the rocSOLVER
+// geqrf benchmarks): A is overwritten with R and the reflectors, tau gets k scalars (strideP = k).
+struct BatchShape {
+  int M, N, lda;
+  size_t strideA;
+  int batch_count;
+  float tolerance;   // Jacobi backends; <= 0: machine precision
+  int max_sweeps;    // Jacobi backends
+};
+
+struct SolverBackend {
+  const char *name;
+  const char *description;
+  void *(*allocate)(size_t bytes);
+  void (*release)(void *ptr);
+  void (*copy_to_backend)(void *dst, const void *src, size_t bytes);
+  void (*copy_to_host)(void *dst, const void *src, size_t bytes);
+  void (*solve_eigen)(const BatchShape &shape, float *A, float *W, int *info);
+  void (*solve_eigen_dc)(const BatchShape &shape, float *A, float *W, int *info);
+  void (*solve_svd)(const BatchShape &shape, float *A, float *S, float *U, float *VT, int *info);
+  void (*solve_qr)(const BatchShape &shape, double *A, double *tau);
+  void (*synchronize)();
+};
+
+// Memory and synchronisation of the backends running on the host.
+inline void *host_allocate(size_t bytes) {
+  return malloc(bytes);
+}
+
+inline void host_release(void *ptr) {
+  free(ptr);
+}
+
+inline void host_copy(void *dst, const void *src, size_t bytes) {
+  memcpy(dst, src, bytes);
+}
+
+inline void host_synchronize() {
+}
+
+inline std::chrono::steady_clock::time_point backend_timer_start(const SolverBackend &backend) {
+  backend.synchronize();
+  return std::chrono::steady_clock::now();
+}
+
+// Milliseconds since backend_timer_start, after the backend's work has finished.
+inline float backend_timer_stop(const SolverBackend &backend, std::chrono::steady_clock::time_point start) {
+  backend.synchronize();
+  return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
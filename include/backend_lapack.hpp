@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdlib.h> // for malloc
+#include <string> // for backend names
+
+#include "backend.hpp"
+#include "lapack_provider.hpp" // for the dlopen'ed providers
+
+// A LAPACK provider loaded at run time as a backend, named "lapack:<provider>" (a provider name or
+// a library path, see lapack_provider.hpp): ssyev, ssyevd, economy-size sgesvd and dgeqrf, one matrix per
+// OpenMP iteration with thread-local workspaces, as the openblas backend. The provider's own
+// threading is set to 1 thread when it can be, since the batch is parallelised here.
+//
+// Backends have no context pointer, so every loaded provider takes one of a few slots whose
+// functions are instantiated per slot.
+
+const int LAPACK_BACKEND_SLOTS = 4;
+
+struct LapackBackendSlot {
+  LapackProvider provider;
+  std::string name;
+  std::string description;
+  SolverBackend backend;
+};
+
+inline LapackBackendSlot *lapack_backend_slots() {
+  static LapackBackendSlot slots[LAPACK_BACKEND_SLOTS];
+  return slots;
+}
+
+template <int Slot>
+void lapack_solve_eigen(const BatchShape &shape, float *A, float *W, int *info) {
+  const LapackProvider &p = lapack_backend_slots()[Slot].provider;
+  int N = shape.N, lda = shape.lda;
+  int query = -1, lwork, query_info;
+  float work_query;
+  p.ssyev("V", "U", &N, NULL, &lda, NULL, &work_query, &query, &query_info, 1, 1);
+  lwork = (int)work_query;
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      p.ssyev("V", "U", &N, A + b * shape.strideA, &lda, W + (size_t)b * N, thread_work, &lwork, info + b, 1, 1);
+    }
+
+    free(thread_work);
+  }
+}
+
+template <int Slot>
+void lapack_solve_eigen_dc(const BatchShape &shape, float *A, float *W, int *info) {
+  const LapackProvider &p = lapack_backend_slots()[Slot].provider;
+  int N = shape.N, lda = shape.lda;
+  int query = -1, lwork, liwork, iwork_query, query_info;
+  float work_query;
+  p.ssyevd("V", "U", &N, NULL, &lda, NULL, &work_query, &query, &iwork_query, &query, &query_info, 1, 1);
+  lwork = (int)work_query;
+  liwork = iwork_query;
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+    int *thread_iwork = (int*)malloc(sizeof(int) * liwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      p.ssyevd("V", "U", &N, A + b * shape.strideA, &lda, W + (size_t)b * N, thread_work, &lwork,
+               thread_iwork, &liwork, info + b, 1, 1);
+    }
+
+    free(thread_work);
+    free(thread_iwork);
+  }
+}
+
+template <int Slot>
+void lapack_solve_svd(const BatchShape &shape, float *A, float *S, float *U, float *VT, int *info) {
+  const LapackProvider &p = lapack_backend_slots()[Slot].provider;
+  int M = shape.M, N = shape.N, lda = shape.lda;
+  int k = (M < N) ? M : N;
+  size_t strideU = (size_t)M * k, strideVT = (size_t)k * N;
+  int query = -1, lwork, query_info;
+  float work_query;
+  p.sgesvd("S", "S", &M, &N, NULL, &lda, NULL, NULL, &M, NULL, &k, &work_query, &query, &query_info, 1, 1);
+  lwork = (int)work_query;
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      p.sgesvd("S", "S", &M, &N, A + b * shape.strideA, &lda, S + (size_t)b * k, U + b * strideU, &M,
+               VT + b * strideVT, &k, thread_work, &lwork, info + b, 1, 1);
+    }
+
+    free(thread_work);
+  }
+}
+
+template <int Slot>
+void lapack_solve_qr(const BatchShape &shape, double *A, double *tau) {
+  const LapackProvider &p = lapack_backend_slots()[Slot].provider;
+  int M = shape.M, N = shape.N, lda = shape.lda;
+  int k = (M < N) ? M : N;
+  int query = -1, lwork, query_info;
+  double work_query;
+  p.dgeqrf(&M, &N, NULL, &lda, NULL, &work_query, &query, &query_info);
+  lwork = (int)work_query;
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    double *thread_work = (double*)malloc(sizeof(double) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      int qr_info;
+      p.dgeqrf(&M, &N, A + b * shape.strideA, &lda, tau + (size_t)b * k, thread_work, &lwork, &qr_info);
+    }
+
+    free(thread_work);
+  }
+}
+
+template <int Slot>
+void lapack_fill_slot(LapackBackendSlot *slot) {
+  slot->backend = {slot->name.c_str(), slot->description.c_str(),
+                   host_allocate, host_release, host_copy, host_copy,
+                   lapack_solve_eigen<Slot>, lapack_solve_eigen_dc<Slot>, lapack_solve_svd<Slot>, lapack_solve_qr<Slot>, host_synchronize};
+}
+
+// The backend of a provider, loading it on first use. NULL with the reason in error when the
+// provider cannot be loaded or all slots are taken.
+inline const SolverBackend *lapack_backend(const std::string &provider, std::string *error) {
+  LapackBackendSlot *slots = lapack_backend_slots();
+  int slot = 0;
+  for (; slot < LAPACK_BACKEND_SLOTS && slots[slot].provider.handle; ++slot) {
+    if (slots[slot].provider.name == provider) return &slots[slot].backend;
+  }
+  if (slot == LAPACK_BACKEND_SLOTS) {
+    *error = "at most " + std::to_string(LAPACK_BACKEND_SLOTS) + " LAPACK providers can be loaded";
+    return NULL;
+  }
+
+  LapackBackendSlot *s = &slots[slot];
+  if (!lapack_provider_open(provider, &s->provider, error)) return NULL;
+  bool threads_set = lapack_provider_set_threads(s->provider, 1);
+  s->name = "lapack:" + provider;
+  s->description = s->provider.path + (s->provider.config.empty() ? "" : " (" + s->provider.config + ")") +
+                   (threads_set ? ", 1 thread per call" : ", threading not controllable");
+
+  switch (slot) {
+    case 0: lapack_fill_slot<0>(s); break;
+    case 1: lapack_fill_slot<1>(s); break;
+    case 2: lapack_fill_slot<2>(s); break;
+    case 3: lapack_fill_slot<3>(s); break;
+  }
+  return &s->backend;
+}
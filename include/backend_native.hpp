@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdlib.h> // for malloc
+#include <cmath> // for sqrt
+
+#include "backend.hpp"
+#include "jacobi_cpu.hpp" // for the native Jacobi engine
+
+// The native CPU Jacobi engine as a backend: one matrix per OpenMP iteration with thread-local
+// workspaces. Needs no external library, so it is always available.
+
+inline void native_solve_eigen(const BatchShape &shape, float *A, float *W, int *info) {
+  size_t lwork = jacobi_ssyevj_workspace_size(shape.N);
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      float residual;
+      int n_sweeps;
+      jacobi_ssyevj(true, true, 'U', shape.N, A + b * shape.strideA, shape.lda, shape.tolerance, &residual,
+                    shape.max_sweeps, &n_sweeps, W + (size_t)b * shape.N, info + b, thread_work);
+    }
+
+    free(thread_work);
+  }
+}
+
+inline void native_solve_svd(const BatchShape &shape, float *A, float *S, float *U, float *VT, int *info) {
+  int M = shape.M, N = shape.N;
+  int k = (M < N) ? M : N;
+  size_t strideU = (size_t)M * k, strideVT = (size_t)k * N;
+  size_t lwork = jacobi_sgesvdj_workspace_size(M, N);
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      float residual;
+      int n_sweeps;
+      jacobi_sgesvdj('S', 'S', M, N, A + b * shape.strideA, shape.lda, shape.tolerance, &residual,
+                     shape.max_sweeps, &n_sweeps, S + (size_t)b * k, U + b * strideU, M,
+                     VT + b * strideVT, k, info + b, thread_work);
+    }
+
+    free(thread_work);
+  }
+}
+
+// Unblocked Householder QR of one matrix (LAPACK dgeqr2): H(j) = I - tau v v', v(j) = 1. The
+// reflector updates use the ISA-dispatched kernels (native_kernels.hpp).
+inline void native_dgeqr2(int M, int N, double *A, int lda, double *tau) {
+  int k = (M < N) ? M : N;
+  for (int j = 0; j < k; ++j) {
+    double *x = A + j + (size_t)j * lda;
+    double xnorm = 0.0;
+    for (int i = 1; i < M - j; ++i) xnorm += x[i] * x[i];
+    if (xnorm == 0.0) {
+      tau[j] = 0.0;
+      continue;
+    }
+    double alpha = x[0];
+    double beta = -copysign(sqrt(alpha * alpha + xnorm), alpha);
+    tau[j] = (beta - alpha) / beta;
+    double scale = 1.0 / (alpha - beta);
+    for (int i = 1; i < M - j; ++i) x[i] *= scale;
+    x[0] = beta;
+
+    // apply H(j) to the trailing columns
+    const NativeKernels &kernels = native_kernels();
+    for (int c = j + 1; c < N; ++c) {
+      double *y = A + j + (size_t)c * lda;
+      double dot = tau[j] * (y[0] + kernels.ddot(M - j - 1, x + 1, y + 1));
+      y[0] -= dot;
+      kernels.daxpy(M - j - 1, -dot, x + 1, y + 1);
+    }
+  }
+}
+
+inline void native_solve_qr(const BatchShape &shape, double *A, double *tau) {
+  int k = (shape.M < shape.N) ? shape.M : shape.N;
+
+  #pragma omp parallel for
+  for (int b = 0; b < shape.batch_count; ++b) {
+    native_dgeqr2(shape.M, shape.N, A + b * shape.strideA, shape.lda, tau + (size_t)b * k);
+  }
+}
+
+inline const SolverBackend &native_backend() {
+  static const SolverBackend backend = {
+      "native", "CPU Jacobi engine (jacobi_cpu.hpp)",
+      host_allocate, host_release, host_copy, host_copy,
+      native_solve_eigen, NULL, native_solve_svd, native_solve_qr, host_synchronize};
+  return backend;
+}
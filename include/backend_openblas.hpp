@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdlib.h> // for malloc
+#include <lapacke.h> // for LAPACKE
+
+#include "backend.hpp"
+
+// OpenBLAS LAPACKE as a backend: ssyev, ssyevd, economy-size sgesvd and dgeqrf, one matrix per OpenMP iteration
+// with thread-local workspaces. Compiled with BENCH_HAVE_OPENBLAS.
+
+inline void openblas_solve_eigen(const BatchShape &shape, float *A, float *W, int *info) {
+  int N = shape.N;
+  float work_query;
+  LAPACKE_ssyev_work(LAPACK_COL_MAJOR, 'V', 'U', N, NULL, shape.lda, NULL, &work_query, -1);
+  lapack_int lwork = (lapack_int)work_query;
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      info[b] = LAPACKE_ssyev_work(LAPACK_COL_MAJOR, 'V', 'U', N, A + b * shape.strideA, shape.lda,
+                                   W + (size_t)b * N, thread_work, lwork);
+    }
+
+    free(thread_work);
+  }
+}
+
+inline void openblas_solve_eigen_dc(const BatchShape &shape, float *A, float *W, int *info) {
+  int N = shape.N;
+  float work_query;
+  lapack_int iwork_query;
+  LAPACKE_ssyevd_work(LAPACK_COL_MAJOR, 'V', 'U', N, NULL, shape.lda, NULL, &work_query, -1, &iwork_query, -1);
+  lapack_int lwork = (lapack_int)work_query, liwork = iwork_query;
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+    lapack_int *thread_iwork = (lapack_int*)malloc(sizeof(lapack_int) * liwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      info[b] = LAPACKE_ssyevd_work(LAPACK_COL_MAJOR, 'V', 'U', N, A + b * shape.strideA, shape.lda,
+                                    W + (size_t)b * N, thread_work, lwork, thread_iwork, liwork);
+    }
+
+    free(thread_work);
+    free(thread_iwork);
+  }
+}
+
+inline void openblas_solve_svd(const BatchShape &shape, float *A, float *S, float *U, float *VT, int *info) {
+  int M = shape.M, N = shape.N;
+  int k = (M < N) ? M : N;
+  size_t strideU = (size_t)M * k, strideVT = (size_t)k * N;
+  float work_query;
+  LAPACKE_sgesvd_work(LAPACK_COL_MAJOR, 'S', 'S', M, N, NULL, shape.lda, NULL, NULL, M, NULL, k,
+                      &work_query, -1);
+  lapack_int lwork = (lapack_int)work_query;
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      info[b] = LAPACKE_sgesvd_work(LAPACK_COL_MAJOR, 'S', 'S', M, N, A + b * shape.strideA, shape.lda,
+                                    S + (size_t)b * k, U + b * strideU, M, VT + b * strideVT, k,
+                                    thread_work, lwork);
+    }
+
+    free(thread_work);
+  }
+}
+
+inline void openblas_solve_qr(const BatchShape &shape, double *A, double *tau) {
+  int M = shape.M, N = shape.N;
+  int k = (M < N) ? M : N;
+  double work_query;
+  LAPACKE_dgeqrf_work(LAPACK_COL_MAJOR, M, N, NULL, shape.lda, NULL, &work_query, -1);
+  lapack_int lwork = (lapack_int)work_query;
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    double *thread_work = (double*)malloc(sizeof(double) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < shape.batch_count; ++b) {
+      LAPACKE_dgeqrf_work(LAPACK_COL_MAJOR, M, N, A + b * shape.strideA, shape.lda, tau + (size_t)b * k,
+                          thread_work, lwork);
+    }
+
+    free(thread_work);
+  }
+}
+
+inline const SolverBackend &openblas_backend() {
+  static const SolverBackend backend = {
+      "openblas", "OpenBLAS LAPACKE ssyev / ssyevd / sgesvd / dgeqrf",
+      host_allocate, host_release, host_copy, host_copy,
+      openblas_solve_eigen, openblas_solve_eigen_dc, openblas_solve_svd, openblas_solve_qr, host_synchronize};
+  return backend;
+}
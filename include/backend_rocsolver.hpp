@@ -0,0 +1,96 @@
+#pragma once
+
+#include <hip/hip_runtime_api.h> // for hip functions
+#include <rocsolver/rocsolver.h> // for all the rocsolver C interfaces and type declarations
+
+#include "backend.hpp"
+
+// rocSOLVER as a backend: syevj, gesvdj and geqrf strided batched on the current device, in device
+// memory. The solves are asynchronous on the handle's (default) stream. Compiled with
+// BENCH_HAVE_ROCSOLVER.
+
+inline rocblas_handle rocsolver_backend_handle() {
+  static rocblas_handle handle = []() {
+    rocblas_handle h;
+    rocblas_create_handle(&h);
+    return h;
+  }();
+  return handle;
+}
+
+inline void *rocsolver_allocate(size_t bytes) {
+  void *ptr = NULL;
+  hipMalloc(&ptr, bytes);
+  return ptr;
+}
+
+inline void rocsolver_release(void *ptr) {
+  hipFree(ptr);
+}
+
+inline void rocsolver_copy_to_backend(void *dst, const void *src, size_t bytes) {
+  hipMemcpy(dst, src, bytes, hipMemcpyHostToDevice);
+}
+
+inline void rocsolver_copy_to_host(void *dst, const void *src, size_t bytes) {
+  hipMemcpy(dst, src, bytes, hipMemcpyDeviceToHost);
+}
+
+inline void rocsolver_synchronize() {
+  hipDeviceSynchronize();
+}
+
+// Residuals and sweep counts of the Jacobi solvers, which nobody reads. Kept between calls and
+// grown on demand like the handle, so a solve neither allocates nor frees (hipFree synchronises).
+struct RocsolverJacobiScratch {
+  float *residual;
+  rocblas_int *sweeps;
+  int capacity;
+};
+
+inline RocsolverJacobiScratch &rocsolver_jacobi_scratch(int batch_count) {
+  static RocsolverJacobiScratch scratch = {NULL, NULL, 0};
+  if (batch_count > scratch.capacity) {
+    hipFree(scratch.residual);
+    hipFree(scratch.sweeps);
+    hipMalloc((void**)&scratch.residual, sizeof(float) * batch_count);
+    hipMalloc((void**)&scratch.sweeps, sizeof(rocblas_int) * batch_count);
+    scratch.capacity = batch_count;
+  }
+  return scratch;
+}
+
+inline void rocsolver_solve_eigen(const BatchShape &shape, float *A, float *W, int *info) {
+  RocsolverJacobiScratch &scratch = rocsolver_jacobi_scratch(shape.batch_count);
+
+  rocsolver_ssyevj_strided_batched(rocsolver_backend_handle(), rocblas_esort_ascending, rocblas_evect_original,
+                                   rocblas_fill_upper, shape.N, A, shape.lda, shape.strideA,
+                                   shape.tolerance, scratch.residual, shape.max_sweeps, scratch.sweeps,
+                                   W, shape.N, info, shape.batch_count);
+}
+
+inline void rocsolver_solve_svd(const BatchShape &shape, float *A, float *S, float *U, float *VT, int *info) {
+  int M = shape.M, N = shape.N;
+  int k = (M < N) ? M : N;
+  RocsolverJacobiScratch &scratch = rocsolver_jacobi_scratch(shape.batch_count);
+
+  rocsolver_sgesvdj_strided_batched(rocsolver_backend_handle(), rocblas_svect_singular, rocblas_svect_singular,
+                                    M, N, A, shape.lda, shape.strideA,
+                                    shape.tolerance, scratch.residual, shape.max_sweeps, scratch.sweeps,
+                                    S, k, U, M, (rocblas_stride)M * k, VT, k, (rocblas_stride)k * N,
+                                    info, shape.batch_count);
+}
+
+inline void rocsolver_solve_qr(const BatchShape &shape, double *A, double *tau) {
+  rocblas_stride strideP = (shape.M < shape.N) ? shape.M : shape.N;
+  rocsolver_dgeqrf_strided_batched(rocsolver_backend_handle(), shape.M, shape.N, A, shape.lda, shape.strideA,
+                                   tau, strideP, shape.batch_count);
+}
+
+inline const SolverBackend &rocsolver_backend() {
+  static const SolverBackend backend = {
+      "rocsolver", "rocSOLVER syevj / gesvdj / geqrf strided batched",
+      rocsolver_allocate, rocsolver_release, rocsolver_copy_to_backend, rocsolver_copy_to_host,
+      rocsolver_solve_eigen, NULL, rocsolver_solve_svd, rocsolver_solve_qr, rocsolver_synchronize};
+  return backend;
+}
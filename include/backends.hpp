@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdio.h> // for fprintf
+#include <string> // for backend names
+#include <vector> // for the backend list
+
+#include "backend.hpp"
+#include "backend_native.hpp"
+#include "backend_lapack.hpp"
+#ifdef BENCH_HAVE_OPENBLAS
+#include "backend_openblas.hpp"
+#endif
+#ifdef BENCH_HAVE_ROCSOLVER
+#include "backend_rocsolver.hpp"
+#endif
+
+// The backends compiled into this build. CMake defines BENCH_HAVE_OPENBLAS and
+// BENCH_HAVE_ROCSOLVER for the targets linking the libraries. "lapack:<provider>" backends are
+// loaded at run time (backend_lapack.hpp) and are not in the list.
+
+inline const std::vector<const SolverBackend*> &solver_backends() {
+  static const std::vector<const SolverBackend*> backends = {
+#ifdef BENCH_HAVE_OPENBLAS
+      &openblas_backend(),
+#endif
+      &native_backend(),
+#ifdef BENCH_HAVE_ROCSOLVER
+      &rocsolver_backend(),
+#endif
+  };
+  return backends;
+}
+
+// NULL if there is no backend of that name in this build; a LAPACK provider that cannot be loaded
+// also sets error.
+inline const SolverBackend *find_backend(const std::string &name, std::string *error = NULL) {
+  for (const SolverBackend *backend : solver_backends()) {
+    if (name == backend->name) return backend;
+  }
+  if (name.compare(0, 7, "lapack:") == 0) {
+    std::string lapack_error;
+    const SolverBackend *backend = lapack_backend(name.substr(7), &lapack_error);
+    if (!backend && error) *error = lapack_error;
+    return backend;
+  }
+  return NULL;
+}
+
+// "openblas, native, rocsolver"
+inline std::string backend_names() {
+  std::string names;
+  for (const SolverBackend *backend : solver_backends()) {
+    names += (names.empty() ? "" : ", ") + std::string(backend->name);
+  }
+  return names;
+}
+
+// Print "Unknown backend" or the reason a LAPACK provider did not load.
+inline void print_backend_error(const std::string &name, const std::string &error) {
+  if (!error.empty()) fprintf(stderr, "%s\n", error.c_str());
+  else fprintf(stderr, "Unknown backend: %s (available: %s, lapack:<provider>)\n", name.c_str(), backend_names().c_str());
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdio.h> // for fopen, printf
+#include <stdlib.h> // for strtol
+#include <sched.h> // for sched_getaffinity
+#include <set> // for distinct cache instances
+#include <string> // for sysfs paths
+#include <utility> // for std::swap
+#include <vector> // for the cache levels
+
+// Data cache hierarchy from /sys/devices/system/cpu/cpu*/cache/index*.
+//
+// Every data or unified cache level is read with its size and the CPUs sharing one instance
+// (shared_cpu_list). A batch spread over T threads can keep its working set in the instances
+// those threads use, so the capacity of a level for T threads is its size times the number of
+// instances T threads occupy when packed onto as few instances as the affinity mask allows:
+// T private L2s, but one L3 for all the threads of a socket.
+
+struct CacheLevel {
+  int level;
+  long size_bytes;          // one instance
+  int instances;            // distinct instances among the allowed CPUs
+  int cpus_per_instance;    // allowed CPUs sharing one instance
+};
+
+inline bool cache_read(const std::string &path, std::string *value) {
+  FILE *f = fopen(path.c_str(), "r");
+  if (!f) return false;
+  char buffer[256];
+  bool ok = fgets(buffer, sizeof(buffer), f) != NULL;
+  fclose(f);
+  if (!ok) return false;
+  *value = buffer;
+  while (!value->empty() && value->back() == '\n') value->pop_back();
+  return true;
+}
+
+// "48K", "2048K", "32M" -> bytes
+inline long cache_parse_size(const std::string &text) {
+  char *end;
+  long size = strtol(text.c_str(), &end, 10);
+  if (*end == 'K') size <<= 10;
+  else if (*end == 'M') size <<= 20;
+  else if (*end == 'G') size <<= 30;
+  return size;
+}
+
+// Data and unified cache levels seen by the allowed CPUs, innermost first. Empty if sysfs has
+// no cache information.
+inline std::vector<CacheLevel> read_cache_levels() {
+  cpu_set_t mask;
+  if (sched_getaffinity(0, sizeof(mask), &mask) != 0) {
+    CPU_ZERO(&mask);
+    CPU_SET(0, &mask);
+  }
+  int allowed = CPU_COUNT(&mask);
+
+  std::vector<CacheLevel> levels;
+  std::vector<std::set<std::string>> instances;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &mask)) continue;
+    for (int index = 0; ; ++index) {
+      std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index" + std::to_string(index) + "/";
+      std::string level, type, size, shared;
+      if (!cache_read(base + "level", &level)) break;
+      if (!cache_read(base + "type", &type) || type == "Instruction") continue;
+      if (!cache_read(base + "size", &size) || !cache_read(base + "shared_cpu_list", &shared)) continue;
+
+      int l = atoi(level.c_str());
+      size_t i = 0;
+      while (i < levels.size() && levels[i].level != l) ++i;
+      if (i == levels.size()) {
+        levels.push_back({l, cache_parse_size(size), 0, 1});
+        instances.emplace_back();
+      }
+      instances[i].insert(shared);
+    }
+  }
+
+  for (size_t i = 0; i < levels.size(); ++i) {
+    levels[i].instances = (int)instances[i].size();
+    levels[i].cpus_per_instance = (allowed + levels[i].instances - 1) / levels[i].instances;
+  }
+  for (size_t i = 1; i < levels.size(); ++i) {  // innermost first
+    for (size_t j = i; j > 0 && levels[j].level < levels[j - 1].level; --j) std::swap(levels[j], levels[j - 1]);
+  }
+  return levels;
+}
+
+// Capacity of a level for a batch spread over threads threads.
+inline long cache_capacity(const CacheLevel &level, int threads) {
+  int used = (threads + level.cpus_per_instance - 1) / level.cpus_per_instance;
+  if (used > level.instances) used = level.instances;
+  if (used < 1) used = 1;
+  return level.size_bytes * used;
+}
+
+// Innermost level holding working_set bytes for threads threads: "L1", "L2", ... or "DRAM".
+inline std::string cache_fit(const std::vector<CacheLevel> &levels, double working_set, int threads) {
+  for (const CacheLevel &level : levels) {
+    if (working_set <= cache_capacity(level, threads)) return "L" + std::to_string(level.level);
+  }
+  return "DRAM";
+}
+
+inline void print_cache_levels(const std::vector<CacheLevel> &levels, int threads) {
+  printf("Caches (%d threads):\n", threads);
+  for (const CacheLevel &level : levels) {
+    printf("  L%d: %ld KiB x %d instances (%d CPUs each), %.2f MiB for %d threads\n",
+           level.level, level.size_bytes >> 10, level.instances, level.cpus_per_instance,
+           cache_capacity(level, threads) / 1048576.0, threads);
+  }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdlib.h> // for malloc
+#include <string> // for solver names
+#include <lapacke.h> // for LAPACKE
+
+// The batched OpenBLAS paths of the CPU benches (LAPACKE ssyev, ssyevd and sgesvd with one
+// matrix per OpenMP iteration and thread-local workspaces) for tools that pick the solver at
+// run time.
+
+enum class CpuSolver {
+  ssyev,   // symmetric eigenvalues and eigenvectors, QR iteration
+  ssyevd,  // symmetric eigenvalues and eigenvectors, divide and conquer
+  sgesvd   // singular values and vectors of a general matrix
+};
+
+inline bool parse_cpu_solver(const std::string &name, CpuSolver *solver) {
+  if (name == "ssyev") *solver = CpuSolver::ssyev;
+  else if (name == "ssyevd") *solver = CpuSolver::ssyevd;
+  else if (name == "sgesvd") *solver = CpuSolver::sgesvd;
+  else return false;
+  return true;
+}
+
+inline const char *cpu_solver_name(CpuSolver solver) {
+  switch (solver) {
+    case CpuSolver::ssyev: return "ssyev";
+    case CpuSolver::ssyevd: return "ssyevd";
+    case CpuSolver::sgesvd: return "sgesvd";
+  }
+  return "unknown";
+}
+
+// Shapes, strides and workspace sizes of one problem. Eigen problems are N x N (M == N) with
+// the eigenvectors returned in A; the SVD returns U (M x M) and VT (N x N), as jobu = jobvt = 'A'
+// in bench_openblas_sgesvd.
+struct CpuSolverLayout {
+  CpuSolver solver;
+  lapack_int M, N, lda;
+  size_t strideA;
+  size_t strideW;   // eigenvalues or singular values
+  lapack_int ldu, ldvt;
+  size_t strideU, strideVT;
+  lapack_int lwork, liwork;
+};
+
+inline CpuSolverLayout make_cpu_solver_layout(CpuSolver solver, lapack_int M, lapack_int N, lapack_int lda) {
+  CpuSolverLayout layout = {};
+  layout.solver = solver;
+  if (solver != CpuSolver::sgesvd) M = N;
+  if (lda < M) lda = M;
+  layout.M = M;
+  layout.N = N;
+  layout.lda = lda;
+  layout.strideA = (size_t)lda * N;
+  layout.strideW = (M < N) ? M : N;
+
+  float work_query;
+  lapack_int iwork_query;
+  switch (solver) {
+    case CpuSolver::ssyev:
+      LAPACKE_ssyev_work(LAPACK_COL_MAJOR, 'V', 'U', N, NULL, lda, NULL, &work_query, -1);
+      layout.lwork = (lapack_int)work_query;
+      break;
+    case CpuSolver::ssyevd:
+      LAPACKE_ssyevd_work(LAPACK_COL_MAJOR, 'V', 'U', N, NULL, lda, NULL,
+                          &work_query, -1, &iwork_query, -1);
+      layout.lwork = (lapack_int)work_query;
+      layout.liwork = iwork_query;
+      break;
+    case CpuSolver::sgesvd:
+      layout.ldu = M;
+      layout.ldvt = N;
+      layout.strideU = (size_t)M * M;
+      layout.strideVT = (size_t)N * N;
+      LAPACKE_sgesvd_work(LAPACK_COL_MAJOR, 'A', 'A', M, N, NULL, lda, NULL, NULL, M, NULL, N,
+                          &work_query, -1);
+      layout.lwork = (lapack_int)work_query;
+      break;
+  }
+  return layout;
+}
+
+// Solve matrix b of a batch with the caller's workspaces (layout.lwork floats and
+// layout.liwork integers); returns the LAPACK info.
+inline lapack_int cpu_solver_one(const CpuSolverLayout &layout,
+                                 float *A, float *W, float *U, float *VT, int b,
+                                 float *work, lapack_int *iwork) {
+  float *A_batch = A + b * layout.strideA;
+  float *W_batch = W + b * layout.strideW;
+  switch (layout.solver) {
+    case CpuSolver::ssyev:
+      return LAPACKE_ssyev_work(LAPACK_COL_MAJOR, 'V', 'U', layout.N, A_batch, layout.lda,
+                                W_batch, work, layout.lwork);
+    case CpuSolver::ssyevd:
+      return LAPACKE_ssyevd_work(LAPACK_COL_MAJOR, 'V', 'U', layout.N, A_batch, layout.lda,
+                                 W_batch, work, layout.lwork, iwork, layout.liwork);
+    case CpuSolver::sgesvd:
+      return LAPACKE_sgesvd_work(LAPACK_COL_MAJOR, 'A', 'A', layout.M, layout.N,
+                                 A_batch, layout.lda, W_batch,
+                                 U + b * layout.strideU, layout.ldu,
+                                 VT + b * layout.strideVT, layout.ldvt,
+                                 work, layout.lwork);
+  }
+  return 0;
+}
+
+// Solve batch_count matrices stored layout.strideA apart in A (overwritten). U and VT are only
+// used by sgesvd and may be NULL otherwise. info may be NULL.
+inline void cpu_solver_batched(const CpuSolverLayout &layout,
+                               float *A, float *W, float *U, float *VT,
+                               lapack_int *info, int batch_count) {
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspaces
+    float *thread_work = (float*)malloc(sizeof(float) * layout.lwork);
+    lapack_int *thread_iwork = (lapack_int*)malloc(sizeof(lapack_int) * (layout.liwork > 0 ? layout.liwork : 1));
+
+    #pragma omp for
+    for (int b = 0; b < batch_count; ++b) {
+      lapack_int result = cpu_solver_one(layout, A, W, U, VT, b, thread_work, thread_iwork);
+      if (info) info[b] = result;
+    }
+
+    // Free thread-local workspaces
+    free(thread_work);
+    free(thread_iwork);
+  }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <stdio.h> // for fopen, printf
+#include <stdint.h> // for uint64_t
+#include <dirent.h> // for listing the powercap zones
+#include <string> // for zone paths and names
+#include <vector> // for the zone list
+#include <algorithm> // for std::sort
+
+// CPU package and DRAM energy from the RAPL counters of the Linux powercap interface.
+//
+// Every package is a zone /sys/class/powercap/intel-rapl:P ("package-P"), with its DRAM as the
+// subzone intel-rapl:P:S named "dram"; AMD processors expose their RAPL counters through the
+// same intel-rapl zones. The core and uncore subzones are part of the package energy and are
+// skipped, as is psys, which overlaps everything. energy_uj is a microjoule counter that wraps
+// at max_energy_range_uj, so the benches read it around every timed iteration, keeping every
+// interval far shorter than a wrap period (minutes at full power), and add up the deltas of
+// the iterations they keep (energy_keep), so dropped and re-run iterations are not counted.
+//
+// The counters are readable by root only on most current kernels. If none can be read,
+// energy_open returns false and the benches report nothing.
+
+struct EnergyZone {
+  std::string name;         // "package-0", "package-0/dram"
+  std::string path;         // .../energy_uj
+  uint64_t max_range_uj;
+  uint64_t last_uj;
+  double joules;            // accumulated over the kept intervals
+  double interval_joules;   // of the last interval
+  bool dram;
+};
+
+struct EnergyMeter {
+  std::vector<EnergyZone> zones;
+  int intervals = 0;
+};
+
+inline bool energy_read_u64(const std::string &path, uint64_t *value) {
+  FILE *f = fopen(path.c_str(), "r");
+  if (!f) return false;
+  unsigned long long v;
+  bool ok = fscanf(f, "%llu", &v) == 1;
+  fclose(f);
+  if (ok) *value = v;
+  return ok;
+}
+
+inline bool energy_read_name(const std::string &path, std::string *name) {
+  FILE *f = fopen(path.c_str(), "r");
+  if (!f) return false;
+  char buffer[64];
+  bool ok = fscanf(f, "%63s", buffer) == 1;
+  fclose(f);
+  if (ok) *name = buffer;
+  return ok;
+}
+
+// Find the readable package and DRAM zones. Returns false if there are none.
+inline bool energy_open(EnergyMeter *meter, const char *root = "/sys/class/powercap") {
+  meter->zones.clear();
+  meter->intervals = 0;
+  DIR *dir = opendir(root);
+  if (!dir) return false;
+
+  std::vector<std::string> entries;
+  while (struct dirent *entry = readdir(dir)) {
+    std::string d = entry->d_name;
+    // intel-rapl:P and intel-rapl:P:S; intel-rapl-mmio duplicates the package counter
+    if (d.compare(0, 11, "intel-rapl:") == 0) entries.push_back(d);
+  }
+  closedir(dir);
+  std::sort(entries.begin(), entries.end());
+
+  for (const std::string &d : entries) {
+    std::string base = std::string(root) + "/" + d + "/";
+    std::string name;
+    if (!energy_read_name(base + "name", &name)) continue;
+
+    EnergyZone zone = {};
+    zone.path = base + "energy_uj";
+    bool subzone = d.find(':', 11) != std::string::npos;
+    if (!subzone && name.compare(0, 7, "package") == 0) {
+      zone.name = name;
+    } else if (subzone && name == "dram") {
+      std::string parent;
+      if (!energy_read_name(std::string(root) + "/" + d.substr(0, d.rfind(':')) + "/name", &parent)) continue;
+      zone.name = parent + "/dram";
+      zone.dram = true;
+    } else {
+      continue;
+    }
+    if (!energy_read_u64(base + "max_energy_range_uj", &zone.max_range_uj)) continue;
+    if (!energy_read_u64(zone.path, &zone.last_uj)) continue;
+    meter->zones.push_back(zone);
+  }
+  return !meter->zones.empty();
+}
+
+// Start an interval: remember the current counter values.
+inline void energy_start(EnergyMeter *meter) {
+  for (EnergyZone &zone : meter->zones) energy_read_u64(zone.path, &zone.last_uj);
+}
+
+// End an interval: measure the energy used since energy_start, allowing for one wrap.
+inline void energy_stop(EnergyMeter *meter) {
+  for (EnergyZone &zone : meter->zones) {
+    uint64_t now;
+    zone.interval_joules = 0.0;
+    if (!energy_read_u64(zone.path, &now)) continue;
+    uint64_t delta = (now >= zone.last_uj) ? now - zone.last_uj : zone.max_range_uj - zone.last_uj + now;
+    zone.interval_joules = delta * 1e-6;
+    zone.last_uj = now;
+  }
+}
+
+// Add the last interval to the totals; an interval that is not kept is simply not added.
+inline void energy_keep(EnergyMeter *meter) {
+  for (EnergyZone &zone : meter->zones) zone.joules += zone.interval_joules;
+  meter->intervals++;
+}
+
+// Energy per iteration and per matrix next to the average time; flops is the operation count
+// of one iteration (the whole batch). Prints nothing if no counter was readable.
+inline void print_energy(const EnergyMeter &meter, int batch_count, double flops, float avg_time_ms) {
+  if (meter.zones.empty() || meter.intervals == 0) return;
+
+  double total = 0.0;
+  printf("\n===== Energy (RAPL) =====\n");
+  printf("Sampled iterations: %d\n", meter.intervals);
+  for (const EnergyZone &zone : meter.zones) {
+    double joules = zone.joules / meter.intervals;
+    printf("  %-20s %10.4f J per iteration\n", zone.name.c_str(), joules);
+    total += joules;
+  }
+  printf("Energy per iteration: %.4f J (package + DRAM)\n", total);
+  printf("Energy per matrix: %.3f mJ\n", 1e3 * total / batch_count);
+  if (avg_time_ms > 0.0f) printf("Average power: %.1f W\n", total / (avg_time_ms * 1e-3));
+  if (total > 0.0) printf("Efficiency: %.3f GFLOP/J\n", flops * 1e-9 / total);
+  printf("=========================\n\n");
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <stdio.h> // for fopen, printf
+#include <stdint.h> // for uint64_t
+#include <stdlib.h> // for atol
+#include <string.h> // for strncmp
+#include <unistd.h> // for sysconf, gethostname
+#include <sched.h> // for sched_getaffinity
+#include <sys/utsname.h> // for uname
+#include <set> // for counting physical cores
+#include <string> // for field values
+#include <utility> // for std::pair
+#include <vector> // for the field list
+#include <omp.h> // for omp_get_max_threads
+#ifdef BENCH_HAVE_OPENBLAS
+#include <cblas.h> // for openblas_get_config, openblas_get_num_threads
+#endif
+#ifdef BENCH_HAVE_ROCSOLVER
+#include <hip/hip_runtime_api.h> // for hipRuntimeGetVersion, hipGetDeviceProperties
+#include <rocsolver/rocsolver.h> // for rocsolver_get_version_string
+#endif
+
+extern char **environ;
+
+// Environment fingerprint printed with the results of every bench.
+//
+// Timings from two runs are only comparable if they ran on the same kind of machine under the
+// same conditions, so every bench prints what it ran on: CPU model and topology, the CPUs it may
+// use, SMT, frequency governor and current frequencies, transparent huge pages, the OMP_*,
+// GOMP_* and OPENBLAS_* environment, the OpenBLAS build and thread count, the ROCm and rocSOLVER
+// versions and the device (GPU benches), and the compiler and build flags.
+//
+// The block ends with a fingerprint: a hash of every field that should match between runs that
+// are compared. Current frequencies and the host name are printed but not hashed, so identical
+// machines share a fingerprint. Comparison tooling can refuse to compare results whose
+// fingerprints differ and diff the Environment blocks to show why.
+//
+// BENCH_HAVE_OPENBLAS and BENCH_HAVE_ROCSOLVER are defined by CMake for the targets linking the
+// libraries, and BENCH_BUILD_FLAGS carries the CMake build type and flags.
+
+struct EnvField {
+  std::string key, value;
+  bool hashed;   // part of the fingerprint
+};
+
+struct EnvFingerprint {
+  std::vector<EnvField> fields;
+  uint64_t hash;
+};
+
+inline std::string env_read_line(const std::string &path) {
+  FILE *f = fopen(path.c_str(), "r");
+  if (!f) return "";
+  char buffer[512];
+  std::string line;
+  if (fgets(buffer, sizeof(buffer), f)) line = buffer;
+  fclose(f);
+  while (!line.empty() && (line.back() == '\n' || line.back() == ' ')) line.pop_back();
+  return line;
+}
+
+// "always [madvise] never" -> "madvise"
+inline std::string env_selected(const std::string &choices) {
+  size_t open = choices.find('['), close = choices.find(']');
+  if (open == std::string::npos || close == std::string::npos) return choices;
+  return choices.substr(open + 1, close - open - 1);
+}
+
+inline std::string env_cpu_model() {
+  FILE *f = fopen("/proc/cpuinfo", "r");
+  if (!f) return "unknown";
+  char line[512];
+  std::string model;
+  while (fgets(line, sizeof(line), f)) {
+    // x86: "model name"; AArch64 has no model name, only the implementer and part numbers
+    if (strncmp(line, "model name", 10) == 0 || (model.empty() && strncmp(line, "CPU part", 8) == 0)) {
+      const char *colon = strchr(line, ':');
+      if (!colon) continue;
+      model = colon + 2;
+      while (!model.empty() && model.back() == '\n') model.pop_back();
+      if (strncmp(line, "model name", 10) == 0) break;
+    }
+  }
+  fclose(f);
+  return model.empty() ? "unknown" : model;
+}
+
+inline void env_add(EnvFingerprint *env, const std::string &key, const std::string &value, bool hashed = true) {
+  env->fields.push_back({key, value.empty() ? "unknown" : value, hashed});
+}
+
+inline EnvFingerprint collect_environment() {
+  EnvFingerprint env;
+
+  env_add(&env, "CPU", env_cpu_model());
+  int logical = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  std::set<std::string> cores;
+  for (int cpu = 0; cpu < logical; ++cpu) {
+    std::string siblings = env_read_line("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                                         "/topology/thread_siblings_list");
+    if (!siblings.empty()) cores.insert(siblings);
+  }
+  env_add(&env, "Cores / logical CPUs", (cores.empty() ? "unknown" : std::to_string(cores.size())) +
+                                        " / " + std::to_string(logical));
+
+  cpu_set_t mask;
+  int allowed = logical;
+  std::vector<int> allowed_cpus;
+  if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+    allowed = CPU_COUNT(&mask);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) if (CPU_ISSET(cpu, &mask)) allowed_cpus.push_back(cpu);
+  }
+  env_add(&env, "CPUs allowed", std::to_string(allowed));
+
+  std::string smt = env_read_line("/sys/devices/system/cpu/smt/control");
+  std::string smt_active = env_read_line("/sys/devices/system/cpu/smt/active");
+  if (!smt.empty() && !smt_active.empty()) smt += (smt_active == "1") ? " (active)" : " (inactive)";
+  env_add(&env, "SMT", smt);
+
+  env_add(&env, "Governor", env_read_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor"));
+  std::string boost = env_read_line("/sys/devices/system/cpu/cpufreq/boost");
+  std::string no_turbo = env_read_line("/sys/devices/system/cpu/intel_pstate/no_turbo");
+  if (boost.empty() && !no_turbo.empty()) boost = (no_turbo == "1") ? "0" : "1";
+  env_add(&env, "Boost", boost.empty() ? "" : (boost == "1" ? "on" : "off"));
+  std::string max_freq = env_read_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_max_freq");
+  env_add(&env, "Max frequency", max_freq.empty() ? "" : std::to_string(atol(max_freq.c_str()) / 1000) + " MHz");
+
+  // current frequencies of the allowed CPUs: informative only, they change from run to run
+  long min_khz = 0, max_khz = 0;
+  double sum_khz = 0.0;
+  int sampled = 0;
+  for (int cpu : allowed_cpus) {
+    std::string khz = env_read_line("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_cur_freq");
+    if (khz.empty()) continue;
+    long v = atol(khz.c_str());
+    if (sampled == 0 || v < min_khz) min_khz = v;
+    if (sampled == 0 || v > max_khz) max_khz = v;
+    sum_khz += v;
+    sampled++;
+  }
+  char freq[96] = "";
+  if (sampled > 0) {
+    snprintf(freq, sizeof(freq), "%ld / %.0f / %ld MHz (min / mean / max)",
+             min_khz / 1000, sum_khz / sampled / 1000.0, max_khz / 1000);
+  }
+  env_add(&env, "Current frequency", freq, false);
+
+  std::string thp = env_selected(env_read_line("/sys/kernel/mm/transparent_hugepage/enabled"));
+  std::string defrag = env_selected(env_read_line("/sys/kernel/mm/transparent_hugepage/defrag"));
+  env_add(&env, "Transparent huge pages", thp.empty() ? "" : thp + " (defrag " + defrag + ")");
+
+  struct utsname name;
+  env_add(&env, "Kernel", (uname(&name) == 0) ? std::string(name.release) : "");
+  char host[256] = "";
+  gethostname(host, sizeof(host) - 1);
+  env_add(&env, "Host", host, false);
+
+  env_add(&env, "OpenMP threads", std::to_string(omp_get_max_threads()));
+  std::string vars;
+  for (char **e = environ; *e; ++e) {
+    if (strncmp(*e, "OMP_", 4) == 0 || strncmp(*e, "GOMP_", 5) == 0 || strncmp(*e, "OPENBLAS_", 9) == 0) {
+      vars += (vars.empty() ? "" : " ") + std::string(*e);
+    }
+  }
+  env_add(&env, "Environment", vars.empty() ? "(none set)" : vars);
+
+#ifdef BENCH_HAVE_OPENBLAS
+  std::string config = openblas_get_config();
+  while (!config.empty() && config.back() == ' ') config.pop_back();
+  env_add(&env, "OpenBLAS", config);
+  env_add(&env, "OpenBLAS threads", std::to_string(openblas_get_num_threads()));
+#endif
+
+#ifdef BENCH_HAVE_ROCSOLVER
+  env_add(&env, "ROCm", env_read_line("/opt/rocm/.info/version"));
+  char rocsolver_version[64] = "";
+  rocsolver_get_version_string(rocsolver_version, sizeof(rocsolver_version));
+  env_add(&env, "rocSOLVER", rocsolver_version);
+  int runtime_version = 0;
+  hipRuntimeGetVersion(&runtime_version);
+  env_add(&env, "HIP runtime", std::to_string(runtime_version));
+  int device = 0;
+  hipDeviceProp_t props;
+  if (hipGetDevice(&device) == hipSuccess && hipGetDeviceProperties(&props, device) == hipSuccess) {
+    env_add(&env, "Device", std::string(props.name) + " (" + props.gcnArchName + ", " +
+                            std::to_string(props.multiProcessorCount) + " CUs)");
+  }
+#endif
+
+#ifdef __VERSION__
+  env_add(&env, "Compiler", __VERSION__);
+#endif
+  std::string flags;
+#ifdef BENCH_BUILD_FLAGS
+  flags = BENCH_BUILD_FLAGS;
+#endif
+#ifdef __OPTIMIZE__
+  flags += " (optimized)";
+#endif
+#ifdef __AVX512F__
+  flags += " avx512f";
+#elif defined(__AVX2__)
+  flags += " avx2";
+#endif
+#ifdef __FMA__
+  flags += " fma";
+#endif
+#ifdef __ARM_NEON
+  flags += " neon";
+#endif
+  while (!flags.empty() && flags[0] == ' ') flags.erase(0, 1);
+  env_add(&env, "Build", flags);
+
+  // FNV-1a over the hashed keys and values
+  env.hash = 14695981039346656037ull;
+  for (const EnvField &field : env.fields) {
+    if (!field.hashed) continue;
+    std::string text = field.key + "=" + field.value + "\n";
+    for (unsigned char c : text) {
+      env.hash ^= c;
+      env.hash *= 1099511628211ull;
+    }
+  }
+  return env;
+}
+
+inline void print_environment(const EnvFingerprint &env) {
+  printf("===== Environment =====\n");
+  for (const EnvField &field : env.fields) {
+    printf("%s: %s\n", field.key.c_str(), field.value.c_str());
+  }
+  printf("Fingerprint: %016llx\n", (unsigned long long)env.hash);
+  printf("=======================\n\n");
+}
+
+inline void print_environment() {
+  print_environment(collect_environment());
+}
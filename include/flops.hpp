@@ -0,0 +1,67 @@
+#pragma once
+
+// Leading-order floating-point operation counts of the solvers, for cost estimates and rate
+// reports. Real single precision, vectors computed, one matrix; lower-order terms dropped.
+//
+// The direct solvers follow the Golub & Van Loan estimates. The divide-and-conquer count assumes
+// no deflation, so it is an upper bound on matrices with clustered spectra. The Jacobi counts
+// are per sweep (n(n-1)/2 rotations); multiply by the number of sweeps taken.
+
+// ssyev: tridiagonal reduction, Q formation and implicit QR with vectors.
+inline double ssyev_flops(int n) {
+  return 9.0 * n * n * n;
+}
+
+// ssyevd: tridiagonal reduction (4/3 n^3), divide and conquer (4/3 n^3), back-transformation (2 n^3).
+inline double ssyevd_flops(int n) {
+  return 14.0 / 3.0 * n * n * n;
+}
+
+// sgesvd with full U and V (jobu = jobvt = 'A'), Golub-Reinsch.
+inline double sgesvd_flops(int m, int n) {
+  double l = (m > n) ? m : n;
+  double k = (m < n) ? m : n;
+  return 4.0 * l * l * k + 8.0 * l * k * k + 9.0 * k * k * k;
+}
+
+// sgesvd, economy size (jobu = jobvt = 'S': U is m x k, V' is k x n), Golub-Reinsch.
+inline double sgesvd_economy_flops(int m, int n) {
+  double l = (m > n) ? m : n;
+  double k = (m < n) ? m : n;
+  return 14.0 * l * k * k + 8.0 * k * k * k;
+}
+
+// geqrf: Householder QR of an m x n matrix.
+inline double geqrf_flops(int m, int n) {
+  double k = (m < n) ? m : n;
+  return 2.0 * m * n * k - (2.0 / 3.0) * k * k * k;
+}
+
+// ssyevj, one sweep: every rotation updates two rows and two columns of A and two columns of V.
+inline double ssyevj_flops_per_sweep(int n) {
+  return 9.0 * n * n * n;
+}
+
+// sgesvdj (one-sided), one sweep: every rotation forms three dot products of length l and
+// rotates two columns of A and of V.
+inline double sgesvdj_flops_per_sweep(int m, int n) {
+  double l = (m > n) ? m : n;
+  double k = (m < n) ? m : n;
+  return (6.0 * l + 3.0 * k) * k * k;
+}
+
+// Compulsory memory traffic in bytes of one matrix, for arithmetic intensity: the input is read
+// once and every output written once (eigenvectors overwrite A; the SVD writes U, VT and the
+// singular values). Workspace traffic is not counted, so the intensity is an upper bound.
+inline double ssyev_bytes(int n) {
+  return sizeof(float) * (2.0 * n * n + n);
+}
+
+inline double ssyevd_bytes(int n) {
+  return ssyev_bytes(n);
+}
+
+inline double sgesvd_bytes(int m, int n) {
+  double k = (m < n) ? m : n;
+  return sizeof(float) * (1.0 * m * n + 1.0 * m * m + 1.0 * n * n + k);
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <float.h> // for FLT_EPSILON
+#include <cmath> // for sqrt, fabs
+#include <cstring> // for memcpy
+#include <algorithm> // for std::sort
+#include <vector> // for sort permutations
+
+#include "native_kernels.hpp" // for the ISA-dispatched dot product and rotation
+
+// Native CPU Jacobi engine.
+//
+// jacobi_ssyevj and jacobi_sgesvdj follow the argument order and the convergence semantics of
+// rocsolver_ssyevj / rocsolver_sgesvdj for a single matrix, so the Jacobi benches and tools can
+// run without a GPU. The caller owns the workspace (see the *_workspace_size helpers) and
+// parallelises across the batch, as the OpenBLAS benches do.
+//
+// - ssyevj: cyclic two-sided Jacobi. Converged once off(A) <= abstol (or FLT_EPSILON * ||A||
+//   when abstol <= 0).
+// - sgesvdj: one-sided (Hestenes) Jacobi on the columns of A (of A' when m < n), with the
+//   per-pair test of de Rijk / Demmel-Veselic: a pair is rotated only when |g_p'g_q| >
+//   tol * ||g_p|| ||g_q||, and the sweep that rotates no pair has converged (tol = abstol, or
+//   rows * FLT_EPSILON when abstol <= 0). The residual is the largest relative |g_p'g_q| /
+//   (||g_p|| ||g_q||) of the last sweep, so small columns are orthogonal to their own size.
+
+// Workspace size in floats for jacobi_ssyevj.
+inline size_t jacobi_ssyevj_workspace_size(int n) {
+  return 2 * (size_t)n * n;
+}
+
+// Workspace size in floats for jacobi_sgesvdj.
+inline size_t jacobi_sgesvdj_workspace_size(int m, int n) {
+  size_t k = (m < n) ? m : n;
+  size_t l = (m < n) ? n : m;
+  return l * k + k * k;
+}
+
+inline double jacobi_dot(int n, const float *x, const float *y) {
+  return native_kernels().sdot(n, x, y);
+}
+
+// Apply the plane rotation [x y] <- [c*x - s*y, s*x + c*y] to two columns.
+inline void jacobi_rotate(int n, float *x, float *y, float c, float s) {
+  native_kernels().srot(n, x, y, c, s);
+}
+
+// Replace the columns of Q (m x cols) not flagged in valid with unit vectors orthogonal to all
+// the others. Used for zero singular values and for the 'A' (all vectors) jobs.
+inline void jacobi_complete_orthonormal(int m, int cols, float *Q, int ldq, std::vector<char> &valid) {
+  std::vector<double> v(m);
+  int candidate = 0;
+
+  for (int j = 0; j < cols; ++j) {
+    if (valid[j]) continue;
+
+    while (candidate < m) {
+      for (int i = 0; i < m; ++i) v[i] = (i == candidate) ? 1.0 : 0.0;
+      candidate++;
+
+      // two passes of Gram-Schmidt against the columns accepted so far
+      for (int pass = 0; pass < 2; ++pass) {
+        for (int c = 0; c < cols; ++c) {
+          if (!valid[c]) continue;
+          const float *q = Q + (size_t)c * ldq;
+          double proj = 0.0;
+          for (int i = 0; i < m; ++i) proj += q[i] * v[i];
+          for (int i = 0; i < m; ++i) v[i] -= proj * q[i];
+        }
+      }
+
+      double norm = 0.0;
+      for (int i = 0; i < m; ++i) norm += v[i] * v[i];
+      norm = sqrt(norm);
+      if (norm > 0.5) {
+        float *q = Q + (size_t)j * ldq;
+        for (int i = 0; i < m; ++i) q[i] = (float)(v[i] / norm);
+        valid[j] = 1;
+        break;
+      }
+    }
+  }
+}
+
+// Eigenvalues (and optionally eigenvectors) of one real symmetric n x n matrix.
+// On exit A holds the eigenvectors if they were requested and the algorithm converged;
+// otherwise A is unchanged. work must hold jacobi_ssyevj_workspace_size(n) floats.
+inline void jacobi_ssyevj(bool sort_ascending,
+                          bool vectors,
+                          char uplo,
+                          int n,
+                          float *A,
+                          int lda,
+                          float abstol,
+                          float *residual,
+                          int max_sweeps,
+                          int *n_sweeps,
+                          float *W,
+                          int *info,
+                          float *work) {
+  float *S = work;                 // n x n working copy, kept fully symmetric
+  float *V = work + (size_t)n * n; // n x n accumulated rotations
+
+  // expand the referenced triangle into a full symmetric matrix
+  double norm2 = 0.0, off2 = 0.0;
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n; ++i) {
+      bool upper_entry = (i <= j);
+      int r = (upper_entry == (uplo == 'U' || uplo == 'u')) ? i : j;
+      int c = (r == i) ? j : i;
+      float a = A[r + (size_t)c * lda];
+      S[i + (size_t)j * n] = a;
+      V[i + (size_t)j * n] = (i == j) ? 1.0f : 0.0f;
+      norm2 += (double)a * a;
+      if (i != j) off2 += (double)a * a;
+    }
+  }
+
+  double tol = (abstol > 0.0f) ? abstol : FLT_EPSILON * sqrt(norm2);
+  int sweeps = 0;
+  double off = sqrt(off2);
+
+  while (off > tol && sweeps < max_sweeps) {
+    for (int p = 0; p < n - 1; ++p) {
+      for (int q = p + 1; q < n; ++q) {
+        float *Sp = S + (size_t)p * n;
+        float *Sq = S + (size_t)q * n;
+        float apq = Sq[p];
+        if (apq == 0.0f) continue;
+
+        // rotation angle (Rutishauser's formulation)
+        float theta = (Sq[q] - Sp[p]) / (2.0f * apq);
+        float t = 1.0f / (fabsf(theta) + sqrtf(theta * theta + 1.0f));
+        if (theta < 0.0f) t = -t;
+        float c = 1.0f / sqrtf(t * t + 1.0f);
+        float s = t * c;
+
+        float app = Sp[p], aqq = Sq[q];
+        jacobi_rotate(n, Sp, Sq, c, s);
+        Sp[p] = app - t * apq;
+        Sq[q] = aqq + t * apq;
+        Sp[q] = 0.0f;
+        Sq[p] = 0.0f;
+
+        // mirror the updated columns into rows p and q
+        for (int r = 0; r < n; ++r) {
+          S[p + (size_t)r * n] = Sp[r];
+          S[q + (size_t)r * n] = Sq[r];
+        }
+
+        if (vectors) jacobi_rotate(n, V + (size_t)p * n, V + (size_t)q * n, c, s);
+      }
+    }
+    sweeps++;
+
+    off2 = 0.0;
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < n; ++i) {
+        if (i != j) off2 += (double)S[i + (size_t)j * n] * S[i + (size_t)j * n];
+      }
+    }
+    off = sqrt(off2);
+  }
+
+  *residual = (float)off;
+  *n_sweeps = sweeps;
+  *info = (off > tol) ? 1 : 0;
+
+  std::vector<int> order(n);
+  for (int i = 0; i < n; ++i) order[i] = i;
+  if (sort_ascending) {
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      return S[a + (size_t)a * n] < S[b + (size_t)b * n];
+    });
+  }
+
+  for (int i = 0; i < n; ++i) W[i] = S[order[i] + (size_t)order[i] * n];
+
+  if (vectors && *info == 0) {
+    for (int j = 0; j < n; ++j) {
+      memcpy(A + (size_t)j * lda, V + (size_t)order[j] * n, sizeof(float) * n);
+    }
+  }
+}
+
+// Singular values (and optionally vectors) of one real m x n matrix, A = U S V'.
+// jobu/jobv are 'A', 'S' or 'N' as in LAPACK; VT receives V' (right vectors as rows).
+// A is destroyed. work must hold jacobi_sgesvdj_workspace_size(m, n) floats.
+inline void jacobi_sgesvdj(char jobu,
+                           char jobv,
+                           int m,
+                           int n,
+                           float *A,
+                           int lda,
+                           float abstol,
+                           float *residual,
+                           int max_sweeps,
+                           int *n_sweeps,
+                           float *S,
+                           float *U,
+                           int ldu,
+                           float *VT,
+                           int ldvt,
+                           int *info,
+                           float *work) {
+  // work on the tall orientation: G (rows x k) = A or A'
+  bool transposed = (m < n);
+  int rows = transposed ? n : m;
+  int k = transposed ? m : n;
+  float *G = work;
+  float *V = work + (size_t)rows * k;
+
+  for (int j = 0; j < k; ++j) {
+    for (int i = 0; i < rows; ++i) {
+      G[i + (size_t)j * rows] = transposed ? A[j + (size_t)i * lda] : A[i + (size_t)j * lda];
+    }
+    for (int i = 0; i < k; ++i) V[i + (size_t)j * k] = (i == j) ? 1.0f : 0.0f;
+  }
+
+  // relative orthogonality of every pair
+  double tol = (abstol > 0.0f) ? abstol : rows * FLT_EPSILON;
+
+  int sweeps = 0;
+  double off = 0.0;
+  bool converged = (k < 2);
+
+  while (!converged && sweeps < max_sweeps) {
+    double worst = 0.0;
+    bool rotated = false;
+    for (int p = 0; p < k - 1; ++p) {
+      for (int q = p + 1; q < k; ++q) {
+        float *gp = G + (size_t)p * rows;
+        float *gq = G + (size_t)q * rows;
+        double alpha = jacobi_dot(rows, gp, gp);
+        double beta = jacobi_dot(rows, gq, gq);
+        double gamma = jacobi_dot(rows, gp, gq);
+        if (alpha == 0.0 || beta == 0.0) continue;
+        double relative = fabs(gamma) / sqrt(alpha * beta);
+        worst = std::max(worst, relative);
+        if (relative <= tol) continue;
+        rotated = true;
+
+        double zeta = (beta - alpha) / (2.0 * gamma);
+        double t = 1.0 / (fabs(zeta) + sqrt(1.0 + zeta * zeta));
+        if (zeta < 0.0) t = -t;
+        double c = 1.0 / sqrt(1.0 + t * t);
+        double s = c * t;
+
+        jacobi_rotate(rows, gp, gq, (float)c, (float)s);
+        jacobi_rotate(k, V + (size_t)p * k, V + (size_t)q * k, (float)c, (float)s);
+      }
+    }
+    sweeps++;
+    off = worst;
+    converged = !rotated;
+  }
+
+  *residual = (float)off;
+  *n_sweeps = sweeps;
+  *info = converged ? 0 : 1;
+
+  // singular values are the column norms, returned in decreasing order
+  std::vector<float> sigma(k);
+  std::vector<int> order(k);
+  for (int j = 0; j < k; ++j) {
+    sigma[j] = (float)sqrt(jacobi_dot(rows, G + (size_t)j * rows, G + (size_t)j * rows));
+    order[j] = j;
+  }
+  std::sort(order.begin(), order.end(), [&](int a, int b) { return sigma[a] > sigma[b]; });
+  for (int j = 0; j < k; ++j) S[j] = sigma[order[j]];
+
+  // tall-side vectors: normalised columns of G; short-side vectors: columns of V
+  char job_tall = transposed ? jobv : jobu;
+  char job_short = transposed ? jobu : jobv;
+  std::vector<float> tall;
+  std::vector<char> valid;
+
+  if (job_tall != 'N' && job_tall != 'n') {
+    int cols = (job_tall == 'A' || job_tall == 'a') ? rows : k;
+    tall.assign((size_t)rows * cols, 0.0f);
+    valid.assign(cols, 0);
+    float sigma_min = FLT_EPSILON * ((k > 0) ? S[0] : 0.0f);
+    for (int j = 0; j < k; ++j) {
+      float sj = sigma[order[j]];
+      if (sj <= sigma_min || sj == 0.0f) continue;
+      const float *g = G + (size_t)order[j] * rows;
+      for (int i = 0; i < rows; ++i) tall[i + (size_t)j * rows] = g[i] / sj;
+      valid[j] = 1;
+    }
+    jacobi_complete_orthonormal(rows, cols, tall.data(), rows, valid);
+
+    for (int j = 0; j < cols; ++j) {
+      for (int i = 0; i < rows; ++i) {
+        float x = tall[i + (size_t)j * rows];
+        if (transposed) VT[j + (size_t)i * ldvt] = x;  // rows of V'
+        else U[i + (size_t)j * ldu] = x;
+      }
+    }
+  }
+
+  if (job_short != 'N' && job_short != 'n') {
+    for (int j = 0; j < k; ++j) {
+      const float *v = V + (size_t)order[j] * k;
+      for (int i = 0; i < k; ++i) {
+        if (transposed) U[i + (size_t)j * ldu] = v[i];
+        else VT[j + (size_t)i * ldvt] = v[i];
+      }
+    }
+  }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <dlfcn.h> // for dlopen, dlsym, dladdr
+#include <stddef.h> // for size_t
+#include <string> // for provider names and paths
+#include <vector> // for the candidate libraries
+
+// LAPACK libraries loaded at run time, so one binary can compare every provider installed on a
+// host instead of the OpenBLAS it was linked with.
+//
+// lapack_provider_open dlopens a provider by name (openblas, reference, flame, mkl) or by path and
+// resolves the Fortran symbols ssyev_, ssyevd_, sgesvd_ and dgeqrf_ (with the hidden string
+// lengths gfortran passes). The library is opened with RTLD_DEEPBIND where available: its
+// internal LAPACK/BLAS calls then stay inside it instead of binding to the OpenBLAS already
+// linked into the process. The library's threading API (OpenBLAS, BLIS, MKL) is resolved as well
+// when it exports one.
+
+typedef void (*lapack_ssyev_fn)(const char *jobz, const char *uplo, const int *n, float *a, const int *lda,
+                                float *w, float *work, const int *lwork, int *info, size_t, size_t);
+typedef void (*lapack_ssyevd_fn)(const char *jobz, const char *uplo, const int *n, float *a, const int *lda,
+                                 float *w, float *work, const int *lwork, int *iwork, const int *liwork,
+                                 int *info, size_t, size_t);
+typedef void (*lapack_sgesvd_fn)(const char *jobu, const char *jobvt, const int *m, const int *n, float *a,
+                                 const int *lda, float *s, float *u, const int *ldu, float *vt, const int *ldvt,
+                                 float *work, const int *lwork, int *info, size_t, size_t);
+typedef void (*lapack_dgeqrf_fn)(const int *m, const int *n, double *a, const int *lda, double *tau,
+                                 double *work, const int *lwork, int *info);
+
+struct LapackProvider {
+  std::string name;
+  std::string path;      // the file actually loaded
+  std::string config;    // openblas_get_config, when exported (by the library or its BLAS)
+  void *handle;
+  lapack_ssyev_fn ssyev;
+  lapack_ssyevd_fn ssyevd;
+  lapack_sgesvd_fn sgesvd;
+  lapack_dgeqrf_fn dgeqrf;
+  // threading API, NULL if the library has none
+  void (*openblas_set_num_threads)(int);
+  void (*bli_thread_set_num_threads)(long);
+  void (*mkl_set_num_threads)(int);
+};
+
+// Known provider names and the libraries tried for them, in order. The plain liblapack.so.3 is
+// often an alternatives link to an optimised library; the reference paths come first.
+inline std::vector<std::string> lapack_provider_libraries(const std::string &name) {
+  if (name == "openblas") return {"libopenblas.so.0", "libopenblas.so"};
+  if (name == "reference") {
+    return {"/usr/lib/x86_64-linux-gnu/lapack/liblapack.so.3", "/usr/lib64/lapack/liblapack.so.3",
+            "/usr/lib/lapack/liblapack.so.3", "liblapack.so.3"};
+  }
+  if (name == "flame") return {"libflame.so.1", "libflame.so"};
+  if (name == "mkl") return {"libmkl_rt.so.2", "libmkl_rt.so"};
+  return {name};
+}
+
+inline std::vector<std::string> lapack_provider_names() {
+  return {"openblas", "reference", "flame", "mkl"};
+}
+
+inline void lapack_provider_close(LapackProvider *p) {
+  if (p->handle) dlclose(p->handle);
+  p->handle = NULL;
+}
+
+// Open a provider by name or path. On failure returns false with the reason in error.
+inline bool lapack_provider_open(const std::string &name, LapackProvider *p, std::string *error) {
+  int flags = RTLD_NOW | RTLD_LOCAL;
+#ifdef RTLD_DEEPBIND
+  flags |= RTLD_DEEPBIND;
+#endif
+
+  *p = LapackProvider();
+  p->name = name;
+  std::string dl_error;
+  for (const std::string &library : lapack_provider_libraries(name)) {
+    p->handle = dlopen(library.c_str(), flags);
+    if (p->handle) break;
+    const char *message = dlerror();
+    if (dl_error.empty() && message) dl_error = message;
+  }
+  if (!p->handle) {
+    *error = "cannot load LAPACK provider " + name + ": " + dl_error;
+    return false;
+  }
+
+  p->ssyev = (lapack_ssyev_fn)dlsym(p->handle, "ssyev_");
+  p->ssyevd = (lapack_ssyevd_fn)dlsym(p->handle, "ssyevd_");
+  p->sgesvd = (lapack_sgesvd_fn)dlsym(p->handle, "sgesvd_");
+  p->dgeqrf = (lapack_dgeqrf_fn)dlsym(p->handle, "dgeqrf_");
+  p->openblas_set_num_threads = (void (*)(int))dlsym(p->handle, "openblas_set_num_threads");
+  p->bli_thread_set_num_threads = (void (*)(long))dlsym(p->handle, "bli_thread_set_num_threads");
+  p->mkl_set_num_threads = (void (*)(int))dlsym(p->handle, "MKL_Set_Num_Threads");
+
+  std::string missing;
+  if (!p->ssyev) missing += " ssyev_";
+  if (!p->ssyevd) missing += " ssyevd_";
+  if (!p->sgesvd) missing += " sgesvd_";
+  if (!p->dgeqrf) missing += " dgeqrf_";
+  if (!missing.empty()) {
+    *error = "LAPACK provider " + name + " lacks" + missing;
+    lapack_provider_close(p);
+    return false;
+  }
+
+  Dl_info info;
+  p->path = (dladdr((void*)p->ssyev, &info) && info.dli_fname) ? info.dli_fname : name;
+  // a reference LAPACK over OpenBLAS finds openblas_get_config in its BLAS dependency
+  char *(*get_config)() = (char *(*)())dlsym(p->handle, "openblas_get_config");
+  if (get_config) {
+    bool own = dladdr((void*)get_config, &info) && info.dli_fname && p->path == info.dli_fname;
+    p->config = (own ? "" : "BLAS: ") + std::string(get_config());
+  }
+  return true;
+}
+
+// Set the provider's own thread count; false if it has no threading API.
+inline bool lapack_provider_set_threads(const LapackProvider &p, int threads) {
+  if (p.openblas_set_num_threads) p.openblas_set_num_threads(threads);
+  else if (p.bli_thread_set_num_threads) p.bli_thread_set_num_threads(threads);
+  else if (p.mkl_set_num_threads) p.mkl_set_num_threads(threads);
+  else return false;
+  return true;
+}
+
+inline const char *lapack_provider_threading(const LapackProvider &p) {
+  if (p.openblas_set_num_threads) return "openblas_set_num_threads";
+  if (p.bli_thread_set_num_threads) return "bli_thread_set_num_threads";
+  if (p.mkl_set_num_threads) return "MKL_Set_Num_Threads";
+  return "none";
+}
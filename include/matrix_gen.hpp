@@ -0,0 +1,273 @@
+#pragma once
+
+#include <stdlib.h> // for malloc
+#include <algorithm> // for std::fill, std::min, std::max
+#include <cmath> // for pow
+#include <random> // for random number generation
+#include <string> // for spectrum names
+#include <vector> // for per-thread workspaces
+
+// Test matrices with a prescribed spectrum.
+//
+// Symmetric matrices are built as A = Q diag(d) Q' and general ones as A = U diag(s) V',
+// where the orthogonal factors are products of random Householder reflectors (Stewart's
+// construction). Every matrix has its own generator seeded from (random_seed, batch index),
+// so the batch is generated in parallel and is identical for any number of threads.
+
+enum class SpectrumKind {
+  random,     // legacy generator: uniform random entries, no spectrum control
+  geometric,  // d_i = cond^(-i/(k-1))
+  arithmetic, // d_i = 1 - (i/(k-1)) * (1 - 1/cond)
+  clustered,  // four tight clusters, geometrically spaced between 1 and 1/cond
+  repeated    // d_0 = 1, all others exactly 1/cond (one eigenvalue of multiplicity k-1)
+};
+
+inline bool parse_spectrum_kind(const std::string &name, SpectrumKind *kind) {
+  if (name == "random" || name == "uniform") *kind = SpectrumKind::random;
+  else if (name == "geometric") *kind = SpectrumKind::geometric;
+  else if (name == "arithmetic") *kind = SpectrumKind::arithmetic;
+  else if (name == "clustered") *kind = SpectrumKind::clustered;
+  else if (name == "repeated") *kind = SpectrumKind::repeated;
+  else return false;
+  return true;
+}
+
+inline const char *spectrum_kind_name(SpectrumKind kind) {
+  switch (kind) {
+    case SpectrumKind::random: return "random";
+    case SpectrumKind::geometric: return "geometric";
+    case SpectrumKind::arithmetic: return "arithmetic";
+    case SpectrumKind::clustered: return "clustered";
+    case SpectrumKind::repeated: return "repeated";
+  }
+  return "unknown";
+}
+
+// Fill d[0..k) with magnitudes in [1/cond, 1], largest first. max/min = cond exactly
+// for every kind except random.
+inline void make_spectrum(SpectrumKind kind, int k, double cond, std::mt19937 &gen, double *d) {
+  if (k <= 0) return;
+  if (cond < 1.0) cond = 1.0;
+
+  std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+  const int clusters = 4;
+  const double cluster_width = 1e-3;  // relative spread inside a cluster
+
+  for (int i = 0; i < k; ++i) {
+    double t = (k > 1) ? (double)i / (k - 1) : 0.0;
+    switch (kind) {
+      case SpectrumKind::random:
+      case SpectrumKind::geometric:
+        d[i] = pow(cond, -t);
+        break;
+      case SpectrumKind::arithmetic:
+        d[i] = 1.0 - t * (1.0 - 1.0 / cond);
+        break;
+      case SpectrumKind::clustered: {
+        int c = (int)((long)i * clusters / k);
+        double center = pow(cond, -(double)c / (clusters - 1));
+        d[i] = std::min(1.0, std::max(1.0 / cond, center * (1.0 + cluster_width * jitter(gen))));
+        break;
+      }
+      case SpectrumKind::repeated:
+        d[i] = (i == 0) ? 1.0 : 1.0 / cond;
+        break;
+    }
+  }
+
+  // pin the extremes so that the condition number is exact
+  if (kind == SpectrumKind::clustered && k > 1) {
+    d[0] = 1.0;
+    d[k - 1] = 1.0 / cond;
+  }
+}
+
+// Legacy generators (SpectrumKind::random): uniform entries in [-10, 10) from one sequential
+// generator seeded with random_seed, with a diagonal ten times larger for the symmetric matrices.
+template <typename T = float>
+T *create_symmetric_matrices(int N, int lda, size_t strideA, int batch_count, int random_seed) {
+  // allocate space for input matrix data on CPU
+  T *hA = (T*)malloc(sizeof(T) * strideA * batch_count);
+
+  // generate random symmetric matrices
+  std::mt19937 gen(random_seed);
+  std::uniform_real_distribution<T> dis(-10.0, 10.0);
+
+  for (int b = 0; b < batch_count; ++b) {
+    for (int i = 0; i < N; ++i) {
+      // Diagonal elements
+      hA[i + i * lda + b * strideA] = dis(gen) * 10.0; // Make diagonal dominant
+
+      // Off-diagonal elements (ensure symmetry)
+      for (int j = i + 1; j < N; ++j) {
+        T value = dis(gen);
+        hA[i + j * lda + b * strideA] = value;
+        hA[j + i * lda + b * strideA] = value; // Symmetric counterpart
+      }
+    }
+  }
+
+  return hA;
+}
+
+template <typename T = float>
+T *create_general_matrices(int M, int N, int lda, size_t strideA, int batch_count, int random_seed) {
+  // allocate space for input matrix data on CPU
+  T *hA = (T*)malloc(sizeof(T) * strideA * batch_count);
+
+  // generate random matrices
+  std::mt19937 gen(random_seed);
+  std::uniform_real_distribution<T> dis(-10.0, 10.0);
+
+  for (int b = 0; b < batch_count; ++b) {
+    for (int j = 0; j < N; ++j) {
+      for (int i = 0; i < M; ++i) {
+        hA[i + j * lda + b * strideA] = dis(gen);
+      }
+    }
+  }
+
+  return hA;
+}
+
+// Draw a random reflector H = I - beta v v' acting on rows/columns [offset, n).
+inline double random_householder(int n, int offset, std::mt19937 &gen,
+                                 std::normal_distribution<double> &normal, double *v) {
+  double vtv = 0.0;
+  for (int i = offset; i < n; ++i) {
+    v[i] = normal(gen);
+    vtv += v[i] * v[i];
+  }
+  return (vtv > 0.0) ? 2.0 / vtv : 0.0;
+}
+
+// A <- H A for an m x n column-major matrix, with H acting on rows [offset, m).
+inline void apply_householder_left(int m, int n, int offset, const double *v, double beta, double *A) {
+  for (int j = 0; j < n; ++j) {
+    double *col = A + (size_t)j * m;
+    double s = 0.0;
+    for (int i = offset; i < m; ++i) s += v[i] * col[i];
+    s *= beta;
+    for (int i = offset; i < m; ++i) col[i] -= s * v[i];
+  }
+}
+
+// A <- A H for an m x n column-major matrix, with H acting on columns [offset, n).
+inline void apply_householder_right(int m, int n, int offset, const double *v, double beta, double *A,
+                                    double *row_sums) {
+  for (int i = 0; i < m; ++i) row_sums[i] = 0.0;
+  for (int j = offset; j < n; ++j) {
+    const double *col = A + (size_t)j * m;
+    for (int i = 0; i < m; ++i) row_sums[i] += col[i] * v[j];
+  }
+  for (int j = offset; j < n; ++j) {
+    double *col = A + (size_t)j * m;
+    double w = beta * v[j];
+    for (int i = 0; i < m; ++i) col[i] -= row_sums[i] * w;
+  }
+}
+
+// Allocate a strided batch of symmetric N x N matrices A_b = Q_b diag(+-d) Q_b' with
+// eigenvalue magnitudes from make_spectrum and random signs. The repeated spectrum keeps its
+// signs positive, since random signs would split the repeated eigenvalue into +-1/cond.
+template <typename T>
+T *create_symmetric_matrices_with_spectrum(int N,
+                                           int lda,
+                                           size_t strideA,
+                                           int batch_count,
+                                           int random_seed,
+                                           SpectrumKind kind,
+                                           double cond) {
+  T *hA = (T*)malloc(sizeof(T) * strideA * batch_count);
+
+  #pragma omp parallel
+  {
+    std::vector<double> work((size_t)N * N), v(N), d(N), tmp(N);
+
+    #pragma omp for
+    for (int b = 0; b < batch_count; ++b) {
+      std::seed_seq seq{random_seed, b};
+      std::mt19937 gen(seq);
+      std::normal_distribution<double> normal(0.0, 1.0);
+      std::bernoulli_distribution coin(0.5);
+
+      make_spectrum(kind, N, cond, gen, d.data());
+      std::fill(work.begin(), work.end(), 0.0);
+      for (int i = 0; i < N; ++i) {
+        bool negative = (kind != SpectrumKind::repeated) && coin(gen);
+        work[i + (size_t)i * N] = negative ? -d[i] : d[i];
+      }
+
+      // A <- H A H for each reflector of Q = H_0 H_1 ... H_{N-2}
+      for (int k = 0; k + 1 < N; ++k) {
+        double beta = random_householder(N, k, gen, normal, v.data());
+        apply_householder_left(N, N, k, v.data(), beta, work.data());
+        apply_householder_right(N, N, k, v.data(), beta, work.data(), tmp.data());
+      }
+
+      // symmetrise away the rounding noise and store
+      T *A_b = hA + b * strideA;
+      for (int j = 0; j < N; ++j) {
+        for (int i = 0; i <= j; ++i) {
+          double a = 0.5 * (work[i + (size_t)j * N] + work[j + (size_t)i * N]);
+          A_b[i + (size_t)j * lda] = (T)a;
+          A_b[j + (size_t)i * lda] = (T)a;
+        }
+      }
+    }
+  }
+
+  return hA;
+}
+
+// Allocate a strided batch of general M x N matrices A_b = U_b diag(s) V_b' with
+// singular values from make_spectrum.
+template <typename T>
+T *create_general_matrices_with_spectrum(int M,
+                                         int N,
+                                         int lda,
+                                         size_t strideA,
+                                         int batch_count,
+                                         int random_seed,
+                                         SpectrumKind kind,
+                                         double cond) {
+  T *hA = (T*)malloc(sizeof(T) * strideA * batch_count);
+  int k = (M < N) ? M : N;
+  int max_mn = (M > N) ? M : N;
+
+  #pragma omp parallel
+  {
+    std::vector<double> work((size_t)M * N), v(max_mn), s(k), tmp(M);
+
+    #pragma omp for
+    for (int b = 0; b < batch_count; ++b) {
+      std::seed_seq seq{random_seed, b};
+      std::mt19937 gen(seq);
+      std::normal_distribution<double> normal(0.0, 1.0);
+
+      make_spectrum(kind, k, cond, gen, s.data());
+      std::fill(work.begin(), work.end(), 0.0);
+      for (int i = 0; i < k; ++i) work[i + (size_t)i * M] = s[i];
+
+      // A <- U A with U = H_0 ... H_{M-2}
+      for (int r = 0; r + 1 < M; ++r) {
+        double beta = random_householder(M, r, gen, normal, v.data());
+        apply_householder_left(M, N, r, v.data(), beta, work.data());
+      }
+      // A <- A V' with V = H_0 ... H_{N-2}
+      for (int c = 0; c + 1 < N; ++c) {
+        double beta = random_householder(N, c, gen, normal, v.data());
+        apply_householder_right(M, N, c, v.data(), beta, work.data(), tmp.data());
+      }
+
+      T *A_b = hA + b * strideA;
+      for (int j = 0; j < N; ++j) {
+        for (int i = 0; i < M; ++i) {
+          A_b[i + (size_t)j * lda] = (T)work[i + (size_t)j * M];
+        }
+      }
+    }
+  }
+
+  return hA;
+}
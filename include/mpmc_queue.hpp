@@ -0,0 +1,189 @@
+#pragma once
+
+#include <stddef.h> // for size_t
+#include <stdint.h> // for intptr_t
+#include <atomic> // for the slot sequences and positions
+#include <chrono> // for pop_until deadlines
+#include <condition_variable> // for MutexQueue
+#include <deque> // for MutexQueue
+#include <mutex> // for MutexQueue
+#include <thread> // for std::this_thread::yield
+#include <vector> // for the ring
+
+// Bounded multi-producer multi-consumer queues for the request submission path.
+//
+// MpmcRingQueue is the lock-free ring of D. Vyukov: every slot carries a sequence number that
+// tells producers and consumers whose turn it is, so a push or pop is one CAS on the shared
+// position plus one release store on the slot. MutexQueue is the mutex + condition variable
+// baseline. Both have the same interface:
+//
+//   try_push / try_pop    non-blocking, false when full / empty
+//   push / pop            block until done
+//   pop_until             block until an item arrives or the deadline passes
+//
+// The lock-free queue waits by yielding; the mutex queue sleeps on its condition variables.
+
+template <typename T>
+class MpmcRingQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // capacity is rounded up to a power of two
+  explicit MpmcRingQueue(size_t capacity)
+      : mask_(ring_size(capacity) - 1), slots_(ring_size(capacity)) {
+    for (size_t i = 0; i <= mask_; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  MpmcRingQueue(const MpmcRingQueue &) = delete;
+  MpmcRingQueue &operator=(const MpmcRingQueue &) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  bool try_push(const T &value) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &slot = slots_[pos & mask_];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+      if (diff == 0) {
+        // the slot is free for this position: claim it
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          slot.value = value;
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // the consumer of the previous lap has not freed the slot: full
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool try_pop(T &value) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &slot = slots_[pos & mask_];
+      size_t seq = slot.sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+      if (diff == 0) {
+        // the slot holds the item for this position: take it
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          value = slot.value;
+          slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // not written yet: empty
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void push(const T &value) {
+    while (!try_push(value)) std::this_thread::yield();
+  }
+
+  void pop(T &value) {
+    while (!try_pop(value)) std::this_thread::yield();
+  }
+
+  bool pop_until(T &value, Clock::time_point deadline) {
+    while (!try_pop(value)) {
+      if (Clock::now() >= deadline) return false;
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<size_t> sequence;
+    T value;
+
+    Slot() : sequence(0), value() {}
+  };
+
+  static size_t ring_size(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    return size;
+  }
+
+  // producers and consumers contend on different cache lines
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) size_t mask_;
+  std::vector<Slot> slots_;
+};
+
+template <typename T>
+class MutexQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit MutexQueue(size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+  MutexQueue(const MutexQueue &) = delete;
+  MutexQueue &operator=(const MutexQueue &) = delete;
+
+  size_t capacity() const { return capacity_; }
+
+  bool try_push(const T &value) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (items_.size() >= capacity_) return false;
+      items_.push_back(value);
+    }
+    not_empty_.notify_one();
+    return true;
+  }
+
+  bool try_pop(T &value) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (items_.empty()) return false;
+      value = items_.front();
+      items_.pop_front();
+    }
+    not_full_.notify_one();
+    return true;
+  }
+
+  void push(const T &value) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_full_.wait(lock, [&]() { return items_.size() < capacity_; });
+      items_.push_back(value);
+    }
+    not_empty_.notify_one();
+  }
+
+  void pop(T &value) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [&]() { return !items_.empty(); });
+      value = items_.front();
+      items_.pop_front();
+    }
+    not_full_.notify_one();
+  }
+
+  bool pop_until(T &value, Clock::time_point deadline) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!not_empty_.wait_until(lock, deadline, [&]() { return !items_.empty(); })) return false;
+      value = items_.front();
+      items_.pop_front();
+    }
+    not_full_.notify_one();
+    return true;
+  }
+
+ private:
+  size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_, not_full_;
+  std::deque<T> items_;
+};
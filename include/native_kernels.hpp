@@ -0,0 +1,251 @@
+#pragma once
+
+#include <string> // for ISA names
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // for the AVX2 and AVX-512 kernels
+#endif
+
+// Inner kernels of the native solvers (jacobi_cpu.hpp, the native QR in backend_native.hpp),
+// compiled for several instruction sets and chosen at run time, so one binary runs at full width
+// on AVX2-only and AVX-512 hosts alike.
+//
+// native_kernels() starts on the widest variant the CPU supports (cpuid via
+// __builtin_cpu_supports, as roofline.hpp does); select_native_isa switches it, which the tools
+// expose as --isa. Switch before any parallel region: the table is shared by all threads.
+// Variants accumulate in a different order than the scalar loops, so results may differ in the
+// last bits between ISAs.
+
+enum class Isa {
+  generic,
+  avx2,
+  avx512,
+};
+
+inline const char *isa_name(Isa isa) {
+  switch (isa) {
+    case Isa::generic: return "generic";
+    case Isa::avx2: return "avx2";
+    case Isa::avx512: return "avx512";
+  }
+  return "unknown";
+}
+
+inline bool isa_supported(Isa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+  switch (isa) {
+    case Isa::generic: return true;
+    case Isa::avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case Isa::avx512: return __builtin_cpu_supports("avx512f");
+  }
+  return false;
+#else
+  return isa == Isa::generic;
+#endif
+}
+
+inline Isa isa_best() {
+  if (isa_supported(Isa::avx512)) return Isa::avx512;
+  if (isa_supported(Isa::avx2)) return Isa::avx2;
+  return Isa::generic;
+}
+
+// "auto" is the widest supported ISA.
+inline bool parse_isa(const std::string &name, Isa *isa) {
+  if (name == "auto") *isa = isa_best();
+  else if (name == "generic") *isa = Isa::generic;
+  else if (name == "avx2") *isa = Isa::avx2;
+  else if (name == "avx512") *isa = Isa::avx512;
+  else return false;
+  return true;
+}
+
+// "generic, avx2, avx512"
+inline std::string isa_supported_names() {
+  std::string names;
+  for (Isa isa : {Isa::generic, Isa::avx2, Isa::avx512}) {
+    if (isa_supported(isa)) names += (names.empty() ? "" : ", ") + std::string(isa_name(isa));
+  }
+  return names;
+}
+
+// Generic variants (the compiler's baseline ISA).
+
+// x'y of floats, accumulated in double.
+inline double native_sdot_generic(int n, const float *x, const float *y) {
+  double sum = 0.0;
+  for (int i = 0; i < n; ++i) sum += (double)x[i] * y[i];
+  return sum;
+}
+
+// Plane rotation [x y] <- [c*x - s*y, s*x + c*y].
+inline void native_srot_generic(int n, float *x, float *y, float c, float s) {
+  for (int i = 0; i < n; ++i) {
+    float xi = x[i];
+    float yi = y[i];
+    x[i] = c * xi - s * yi;
+    y[i] = s * xi + c * yi;
+  }
+}
+
+inline double native_ddot_generic(int n, const double *x, const double *y) {
+  double sum = 0.0;
+  for (int i = 0; i < n; ++i) sum += x[i] * y[i];
+  return sum;
+}
+
+// y <- y + a * x
+inline void native_daxpy_generic(int n, double a, const double *x, double *y) {
+  for (int i = 0; i < n; ++i) y[i] += a * x[i];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma"))) inline double native_sdot_avx2(int n, const float *x, const float *y) {
+  __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i);
+    acc0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(vx)),
+                           _mm256_cvtps_pd(_mm256_castps256_ps128(vy)), acc0);
+    acc1 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(vx, 1)),
+                           _mm256_cvtps_pd(_mm256_extractf128_ps(vy, 1)), acc1);
+  }
+  double out[4];
+  _mm256_storeu_pd(out, _mm256_add_pd(acc0, acc1));
+  double sum = out[0] + out[1] + out[2] + out[3];
+  for (; i < n; ++i) sum += (double)x[i] * y[i];
+  return sum;
+}
+
+__attribute__((target("avx2,fma"))) inline void native_srot_avx2(int n, float *x, float *y, float c, float s) {
+  const __m256 vc = _mm256_set1_ps(c), vs = _mm256_set1_ps(s);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i);
+    _mm256_storeu_ps(x + i, _mm256_fmsub_ps(vc, vx, _mm256_mul_ps(vs, vy)));
+    _mm256_storeu_ps(y + i, _mm256_fmadd_ps(vs, vx, _mm256_mul_ps(vc, vy)));
+  }
+  native_srot_generic(n - i, x + i, y + i, c, s);
+}
+
+__attribute__((target("avx2,fma"))) inline double native_ddot_avx2(int n, const double *x, const double *y) {
+  __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), acc0);
+    acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), acc1);
+  }
+  double out[4];
+  _mm256_storeu_pd(out, _mm256_add_pd(acc0, acc1));
+  double sum = out[0] + out[1] + out[2] + out[3];
+  for (; i < n; ++i) sum += x[i] * y[i];
+  return sum;
+}
+
+__attribute__((target("avx2,fma"))) inline void native_daxpy_avx2(int n, double a, const double *x, double *y) {
+  const __m256d va = _mm256_set1_pd(a);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+  }
+  for (; i < n; ++i) y[i] += a * x[i];
+}
+
+// Sum of the lanes; _mm512_reduce_add_pd trips the same GCC 12 warning as the unmasked conversion.
+__attribute__((target("avx512f"))) inline double native_hsum_avx512(__m512d v) {
+  double out[8];
+  _mm512_storeu_pd(out, v);
+  return ((out[0] + out[1]) + (out[2] + out[3])) + ((out[4] + out[5]) + (out[6] + out[7]));
+}
+
+__attribute__((target("avx512f"))) inline double native_sdot_avx512(int n, const float *x, const float *y) {
+  __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+  int i = 0;
+  // maskz_cvtps_pd: GCC 12 -Wall warns about the undefined source of the unmasked conversion
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm512_fmadd_pd(_mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(x + i)),
+                           _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(y + i)), acc0);
+    acc1 = _mm512_fmadd_pd(_mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(x + i + 8)),
+                           _mm512_maskz_cvtps_pd(0xff, _mm256_loadu_ps(y + i + 8)), acc1);
+  }
+  double sum = native_hsum_avx512(_mm512_add_pd(acc0, acc1));
+  for (; i < n; ++i) sum += (double)x[i] * y[i];
+  return sum;
+}
+
+__attribute__((target("avx512f"))) inline void native_srot_avx512(int n, float *x, float *y, float c, float s) {
+  const __m512 vc = _mm512_set1_ps(c), vs = _mm512_set1_ps(s);
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512 vx = _mm512_loadu_ps(x + i), vy = _mm512_loadu_ps(y + i);
+    _mm512_storeu_ps(x + i, _mm512_fmsub_ps(vc, vx, _mm512_mul_ps(vs, vy)));
+    _mm512_storeu_ps(y + i, _mm512_fmadd_ps(vs, vx, _mm512_mul_ps(vc, vy)));
+  }
+  if (i < n) {
+    // masked tail instead of a scalar loop: the Jacobi columns are short
+    __mmask16 mask = (__mmask16)((1u << (n - i)) - 1);
+    __m512 vx = _mm512_maskz_loadu_ps(mask, x + i), vy = _mm512_maskz_loadu_ps(mask, y + i);
+    _mm512_mask_storeu_ps(x + i, mask, _mm512_fmsub_ps(vc, vx, _mm512_mul_ps(vs, vy)));
+    _mm512_mask_storeu_ps(y + i, mask, _mm512_fmadd_ps(vs, vx, _mm512_mul_ps(vc, vy)));
+  }
+}
+
+__attribute__((target("avx512f"))) inline double native_ddot_avx512(int n, const double *x, const double *y) {
+  __m512d acc = _mm512_setzero_pd();
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), acc);
+  }
+  if (i < n) {
+    __mmask8 mask = (__mmask8)((1u << (n - i)) - 1);
+    acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i), acc);
+  }
+  return native_hsum_avx512(acc);
+}
+
+__attribute__((target("avx512f"))) inline void native_daxpy_avx512(int n, double a, const double *x, double *y) {
+  const __m512d va = _mm512_set1_pd(a);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+  }
+  if (i < n) {
+    __mmask8 mask = (__mmask8)((1u << (n - i)) - 1);
+    __m512d vy = _mm512_maskz_loadu_pd(mask, y + i);
+    _mm512_mask_storeu_pd(y + i, mask, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(mask, x + i), vy));
+  }
+}
+#endif
+
+struct NativeKernels {
+  Isa isa;
+  double (*sdot)(int n, const float *x, const float *y);
+  void (*srot)(int n, float *x, float *y, float c, float s);
+  double (*ddot)(int n, const double *x, const double *y);
+  void (*daxpy)(int n, double a, const double *x, double *y);
+};
+
+// The variant table of an ISA (the caller checks isa_supported).
+inline NativeKernels native_kernels_for(Isa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (isa == Isa::avx512) {
+    return {Isa::avx512, native_sdot_avx512, native_srot_avx512, native_ddot_avx512, native_daxpy_avx512};
+  }
+  if (isa == Isa::avx2) {
+    return {Isa::avx2, native_sdot_avx2, native_srot_avx2, native_ddot_avx2, native_daxpy_avx2};
+  }
+#endif
+  return {Isa::generic, native_sdot_generic, native_srot_generic, native_ddot_generic, native_daxpy_generic};
+}
+
+// The kernels in use, the widest supported variant until select_native_isa.
+inline NativeKernels &native_kernels() {
+  static NativeKernels kernels = native_kernels_for(isa_best());
+  return kernels;
+}
+
+// false if the CPU does not support the ISA (the selection is unchanged).
+inline bool select_native_isa(Isa isa) {
+  if (!isa_supported(isa)) return false;
+  native_kernels() = native_kernels_for(isa);
+  return true;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stdio.h> // for printf
+#include <stdlib.h> // for strtol
+#include <string> // for schedule names
+#include <vector> // for per-thread timestamps
+#include <algorithm> // for std::max
+#include <omp.h> // for omp_get_wtime, omp_set_schedule
+
+// Load balance of the OpenMP batch loops.
+//
+// The batch loops run as "#pragma omp for schedule(runtime) nowait" followed by an explicit
+// "#pragma omp barrier", which is what the implicit barrier of a plain omp for does, but lets
+// every thread stamp the time it finished its share (busy) and the time it left the barrier
+// (waiting for the slowest thread):
+//
+//   double loop_start = omp_get_wtime();
+//   #pragma omp for schedule(runtime) nowait
+//   for (...) { ... }
+//   team.loop_done(loop_start);
+//   #pragma omp barrier
+//   team.barrier_done();
+//
+// and record_load_balance turns the stamps of one iteration into per-thread busy and wait
+// times. The schedule itself is chosen at run time with omp_set_schedule (set_omp_schedule).
+
+// Timestamps of every thread of the team for one execution of the loop.
+struct TeamTimes {
+  std::vector<double> start, loop_end, barrier_end;
+  int team = 0;
+
+  explicit TeamTimes(int max_threads)
+      : start(max_threads, 0.0), loop_end(max_threads, 0.0), barrier_end(max_threads, 0.0) {}
+
+  void loop_done(double loop_start) {
+    int t = omp_get_thread_num();
+    start[t] = loop_start;
+    loop_end[t] = omp_get_wtime();
+    if (t == 0) team = omp_get_num_threads();
+  }
+
+  void barrier_done() {
+    barrier_end[omp_get_thread_num()] = omp_get_wtime();
+  }
+};
+
+struct LoadBalance {
+  int threads = 0;
+  std::vector<double> busy_ms;     // per thread, summed over the iterations
+  std::vector<double> wait_ms;
+  std::vector<double> imbalance;   // max busy / mean busy, per iteration
+  std::vector<double> idle;        // barrier wait / (threads x loop time), per iteration
+};
+
+inline void record_load_balance(LoadBalance *balance, const TeamTimes &team) {
+  int n = team.team;
+  if (n <= 0) return;
+  if (balance->threads != n) {
+    balance->threads = n;
+    balance->busy_ms.assign(n, 0.0);
+    balance->wait_ms.assign(n, 0.0);
+  }
+
+  double max_busy = 0.0, sum_busy = 0.0, sum_wait = 0.0, sum_span = 0.0;
+  for (int t = 0; t < n; ++t) {
+    double busy = (team.loop_end[t] - team.start[t]) * 1e3;
+    double wait = (team.barrier_end[t] - team.loop_end[t]) * 1e3;
+    balance->busy_ms[t] += busy;
+    balance->wait_ms[t] += wait;
+    max_busy = std::max(max_busy, busy);
+    sum_busy += busy;
+    sum_wait += wait;
+    sum_span += busy + wait;
+  }
+  balance->imbalance.push_back((sum_busy > 0.0) ? max_busy / (sum_busy / n) : 1.0);
+  balance->idle.push_back((sum_span > 0.0) ? sum_wait / sum_span : 0.0);
+}
+
+// Parse "static", "dynamic", "guided" or "auto", optionally followed by ",chunk".
+inline bool parse_omp_schedule(const std::string &text, omp_sched_t *kind, int *chunk) {
+  std::string name = text;
+  *chunk = 0;
+  size_t comma = text.find(',');
+  if (comma != std::string::npos) {
+    name = text.substr(0, comma);
+    const char *digits = text.c_str() + comma + 1;
+    char *end;
+    long value = strtol(digits, &end, 10);
+    if (end == digits || *end != '\0' || value < 1) return false;
+    *chunk = (int)value;
+  }
+  if (name == "static") *kind = omp_sched_static;
+  else if (name == "dynamic") *kind = omp_sched_dynamic;
+  else if (name == "guided") *kind = omp_sched_guided;
+  else if (name == "auto") *kind = omp_sched_auto;
+  else return false;
+  return true;
+}
+
+// Set the schedule of the schedule(runtime) loops; false if the name is not recognised.
+inline bool set_omp_schedule(const std::string &text) {
+  omp_sched_t kind;
+  int chunk;
+  if (!parse_omp_schedule(text, &kind, &chunk)) return false;
+  omp_set_schedule(kind, chunk);
+  return true;
+}
+
+inline void print_load_balance(const LoadBalance &balance, const std::string &schedule) {
+  int n = balance.threads;
+  int iterations = (int)balance.imbalance.size();
+  printf("\n===== OpenMP Load Balance =====\n");
+  printf("Schedule: %s\n", schedule.c_str());
+  printf("Samples: %d iterations x %d threads\n", iterations, n);
+  if (iterations == 0 || n == 0) {
+    printf("===============================\n\n");
+    return;
+  }
+
+  double imbalance = 0.0, idle = 0.0, worst = 0.0;
+  for (int it = 0; it < iterations; ++it) {
+    imbalance += balance.imbalance[it];
+    idle += balance.idle[it];
+    worst = std::max(worst, balance.imbalance[it]);
+  }
+  printf("Imbalance (max / mean busy time): %.3f (worst iteration %.3f)\n", imbalance / iterations, worst);
+  printf("Idle fraction at the barrier: %.2f%%\n", 100.0 * idle / iterations);
+
+  double peak = 0.0;
+  for (int t = 0; t < n; ++t) peak = std::max(peak, balance.busy_ms[t] + balance.wait_ms[t]);
+  printf("Per thread, average per iteration (# busy, . waiting):\n");
+  for (int t = 0; t < n; ++t) {
+    double busy = balance.busy_ms[t] / iterations, wait = balance.wait_ms[t] / iterations;
+    printf("  %3d  busy %9.3f ms  wait %9.3f ms  ", t, busy, wait);
+    int busy_bar = (peak > 0.0) ? (int)(40.0 * balance.busy_ms[t] / peak + 0.5) : 0;
+    int wait_bar = (peak > 0.0) ? (int)(40.0 * (balance.busy_ms[t] + balance.wait_ms[t]) / peak + 0.5) - busy_bar : 0;
+    for (int i = 0; i < busy_bar; ++i) putchar('#');
+    for (int i = 0; i < wait_bar; ++i) putchar('.');
+    putchar('\n');
+  }
+  printf("===============================\n\n");
+}
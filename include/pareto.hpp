@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stdio.h> // for printf
+#include <stdlib.h> // for malloc
+#include <algorithm> // for std::sort
+#include <cmath> // for pow, log10, fabs
+#include <sstream> // for parsing lists
+#include <string> // for list arguments
+#include <vector> // for trials
+
+// Time-versus-accuracy exploration for the Jacobi benches.
+//
+// Every (tolerance, max_sweeps) pair on the grid is timed and its eigen/singular values are
+// compared against a reference solve at machine precision. A trial is Pareto-optimal when no
+// other trial is both at least as fast and at least as accurate.
+
+struct JacobiTrial {
+  float tolerance;
+  int max_sweeps;
+  double time_ms;        // average over the timing iterations
+  double mean_sweeps;    // mean n_sweeps over the batch
+  int max_sweeps_used;    // largest n_sweeps over the batch
+  double mean_residual;  // mean of the residual reported by the solver
+  int not_converged;     // matrices with info != 0
+  double value_error;    // max |value - reference| / max |reference| over the batch
+  bool pareto;
+};
+
+// steps tolerances from hi down to lo, evenly spaced in log10.
+inline std::vector<float> log_grid(float lo, float hi, int steps) {
+  std::vector<float> grid;
+  if (steps < 2 || lo <= 0.0f || hi <= lo) {
+    grid.push_back(hi);
+    return grid;
+  }
+  double a = log10((double)hi), b = log10((double)lo);
+  for (int i = 0; i < steps; ++i) {
+    grid.push_back((float)pow(10.0, a + (b - a) * i / (steps - 1)));
+  }
+  return grid;
+}
+
+// Parse a comma-separated list of integers, e.g. "5,10,100".
+inline std::vector<int> parse_int_list(const std::string &text) {
+  std::vector<int> values;
+  std::stringstream ss(text);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) values.push_back(std::stoi(item));
+  }
+  return values;
+}
+
+template <typename Int>
+void summarise_jacobi_convergence(const Int *n_sweeps, const float *residual, const Int *info,
+                                  int batch_count, JacobiTrial *trial) {
+  double sum_sweeps = 0.0, sum_residual = 0.0;
+  int max_used = 0, failures = 0;
+  for (int b = 0; b < batch_count; ++b) {
+    sum_sweeps += n_sweeps[b];
+    sum_residual += residual[b];
+    if ((int)n_sweeps[b] > max_used) max_used = (int)n_sweeps[b];
+    if (info[b] != 0) failures++;
+  }
+  trial->mean_sweeps = (batch_count > 0) ? sum_sweeps / batch_count : 0.0;
+  trial->max_sweeps_used = max_used;
+  trial->mean_residual = (batch_count > 0) ? sum_residual / batch_count : 0.0;
+  trial->not_converged = failures;
+}
+
+// max over the batch of max_i |values_i - reference_i| / max_i |reference_i|.
+inline double max_relative_value_error(int k, const float *values, const float *reference,
+                                       size_t stride, int batch_count) {
+  double worst = 0.0;
+  for (int b = 0; b < batch_count; ++b) {
+    const float *v = values + b * stride;
+    const float *r = reference + b * stride;
+    double scale = 0.0, err = 0.0;
+    for (int i = 0; i < k; ++i) {
+      if (fabs(r[i]) > scale) scale = fabs(r[i]);
+      double d = fabs((double)v[i] - r[i]);
+      if (!(d <= err)) err = d;  // keeps NaN
+    }
+    double rel = (scale > 0.0) ? err / scale : err;
+    if (!(rel <= worst)) worst = rel;
+  }
+  return worst;
+}
+
+inline void mark_pareto_front(std::vector<JacobiTrial> &trials) {
+  for (size_t i = 0; i < trials.size(); ++i) {
+    bool dominated = false;
+    for (size_t j = 0; j < trials.size() && !dominated; ++j) {
+      if (i == j) continue;
+      const JacobiTrial &a = trials[j], &b = trials[i];
+      bool no_worse = a.time_ms <= b.time_ms && a.value_error <= b.value_error;
+      bool better = a.time_ms < b.time_ms || a.value_error < b.value_error;
+      dominated = no_worse && better;
+    }
+    trials[i].pareto = !dominated && trials[i].value_error == trials[i].value_error;
+  }
+}
+
+// Run every (tolerance, max_sweeps) pair and mark the Pareto front. run(tolerance, max_sweeps,
+// trial, values) must time the solver, fill the time and convergence fields of trial and copy
+// the batch of computed values (k per matrix, stride apart) into values.
+template <typename Run>
+std::vector<JacobiTrial> explore_jacobi_tradeoff(const std::vector<float> &tolerances,
+                                                 const std::vector<int> &sweep_limits,
+                                                 int k,
+                                                 size_t stride,
+                                                 int batch_count,
+                                                 const float *reference,
+                                                 Run run) {
+  std::vector<JacobiTrial> trials;
+  float *values = (float*)malloc(sizeof(float) * stride * batch_count);
+
+  for (int max_sweeps : sweep_limits) {
+    for (float tolerance : tolerances) {
+      JacobiTrial trial = {};
+      trial.tolerance = tolerance;
+      trial.max_sweeps = max_sweeps;
+      run(tolerance, max_sweeps, &trial, values);
+      trial.value_error = max_relative_value_error(k, values, reference, stride, batch_count);
+      trials.push_back(trial);
+    }
+  }
+
+  free(values);
+  mark_pareto_front(trials);
+  return trials;
+}
+
+inline void print_jacobi_trial(const JacobiTrial &t) {
+  printf("  %10.2e %6d %12.3f %8.2f %6d %12.3e %7d %12.3e %s\n",
+         t.tolerance, t.max_sweeps, t.time_ms, t.mean_sweeps, t.max_sweeps_used,
+         t.mean_residual, t.not_converged, t.value_error, t.pareto ? "*" : "");
+}
+
+inline void print_pareto_report(const char *value_name, const std::vector<JacobiTrial> &trials) {
+  printf("\n===== Tolerance / Max-Sweeps Exploration =====\n");
+  printf("Error: max |%s - reference| / max |reference| (reference: abstol <= 0, machine precision)\n",
+         value_name);
+  printf("  %10s %6s %12s %8s %6s %12s %7s %12s %s\n",
+         "tolerance", "sweeps", "time (ms)", "mean sw", "max sw", "residual", "noconv", "error", "pareto");
+  for (const JacobiTrial &t : trials) print_jacobi_trial(t);
+
+  // the front, fastest first
+  std::vector<const JacobiTrial*> front;
+  for (const JacobiTrial &t : trials) {
+    if (t.pareto) front.push_back(&t);
+  }
+  std::sort(front.begin(), front.end(),
+            [](const JacobiTrial *a, const JacobiTrial *b) { return a->time_ms < b->time_ms; });
+
+  printf("Pareto-optimal set (%zu of %zu):\n", front.size(), trials.size());
+  for (const JacobiTrial *t : front) print_jacobi_trial(*t);
+  printf("==============================================\n\n");
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <float.h> // for FLT_EPSILON
+#include <stdio.h> // for printf
+#include <stdlib.h> // for malloc
+#include <algorithm> // for std::min
+#include <cmath> // for fabs, sqrt
+#include <vector> // for clusters and per-matrix results
+
+#include "jacobi_cpu.hpp" // for the largest singular value of the subspace residual
+
+// Comparison of two eigen/singular decompositions of the same matrix.
+//
+// Values are compared entry by entry after sorting. Vectors are only defined up to sign, and
+// inside a cluster of (nearly) equal values only their span is defined, so vectors are compared
+// per cluster by the largest principal angle between the two spans:
+//
+//   sin(theta_max) = || (I - Qr Qr') Qc ||_2
+//
+// A cluster is a run of consecutive reference values closer than cluster_tol * max |value|.
+// The angle bound of a cluster follows Davis-Kahan: factor * n * eps * ||A|| / gap, where gap
+// is the distance to the nearest value outside the cluster. Sign-canonicalised vectors
+// (largest entry positive) are also compared entry by entry for the singleton clusters.
+
+struct DiffParams {
+  float value_factor;  // value bound in units of n * eps * max |value|
+  float angle_factor;  // angle bound in units of n * eps * max |value| / gap
+  float cluster_tol;   // relative gap below which values form one cluster
+};
+
+struct MatrixDiff {
+  double value_error;   // max |value_r - value_c| / max |value_r|
+  double value_bound;
+  double angle;         // largest sin(theta_max) over the clusters
+  double angle_ratio;   // largest sin(theta_max) / bound over the clusters
+  double vector_error;  // max entry difference of sign-canonicalised singleton vectors
+  int clusters;
+  int degenerate;       // clusters with more than one value
+  bool converged;       // info == 0 on both sides
+  bool pass;
+};
+
+// Flip the columns of Q (rows x cols) so that the entry of largest magnitude is positive.
+// The same flips are applied to the columns of P when given (the V of an SVD follows U).
+inline void canonicalise_vector_signs(int rows, int cols, float *Q, int ldq,
+                                      int p_rows = 0, float *P = NULL, int ldp = 0) {
+  for (int j = 0; j < cols; ++j) {
+    float *q = Q + (size_t)j * ldq;
+    int imax = 0;
+    for (int i = 1; i < rows; ++i) {
+      if (fabsf(q[i]) > fabsf(q[imax])) imax = i;
+    }
+    if (q[imax] >= 0.0f) continue;
+    for (int i = 0; i < rows; ++i) q[i] = -q[i];
+    if (P) {
+      float *p = P + (size_t)j * ldp;
+      for (int i = 0; i < p_rows; ++i) p[i] = -p[i];
+    }
+  }
+}
+
+// Split sorted values into clusters; returns the start of every cluster plus k at the end.
+inline std::vector<int> value_clusters(int k, const float *values, double cluster_tol, double scale) {
+  std::vector<int> starts;
+  for (int i = 0; i < k; ++i) {
+    if (i == 0 || fabs((double)values[i] - values[i - 1]) > cluster_tol * scale) starts.push_back(i);
+  }
+  starts.push_back(k);
+  return starts;
+}
+
+// Workspace size in floats for subspace_angle_sin.
+inline size_t subspace_angle_workspace_size(int rows, int cols) {
+  return (size_t)rows * cols + (size_t)cols + jacobi_sgesvdj_workspace_size(rows, cols);
+}
+
+// sin of the largest principal angle between span(Qr) and span(Qc), both rows x cols with
+// orthonormal columns.
+inline double subspace_angle_sin(int rows, int cols, const float *Qr, int ldr,
+                                 const float *Qc, int ldc, float *work) {
+  float *R = work;
+  float *sigma = R + (size_t)rows * cols;
+  float *svd_work = sigma + cols;
+
+  // R = Qc - Qr (Qr' Qc), accumulated in double
+  std::vector<double> P((size_t)cols * cols);
+  for (int j = 0; j < cols; ++j) {
+    for (int i = 0; i < cols; ++i) {
+      P[i + (size_t)j * cols] = jacobi_dot(rows, Qr + (size_t)i * ldr, Qc + (size_t)j * ldc);
+    }
+  }
+  for (int j = 0; j < cols; ++j) {
+    for (int r = 0; r < rows; ++r) {
+      double x = Qc[r + (size_t)j * ldc];
+      for (int i = 0; i < cols; ++i) x -= Qr[r + (size_t)i * ldr] * P[i + (size_t)j * cols];
+      R[r + (size_t)j * rows] = (float)x;
+    }
+  }
+
+  float residual;
+  int sweeps, info;
+  jacobi_sgesvdj('N', 'N', rows, cols, R, rows, 0.0f, &residual, 100, &sweeps,
+                 sigma, NULL, 1, NULL, 1, &info, svd_work);
+  return (double)sigma[0];
+}
+
+// Angle checks of every cluster, for one set of vectors (eigenvectors, or U or V of an SVD).
+inline void compare_cluster_subspaces(int rows, int k, const float *values,
+                                      const std::vector<int> &starts, double scale, int n,
+                                      const DiffParams &params,
+                                      const float *Qr, int ldr, const float *Qc, int ldc,
+                                      float *work, MatrixDiff *diff) {
+  int clusters = (int)starts.size() - 1;
+  for (int c = 0; c < clusters; ++c) {
+    int s = starts[c], e = starts[c + 1];
+
+    // distance to the nearest value outside the cluster
+    double gap = -1.0;
+    if (s > 0) gap = fabs((double)values[s] - values[s - 1]);
+    if (e < k) {
+      double g = fabs((double)values[e] - values[e - 1]);
+      if (gap < 0.0 || g < gap) gap = g;
+    }
+
+    double bound = 1.0;
+    if (gap > 0.0) bound = std::min(1.0, (double)params.angle_factor * n * FLT_EPSILON * scale / gap);
+
+    double angle = subspace_angle_sin(rows, e - s, Qr + (size_t)s * ldr, ldr,
+                                      Qc + (size_t)s * ldc, ldc, work);
+    if (!(angle <= diff->angle)) diff->angle = angle;
+    double ratio = angle / bound;
+    if (!(ratio <= diff->angle_ratio)) diff->angle_ratio = ratio;
+
+    // singleton clusters: the sign-canonicalised vectors themselves must agree
+    if (e - s == 1) {
+      const float *r = Qr + (size_t)s * ldr;
+      const float *q = Qc + (size_t)s * ldc;
+      for (int i = 0; i < rows; ++i) {
+        double d = fabs((double)r[i] - q[i]);
+        if (!(d <= diff->vector_error)) diff->vector_error = d;
+      }
+    }
+  }
+}
+
+inline void compare_values(int k, const float *ref, const float *cand, int n,
+                           const DiffParams &params, double *scale, MatrixDiff *diff) {
+  double s = 0.0, err = 0.0;
+  for (int i = 0; i < k; ++i) {
+    if (fabs(ref[i]) > s) s = fabs(ref[i]);
+    double d = fabs((double)ref[i] - cand[i]);
+    if (!(d <= err)) err = d;
+  }
+  *scale = s;
+  diff->value_error = (s > 0.0) ? err / s : err;
+  diff->value_bound = (double)params.value_factor * n * FLT_EPSILON;
+}
+
+// Eigen decompositions of one n x n matrix: ascending values W, eigenvectors as columns of V.
+// The vectors are sign-canonicalised in place. work: subspace_angle_workspace_size(n, n).
+inline MatrixDiff diff_eigen(int n,
+                             const float *Wr, float *Vr, int ldvr, int info_r,
+                             const float *Wc, float *Vc, int ldvc, int info_c,
+                             const DiffParams &params, float *work) {
+  MatrixDiff diff = {};
+  double scale;
+  compare_values(n, Wr, Wc, n, params, &scale, &diff);
+
+  canonicalise_vector_signs(n, n, Vr, ldvr);
+  canonicalise_vector_signs(n, n, Vc, ldvc);
+
+  std::vector<int> starts = value_clusters(n, Wr, params.cluster_tol, scale);
+  diff.clusters = (int)starts.size() - 1;
+  for (int c = 0; c < diff.clusters; ++c) diff.degenerate += (starts[c + 1] - starts[c] > 1);
+  compare_cluster_subspaces(n, n, Wr, starts, scale, n, params, Vr, ldvr, Vc, ldvc, work, &diff);
+
+  diff.converged = (info_r == 0 && info_c == 0);
+  diff.pass = diff.converged && diff.value_error <= diff.value_bound && diff.angle_ratio <= 1.0;
+  return diff;
+}
+
+// SVDs of one m x n matrix with k = min(m, n): descending values S, left vectors as the columns
+// of U (m x k) and right vectors as the columns of V (n x k, i.e. V and not V').
+// work: subspace_angle_workspace_size(max(m, n), k).
+inline MatrixDiff diff_svd(int m, int n,
+                           const float *Sr, float *Ur, int ldur, float *Vr, int ldvr, int info_r,
+                           const float *Sc, float *Uc, int lduc, float *Vc, int ldvc, int info_c,
+                           const DiffParams &params, float *work) {
+  int k = (m < n) ? m : n;
+  int max_mn = (m < n) ? n : m;
+  MatrixDiff diff = {};
+  double scale;
+  compare_values(k, Sr, Sc, max_mn, params, &scale, &diff);
+
+  canonicalise_vector_signs(m, k, Ur, ldur, n, Vr, ldvr);
+  canonicalise_vector_signs(m, k, Uc, lduc, n, Vc, ldvc);
+
+  std::vector<int> starts = value_clusters(k, Sr, params.cluster_tol, scale);
+  diff.clusters = (int)starts.size() - 1;
+  for (int c = 0; c < diff.clusters; ++c) diff.degenerate += (starts[c + 1] - starts[c] > 1);
+  compare_cluster_subspaces(m, k, Sr, starts, scale, max_mn, params, Ur, ldur, Uc, lduc, work, &diff);
+  compare_cluster_subspaces(n, k, Sr, starts, scale, max_mn, params, Vr, ldvr, Vc, ldvc, work, &diff);
+
+  diff.converged = (info_r == 0 && info_c == 0);
+  diff.pass = diff.converged && diff.value_error <= diff.value_bound && diff.angle_ratio <= 1.0;
+  return diff;
+}
+
+inline void print_matrix_diff(int b, const MatrixDiff &d) {
+  printf("  %6d %12.3e %12.3e %12.3e %10.3f %12.3e %5d/%-5d %s%s\n",
+         b, d.value_error, d.value_bound, d.angle, d.angle_ratio, d.vector_error,
+         d.degenerate, d.clusters, d.pass ? "PASS" : "FAIL", d.converged ? "" : " (not converged)");
+}
+
+inline void print_diff_header() {
+  printf("  %6s %12s %12s %12s %10s %12s %11s %s\n",
+         "matrix", "value err", "value bound", "sin(angle)", "angle/bnd", "vector err",
+         "degen/clus", "status");
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <stdio.h> // for printf
+#include <stdlib.h> // for malloc
+#include <unistd.h> // for sysconf
+#include <algorithm> // for std::min, std::max
+#include <vector> // for the ceilings per thread count
+#include <omp.h> // for omp_get_wtime
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h> // for the AVX2 and AVX-512 FMA kernels
+#endif
+
+// Roofline ceilings of the machine and the position of a measured run under them.
+//
+// Two microbenchmarks are run for 1, 2, 4, ... threads up to the bench's thread count:
+//   - a STREAM triad, a[i] = b[i] + s * c[i], on malloc'd float arrays first touched by the
+//     threads that use them (as the benches' buffers), sized to 4x the last-level cache
+//     (16 to 256 MiB per array); the bandwidth counts 12 bytes per element, as STREAM does;
+//   - an FMA kernel of 12 independent accumulator chains in the widest vector unit this CPU
+//     supports (AVX-512, AVX2+FMA, otherwise the compiler's 128-bit vectors), chosen at run
+//     time so the ceiling does not depend on the build flags.
+// Every measurement is the best of three. A run with intensity I = flops / bytes (flops.hpp)
+// can reach min(peak, I * bandwidth); the report gives its percentage of that bound.
+
+// The 12 chains are spelled out: an accumulator array is not kept in registers at -O2.
+#define ROOFLINE_CHAINS(X) X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11)
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx512f"))) inline float roofline_fma_avx512(long iterations) {
+#define ROOFLINE_INIT(k) __m512 acc##k = _mm512_set1_ps(1.0f + k * 1e-3f);
+#define ROOFLINE_STEP(k) acc##k = _mm512_fmadd_ps(acc##k, x, y);
+#define ROOFLINE_SUM(k) sum = _mm512_add_ps(sum, acc##k);
+  ROOFLINE_CHAINS(ROOFLINE_INIT)
+  const __m512 x = _mm512_set1_ps(0.999999f), y = _mm512_set1_ps(1e-7f);
+  for (long i = 0; i < iterations; ++i) {
+    ROOFLINE_CHAINS(ROOFLINE_STEP)
+  }
+  __m512 sum = _mm512_setzero_ps();
+  ROOFLINE_CHAINS(ROOFLINE_SUM)
+#undef ROOFLINE_INIT
+#undef ROOFLINE_STEP
+#undef ROOFLINE_SUM
+  float out[16], total = 0.0f;
+  _mm512_storeu_ps(out, sum);
+  for (int j = 0; j < 16; ++j) total += out[j];
+  return total;
+}
+
+__attribute__((target("avx2,fma"))) inline float roofline_fma_avx2(long iterations) {
+#define ROOFLINE_INIT(k) __m256 acc##k = _mm256_set1_ps(1.0f + k * 1e-3f);
+#define ROOFLINE_STEP(k) acc##k = _mm256_fmadd_ps(acc##k, x, y);
+#define ROOFLINE_SUM(k) sum = _mm256_add_ps(sum, acc##k);
+  ROOFLINE_CHAINS(ROOFLINE_INIT)
+  const __m256 x = _mm256_set1_ps(0.999999f), y = _mm256_set1_ps(1e-7f);
+  for (long i = 0; i < iterations; ++i) {
+    ROOFLINE_CHAINS(ROOFLINE_STEP)
+  }
+  __m256 sum = _mm256_setzero_ps();
+  ROOFLINE_CHAINS(ROOFLINE_SUM)
+#undef ROOFLINE_INIT
+#undef ROOFLINE_STEP
+#undef ROOFLINE_SUM
+  float out[8], total = 0.0f;
+  _mm256_storeu_ps(out, sum);
+  for (int j = 0; j < 8; ++j) total += out[j];
+  return total;
+}
+#endif
+
+// 128-bit vectors of the baseline ISA (SSE2 multiply + add, NEON fused multiply-add).
+inline float roofline_fma_generic(long iterations) {
+  typedef float float4 __attribute__((vector_size(16)));
+#define ROOFLINE_INIT(k) float4 acc##k = {1.0f + k * 1e-3f, 1.0f + k * 1e-3f, 1.0f + k * 1e-3f, 1.0f + k * 1e-3f};
+#define ROOFLINE_STEP(k) acc##k = acc##k * x + y;
+#define ROOFLINE_SUM(k) sum += acc##k;
+  ROOFLINE_CHAINS(ROOFLINE_INIT)
+  const float4 x = {0.999999f, 0.999999f, 0.999999f, 0.999999f}, y = {1e-7f, 1e-7f, 1e-7f, 1e-7f};
+  for (long i = 0; i < iterations; ++i) {
+    ROOFLINE_CHAINS(ROOFLINE_STEP)
+  }
+  float4 sum = {0.0f, 0.0f, 0.0f, 0.0f};
+  ROOFLINE_CHAINS(ROOFLINE_SUM)
+#undef ROOFLINE_INIT
+#undef ROOFLINE_STEP
+#undef ROOFLINE_SUM
+  return sum[0] + sum[1] + sum[2] + sum[3];
+}
+
+// Floats per vector of the kernel roofline_fma runs, and its name.
+inline int roofline_fma_width(const char **name = NULL) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("avx512f")) { if (name) *name = "AVX-512 FMA"; return 16; }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) { if (name) *name = "AVX2 FMA"; return 8; }
+  if (name) *name = "SSE2 mul+add";
+#else
+  if (name) *name = "128-bit vector";
+#endif
+  return 4;
+}
+
+inline float roofline_fma(long iterations) {
+#if defined(__x86_64__) || defined(__i386__)
+  int width = roofline_fma_width();
+  if (width == 16) return roofline_fma_avx512(iterations);
+  if (width == 8) return roofline_fma_avx2(iterations);
+#endif
+  return roofline_fma_generic(iterations);
+}
+
+struct RooflineCeilings {
+  std::vector<int> threads;
+  std::vector<double> gflops;   // FMA peak
+  std::vector<double> gbps;     // triad bandwidth
+  const char *kernel;
+  size_t triad_bytes;           // per array
+};
+
+inline double roofline_peak_gflops(int threads) {
+  // size the run to about 20 ms on one thread
+  long iterations = 1 << 16;
+  volatile float sink = 0.0f;
+  for (;;) {
+    double start = omp_get_wtime();
+    sink = sink + roofline_fma(iterations);
+    if (omp_get_wtime() - start > 0.02 || iterations > (1L << 34)) break;
+    iterations *= 2;
+  }
+
+  double flops = 2.0 * 12 * roofline_fma_width() * iterations * threads;
+  double best = 0.0;
+  for (int rep = 0; rep < 3; ++rep) {
+    double seconds = 0.0;
+    #pragma omp parallel num_threads(threads)
+    {
+      #pragma omp barrier
+      double start = omp_get_wtime();
+      float result = roofline_fma(iterations);
+      #pragma omp barrier
+      #pragma omp master
+      seconds = omp_get_wtime() - start;
+      if (result == 0.0f) sink = result;
+    }
+    best = std::max(best, flops / seconds * 1e-9);
+  }
+  return best;
+}
+
+inline double roofline_triad_gbps(int threads, size_t elements) {
+  float *a = (float*)malloc(sizeof(float) * elements);
+  float *b = (float*)malloc(sizeof(float) * elements);
+  float *c = (float*)malloc(sizeof(float) * elements);
+  long n = (long)elements;
+
+  // first touch by the threads that run the triad
+  #pragma omp parallel for schedule(static) num_threads(threads)
+  for (long i = 0; i < n; ++i) {
+    a[i] = 0.0f;
+    b[i] = 1.0f;
+    c[i] = 2.0f;
+  }
+
+  const float s = 3.0f;
+  double best = 0.0;
+  for (int rep = 0; rep < 4; ++rep) {  // the first pass is a warm-up
+    double start = omp_get_wtime();
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (long i = 0; i < n; ++i) a[i] = b[i] + s * c[i];
+    double seconds = omp_get_wtime() - start;
+    if (rep > 0) best = std::max(best, 3.0 * sizeof(float) * n / seconds * 1e-9);
+  }
+  if (a[n / 2] != 7.0f) printf("Triad check failed\n");
+
+  free(a);
+  free(b);
+  free(c);
+  return best;
+}
+
+// Measure the ceilings for 1, 2, 4, ... threads and max_threads.
+inline RooflineCeilings roofline_calibrate(int max_threads) {
+  RooflineCeilings c;
+  roofline_fma_width(&c.kernel);
+  long llc = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+  llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+  if (llc <= 0) llc = 32L << 20;
+  // 4x the last-level cache, at least 16 MiB and at most 256 MiB per array
+  c.triad_bytes = std::min(std::max((size_t)4 * llc, (size_t)16 << 20), (size_t)256 << 20);
+
+  for (int t = 1; ; t = std::min(2 * t, max_threads)) {
+    c.threads.push_back(t);
+    c.gflops.push_back(roofline_peak_gflops(t));
+    c.gbps.push_back(roofline_triad_gbps(t, c.triad_bytes / sizeof(float)));
+    if (t >= max_threads) break;
+  }
+  return c;
+}
+
+// Ceilings of the largest measured thread count not above threads.
+inline void roofline_ceiling(const RooflineCeilings &c, int threads, double *gflops, double *gbps) {
+  size_t i = 0;
+  while (i + 1 < c.threads.size() && c.threads[i + 1] <= threads) ++i;
+  *gflops = c.gflops[i];
+  *gbps = c.gbps[i];
+}
+
+inline void print_roofline_ceilings(const RooflineCeilings &c) {
+  printf("Ceilings (%s peak, triad on 3 x %.0f MiB):\n", c.kernel, c.triad_bytes / 1048576.0);
+  printf("  %8s %14s %14s %14s\n", "threads", "peak GFLOP/s", "triad GB/s", "ridge flop/B");
+  for (size_t i = 0; i < c.threads.size(); ++i) {
+    printf("  %8d %14.1f %14.1f %14.2f\n", c.threads[i], c.gflops[i], c.gbps[i], c.gflops[i] / c.gbps[i]);
+  }
+}
+
+// Percentage of the attainable rate reached by a run of flops and bytes in seconds.
+inline double roofline_percent(double flops, double bytes, double seconds, double peak_gflops,
+                               double gbps, double *intensity, double *attained, double *bound,
+                               bool *memory_bound) {
+  *intensity = flops / bytes;
+  *attained = flops / seconds * 1e-9;
+  *memory_bound = *intensity * gbps < peak_gflops;
+  *bound = *memory_bound ? *intensity * gbps : peak_gflops;
+  return 100.0 * *attained / *bound;
+}
+
+// Roofline block of a bench run: flops and bytes of one timed iteration, its average time.
+inline void print_roofline(const RooflineCeilings &c, int threads, double flops, double bytes, float avg_time_ms) {
+  double peak, gbps, intensity, attained, bound;
+  bool memory_bound;
+  roofline_ceiling(c, threads, &peak, &gbps);
+  double percent = roofline_percent(flops, bytes, avg_time_ms * 1e-3, peak, gbps,
+                                    &intensity, &attained, &bound, &memory_bound);
+
+  printf("\n===== Roofline =====\n");
+  print_roofline_ceilings(c);
+  printf("Arithmetic intensity: %.2f flop/byte (compulsory traffic)\n", intensity);
+  printf("Attained: %.2f GFLOP/s on %d threads\n", attained, threads);
+  printf("Attainable: %.2f GFLOP/s (%s-bound)\n", bound, memory_bound ? "memory" : "compute");
+  printf("Percent of roofline: %.1f%%\n", percent);
+  printf("====================\n\n");
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string> // for routine names
+#include <vector> // for the registry and timings
+
+#include "backend.hpp"
+
+// Benchmark routines of the solverbench driver. A routine registers itself with
+// BENCH_REGISTER_ROUTINE next to its definition, so adding one to the driver needs no change to
+// the dispatch code:
+//
+//   static bool run_syev(const RoutineConfig &config, const SolverBackend &backend, RoutineTimes *times);
+//   static const Routine syev_routine = {"syev", "...", true, syev_flops, run_syev};
+//   BENCH_REGISTER_ROUTINE(syev_routine);
+
+// One configuration of a routine (the options of one command line).
+struct RoutineConfig {
+  int M, N;
+  int batch_count;
+  int random_seed;
+  int iterations;
+  int warmup_time;   // ms
+  float tolerance;   // Jacobi backends
+  int max_sweeps;    // Jacobi backends
+  float validate_threshold;  // > 0: validate one more solve after timing, in units of n * machine epsilon
+};
+
+// first_ms is the first call, including any lazy initialisation of the backend; timings are the
+// timed iterations after the warm-up.
+struct RoutineTimes {
+  float first_ms;
+  int warmup_count;
+  std::vector<float> timings;
+  int failures;      // matrices with info != 0 in the last iteration
+  int validation_failures;  // failed validate.hpp checks of that solve (validate_threshold > 0)
+};
+
+struct Routine {
+  const char *name;
+  const char *description;
+  bool square;       // N x N input, M is ignored
+  double (*flops)(int M, int N);
+  // false if the backend does not implement the routine
+  bool (*run)(const RoutineConfig &config, const SolverBackend &backend, RoutineTimes *times);
+};
+
+inline std::vector<const Routine*> &routine_registry() {
+  static std::vector<const Routine*> routines;
+  return routines;
+}
+
+struct RoutineRegistrar {
+  explicit RoutineRegistrar(const Routine *routine) {
+    routine_registry().push_back(routine);
+  }
+};
+
+#define BENCH_REGISTER_ROUTINE(routine) static RoutineRegistrar routine##_registrar(&routine)
+
+// NULL if no routine of that name is registered.
+inline const Routine *find_routine(const std::string &name) {
+  for (const Routine *routine : routine_registry()) {
+    if (name == routine->name) return routine;
+  }
+  return NULL;
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <stdio.h> // for fopen, printf
+#include <stdint.h> // for uint64_t
+#include <stdlib.h> // for atol
+#include <sched.h> // for sched_getaffinity
+#include <sys/resource.h> // for getrusage
+#include <time.h> // for clock_gettime
+#include <algorithm> // for std::max, std::min
+#include <string> // for sysfs paths
+#include <vector> // for per-iteration records
+
+// Quality of the timed iterations on a shared host.
+//
+// Around every timed iteration the monitor samples, outside the timed region:
+//   - involuntary context switches of the process (getrusage): another task took our CPU,
+//   - the mean current frequency of the CPUs we may run on (cpufreq scaling_cur_freq),
+//   - the thermal throttle event counters of those CPUs (Intel thermal_throttle),
+// and at the start and end of the run the 1-minute load average.
+//
+// An iteration is noisy if it was preempted more than max_preemptions_per_s times per thread
+// and second, if its mean frequency is more than max_freq_drop below the fastest iteration so
+// far, or if a throttle counter moved. The benches can re-run noisy iterations (up to a budget)
+// instead of keeping their times. The run is unreliable if noisy iterations were kept, if the
+// frequency drifted by more than max_freq_drop over the run, or if the load average shows more
+// than max_foreign_load runnable tasks besides the bench's own threads. Counters that cannot be
+// read (no cpufreq in a VM, no thermal_throttle on AMD) are skipped.
+
+struct QualityThresholds {
+  double max_preemptions_per_s = 10.0;  // involuntary context switches per thread and second
+  double max_freq_drop = 0.05;          // relative frequency drop
+  double max_foreign_load = 1.0;        // load average beyond the bench's threads
+};
+
+struct IterationQuality {
+  double seconds;
+  long preemptions;
+  double freq_mhz;      // 0 if unreadable
+  uint64_t throttles;
+  bool noisy;
+};
+
+struct RunQuality {
+  QualityThresholds thresholds;
+  int threads = 1;
+  std::vector<std::string> freq_paths, throttle_paths;
+  double load_start = -1.0, load_end = -1.0;
+  std::vector<IterationQuality> iterations;  // every timed iteration, re-run ones included
+  int reruns = 0;
+  double max_freq_mhz = 0.0;
+
+  // state of the current iteration
+  double start_s;
+  long start_preemptions;
+  uint64_t start_throttles;
+};
+
+inline double quality_load_average() {
+  FILE *f = fopen("/proc/loadavg", "r");
+  if (!f) return -1.0;
+  double load;
+  if (fscanf(f, "%lf", &load) != 1) load = -1.0;
+  fclose(f);
+  return load;
+}
+
+inline bool quality_read_long(const std::string &path, long *value) {
+  FILE *f = fopen(path.c_str(), "r");
+  if (!f) return false;
+  bool ok = fscanf(f, "%ld", value) == 1;
+  fclose(f);
+  return ok;
+}
+
+inline long quality_preemptions() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_nivcsw;
+}
+
+inline uint64_t quality_throttles(const RunQuality &q) {
+  uint64_t total = 0;
+  long v;
+  for (const std::string &path : q.throttle_paths) {
+    if (quality_read_long(path, &v)) total += v;
+  }
+  return total;
+}
+
+inline double quality_freq_mhz(const RunQuality &q) {
+  double sum = 0.0;
+  int n = 0;
+  long khz;
+  for (const std::string &path : q.freq_paths) {
+    if (quality_read_long(path, &khz)) { sum += khz; n++; }
+  }
+  return (n > 0) ? sum / n / 1000.0 : 0.0;
+}
+
+inline double quality_now_s() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Find the counters of the CPUs this process may run on; threads is the bench's thread count.
+inline void quality_open(RunQuality *q, int threads) {
+  q->threads = std::max(1, threads);
+  cpu_set_t mask;
+  if (sched_getaffinity(0, sizeof(mask), &mask) != 0) CPU_ZERO(&mask);
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &mask)) continue;
+    std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/";
+    long v;
+    if (quality_read_long(base + "cpufreq/scaling_cur_freq", &v)) q->freq_paths.push_back(base + "cpufreq/scaling_cur_freq");
+    if (quality_read_long(base + "thermal_throttle/core_throttle_count", &v)) q->throttle_paths.push_back(base + "thermal_throttle/core_throttle_count");
+    if (quality_read_long(base + "thermal_throttle/package_throttle_count", &v)) q->throttle_paths.push_back(base + "thermal_throttle/package_throttle_count");
+  }
+  q->load_start = quality_load_average();
+}
+
+inline void quality_begin(RunQuality *q) {
+  q->start_throttles = quality_throttles(*q);
+  q->start_preemptions = quality_preemptions();
+  q->start_s = quality_now_s();
+}
+
+// Record the iteration since quality_begin; returns true if it was noisy.
+inline bool quality_end(RunQuality *q) {
+  IterationQuality it = {};
+  it.seconds = quality_now_s() - q->start_s;
+  it.preemptions = quality_preemptions() - q->start_preemptions;
+  it.freq_mhz = quality_freq_mhz(*q);
+  it.throttles = quality_throttles(*q) - q->start_throttles;
+
+  const QualityThresholds &t = q->thresholds;
+  double rate = (it.seconds > 0.0) ? it.preemptions / (it.seconds * q->threads) : 0.0;
+  q->max_freq_mhz = std::max(q->max_freq_mhz, it.freq_mhz);
+  it.noisy = rate > t.max_preemptions_per_s ||
+             (it.freq_mhz > 0.0 && it.freq_mhz < (1.0 - t.max_freq_drop) * q->max_freq_mhz) ||
+             it.throttles > 0;
+  q->iterations.push_back(it);
+  return it.noisy;
+}
+
+inline void print_run_quality(RunQuality *q) {
+  q->load_end = quality_load_average();
+  const QualityThresholds &t = q->thresholds;
+
+  int samples = (int)q->iterations.size();
+  int noisy = 0, kept_noisy = 0;
+  long preemptions = 0, max_preemptions = 0;
+  double seconds = 0.0, min_freq = 0.0, max_freq = 0.0;
+  uint64_t throttles = 0;
+  for (int i = 0; i < samples; ++i) {
+    const IterationQuality &it = q->iterations[i];
+    if (it.noisy) noisy++;
+    preemptions += it.preemptions;
+    max_preemptions = std::max(max_preemptions, it.preemptions);
+    seconds += it.seconds;
+    throttles += it.throttles;
+    if (it.freq_mhz > 0.0) {
+      min_freq = (min_freq == 0.0) ? it.freq_mhz : std::min(min_freq, it.freq_mhz);
+      max_freq = std::max(max_freq, it.freq_mhz);
+    }
+  }
+  // re-run iterations were dropped; the rest of the noisy ones were kept
+  kept_noisy = noisy - q->reruns;
+
+  printf("\n===== Run Quality =====\n");
+  printf("Timed iterations sampled: %d (%d re-run)\n", samples, q->reruns);
+  printf("Involuntary context switches: %ld (%.1f per thread-second, max %ld in one iteration)\n",
+         preemptions, (seconds > 0.0) ? preemptions / (seconds * q->threads) : 0.0, max_preemptions);
+  double drift = (max_freq > 0.0) ? (max_freq - min_freq) / max_freq : 0.0;
+  if (max_freq > 0.0) {
+    printf("CPU frequency: %.0f - %.0f MHz over the iterations (drift %.1f%%)\n", min_freq, max_freq, 100.0 * drift);
+  } else {
+    printf("CPU frequency: not available\n");
+  }
+  if (!q->throttle_paths.empty()) printf("Thermal throttle events: %llu\n", (unsigned long long)throttles);
+  else printf("Thermal throttle events: not available\n");
+  double foreign_load = -1.0;
+  if (q->load_start >= 0.0 && q->load_end >= 0.0) {
+    foreign_load = std::max(q->load_start, q->load_end) - q->threads;
+    printf("Load average (1 min): %.2f at start, %.2f at end, %d bench threads\n",
+           q->load_start, q->load_end, q->threads);
+  }
+  printf("Noisy iterations: %d, kept %d\n", noisy, kept_noisy);
+
+  std::string reasons;
+  if (kept_noisy > 0) reasons += ", noisy iterations kept";
+  if (drift > t.max_freq_drop) reasons += ", frequency drift";
+  if (throttles > 0) reasons += ", thermal throttling";
+  if (foreign_load > t.max_foreign_load) reasons += ", other load on the host";
+  if (reasons.empty()) printf("Verdict: reliable\n");
+  else printf("Verdict: UNRELIABLE (%s)\n", reasons.c_str() + 2);
+  printf("=======================\n\n");
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <omp.h> // for omp_get_max_threads, omp_set_num_threads
+#include <string> // for routine names
+
+#include "backends.hpp" // for the solver backends of this build
+#include "tune_table.hpp" // for the autotuned strategies
+
+// Batched solvers dispatched by an autotune table (solverbench tune):
+//
+//   TuneTable table;
+//   std::string error;
+//   if (!tune_table_load("solverbench.table", &table, &error)) ...
+//   BatchShape shape = {N, N, lda, strideA, batch_count, 0.0f, 100};
+//   solve_batched(table, shape, A, W, info);          // syev
+//
+// Every call runs the strategy of the nearest table entry (tune_table_lookup) and falls back to
+// the first backend of the build (openblas, otherwise native) when the table has no entry for
+// the routine or names a backend this build lacks. Arrays are in host memory with the layouts of
+// backend.hpp; device backends stage through their own memory. The strategy's ISA and thread
+// count are applied for the call only. Call from one thread: the native ISA is process-wide.
+
+// The backend of the strategy for a call, with the strategy filled in (fallback, unsupported ISA).
+inline const SolverBackend *solve_batched_backend(const TuneTable &table, const char *routine,
+                                                  const BatchShape &shape, TuneStrategy *strategy) {
+  const TuneEntry *entry = tune_table_lookup(table, routine, shape.M, shape.N, shape.batch_count);
+  const SolverBackend *backend = NULL;
+  if (entry && parse_tune_strategy(entry->strategy, strategy)) backend = find_backend(strategy->backend);
+  if (!backend) {
+    backend = solver_backends().front();
+    strategy->backend = backend->name;
+    strategy->isa = isa_best();
+    strategy->threads = 0;
+  }
+  if (backend == &native_backend() && !isa_supported(strategy->isa)) strategy->isa = isa_best();
+  return backend;
+}
+
+inline bool solve_batched_on_host(const SolverBackend *backend) {
+  return backend->allocate == host_allocate;
+}
+
+// Runs solve with the strategy's native ISA and OpenMP thread count, restoring the previous ones.
+template <typename Solve>
+void solve_batched_with_strategy(const TuneStrategy &strategy, Solve solve) {
+  Isa saved_isa = native_kernels().isa;
+  int saved_threads = omp_get_max_threads();
+  if (strategy.backend == "native") select_native_isa(strategy.isa);
+  if (strategy.threads > 0) omp_set_num_threads(strategy.threads);
+  solve();
+  omp_set_num_threads(saved_threads);
+  select_native_isa(saved_isa);
+}
+
+// syev: A (N x N) is overwritten with the eigenvectors, W gets the eigenvalues (strideW = N).
+inline void solve_batched(const TuneTable &table, const BatchShape &shape, float *A, float *W, int *info,
+                          TuneStrategy *used = NULL) {
+  TuneStrategy strategy;
+  const SolverBackend *backend = solve_batched_backend(table, "syev", shape, &strategy);
+  if (used) *used = strategy;
+
+  if (solve_batched_on_host(backend)) {
+    solve_batched_with_strategy(strategy, [&]() { backend->solve_eigen(shape, A, W, info); });
+    return;
+  }
+
+  size_t size_A = shape.strideA * shape.batch_count, size_W = (size_t)shape.N * shape.batch_count;
+  float *dA = (float*)backend->allocate(sizeof(float) * size_A);
+  float *dW = (float*)backend->allocate(sizeof(float) * size_W);
+  int *dInfo = (int*)backend->allocate(sizeof(int) * shape.batch_count);
+  backend->copy_to_backend(dA, A, sizeof(float) * size_A);
+  backend->solve_eigen(shape, dA, dW, dInfo);
+  backend->copy_to_host(A, dA, sizeof(float) * size_A);
+  backend->copy_to_host(W, dW, sizeof(float) * size_W);
+  backend->copy_to_host(info, dInfo, sizeof(int) * shape.batch_count);
+  backend->release(dA);
+  backend->release(dW);
+  backend->release(dInfo);
+}
+
+// gesvd: economy-size S, U (M x k) and VT (k x N) as in backend.hpp; A is destroyed.
+inline void solve_batched(const TuneTable &table, const BatchShape &shape, float *A, float *S, float *U, float *VT,
+                          int *info, TuneStrategy *used = NULL) {
+  TuneStrategy strategy;
+  const SolverBackend *backend = solve_batched_backend(table, "gesvd", shape, &strategy);
+  if (used) *used = strategy;
+
+  if (solve_batched_on_host(backend)) {
+    solve_batched_with_strategy(strategy, [&]() { backend->solve_svd(shape, A, S, U, VT, info); });
+    return;
+  }
+
+  int k = (shape.M < shape.N) ? shape.M : shape.N;
+  size_t size_A = shape.strideA * shape.batch_count, size_S = (size_t)k * shape.batch_count;
+  size_t size_U = (size_t)shape.M * k * shape.batch_count, size_VT = (size_t)k * shape.N * shape.batch_count;
+  float *dA = (float*)backend->allocate(sizeof(float) * size_A);
+  float *dS = (float*)backend->allocate(sizeof(float) * size_S);
+  float *dU = (float*)backend->allocate(sizeof(float) * size_U);
+  float *dVT = (float*)backend->allocate(sizeof(float) * size_VT);
+  int *dInfo = (int*)backend->allocate(sizeof(int) * shape.batch_count);
+  backend->copy_to_backend(dA, A, sizeof(float) * size_A);
+  backend->solve_svd(shape, dA, dS, dU, dVT, dInfo);
+  backend->copy_to_host(S, dS, sizeof(float) * size_S);
+  backend->copy_to_host(U, dU, sizeof(float) * size_U);
+  backend->copy_to_host(VT, dVT, sizeof(float) * size_VT);
+  backend->copy_to_host(info, dInfo, sizeof(int) * shape.batch_count);
+  backend->release(dA);
+  backend->release(dS);
+  backend->release(dU);
+  backend->release(dVT);
+  backend->release(dInfo);
+}
+
+// geqrf: A (M x N) is overwritten with R and the reflectors, tau gets k = min(M, N) scalars.
+inline void solve_batched(const TuneTable &table, const BatchShape &shape, double *A, double *tau,
+                          TuneStrategy *used = NULL) {
+  TuneStrategy strategy;
+  const SolverBackend *backend = solve_batched_backend(table, "geqrf", shape, &strategy);
+  if (used) *used = strategy;
+
+  if (solve_batched_on_host(backend)) {
+    solve_batched_with_strategy(strategy, [&]() { backend->solve_qr(shape, A, tau); });
+    return;
+  }
+
+  int k = (shape.M < shape.N) ? shape.M : shape.N;
+  size_t size_A = shape.strideA * shape.batch_count, size_tau = (size_t)k * shape.batch_count;
+  double *dA = (double*)backend->allocate(sizeof(double) * size_A);
+  double *dTau = (double*)backend->allocate(sizeof(double) * size_tau);
+  backend->copy_to_backend(dA, A, sizeof(double) * size_A);
+  backend->solve_qr(shape, dA, dTau);
+  backend->copy_to_host(A, dA, sizeof(double) * size_A);
+  backend->copy_to_host(tau, dTau, sizeof(double) * size_tau);
+  backend->release(dA);
+  backend->release(dTau);
+}
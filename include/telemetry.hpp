@@ -0,0 +1,239 @@
+#pragma once
+
+#include <stdio.h> // for printf
+#include <algorithm> // for std::sort, std::min, std::max
+#include <cmath> // for sqrt, ceil
+#include <map> // for the sweep histogram
+#include <vector> // for per-iteration samples
+
+// Per-matrix convergence telemetry for the Jacobi benches.
+//
+// After every timed iteration the bench hands over the n_sweeps, residual and info arrays of
+// the solver together with the elapsed time. The arrays are read through a caller-supplied
+// copy function, copy_to_host(dst, src, bytes): the GPU benches pass a hipMemcpy
+// device-to-host wrapper and the native benches a plain memcpy, so the report is produced by
+// the same code with or without a device. The native benches also time every matrix, for the
+// correlation of sweeps with solve time; rocSOLVER only times the whole batch.
+
+struct JacobiTelemetry {
+  int batch_count = 0;
+  std::vector<float> iteration_ms;  // one entry per timed iteration
+  std::vector<int> n_sweeps;        // batch_count entries per iteration, iteration-major
+  std::vector<float> residual;
+  std::vector<int> info;
+  std::vector<float> matrix_ms;     // solve time of every matrix, as n_sweeps; empty if not timed
+};
+
+template <typename Int, typename CopyToHost>
+void record_jacobi_telemetry(JacobiTelemetry *telemetry,
+                             float elapsed_ms,
+                             const Int *n_sweeps,
+                             const float *residual,
+                             const Int *info,
+                             int batch_count,
+                             CopyToHost copy_to_host) {
+  std::vector<Int> sweeps_b(batch_count), info_b(batch_count);
+  std::vector<float> residual_b(batch_count);
+  copy_to_host(sweeps_b.data(), n_sweeps, sizeof(Int) * batch_count);
+  copy_to_host(residual_b.data(), residual, sizeof(float) * batch_count);
+  copy_to_host(info_b.data(), info, sizeof(Int) * batch_count);
+
+  telemetry->batch_count = batch_count;
+  telemetry->iteration_ms.push_back(elapsed_ms);
+  for (int b = 0; b < batch_count; ++b) {
+    telemetry->n_sweeps.push_back((int)sweeps_b[b]);
+    telemetry->residual.push_back(residual_b[b]);
+    telemetry->info.push_back((int)info_b[b]);
+  }
+}
+
+// Nearest-rank percentile of an ascending vector, p in [0, 100].
+inline float sorted_percentile(const std::vector<float> &sorted, double p) {
+  if (sorted.empty()) return 0.0f;
+  size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+  if (rank < 1) rank = 1;
+  if (rank > sorted.size()) rank = sorted.size();
+  return sorted[rank - 1];
+}
+
+// Pearson correlation of x and y; returns false when either series is constant.
+inline bool pearson_correlation(const std::vector<double> &x, const std::vector<double> &y, double *r) {
+  size_t n = std::min(x.size(), y.size());
+  if (n < 2) return false;
+  double mx = 0.0, my = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    mx += x[i];
+    my += y[i];
+  }
+  mx /= n;
+  my /= n;
+  double sxy = 0.0, sxx = 0.0, syy = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    sxy += (x[i] - mx) * (y[i] - my);
+    sxx += (x[i] - mx) * (x[i] - mx);
+    syy += (y[i] - my) * (y[i] - my);
+  }
+  if (sxx <= 0.0 || syy <= 0.0) return false;
+  *r = sxy / sqrt(sxx * syy);
+  return true;
+}
+
+inline void print_jacobi_telemetry(const JacobiTelemetry &t) {
+  int batch = t.batch_count;
+  int iterations = (int)t.iteration_ms.size();
+  size_t samples = t.n_sweeps.size();
+
+  printf("\n===== Convergence Telemetry =====\n");
+  printf("Samples: %d iterations x %d matrices\n", iterations, batch);
+  if (samples == 0 || batch <= 0) {
+    printf("=================================\n\n");
+    return;
+  }
+
+  // non-convergence, per solve and per matrix
+  size_t failed = 0;
+  std::vector<int> failed_matrix(batch, 0);
+  for (size_t s = 0; s < samples; ++s) {
+    if (t.info[s] != 0) {
+      failed++;
+      failed_matrix[s % batch] = 1;
+    }
+  }
+  int failed_matrices = 0;
+  for (int b = 0; b < batch; ++b) failed_matrices += failed_matrix[b];
+  printf("Not converged: %zu of %zu solves (%.2f%%), %d distinct matrices\n",
+         failed, samples, 100.0 * failed / samples, failed_matrices);
+
+  // sweep histogram, bucketed to at most 16 rows
+  std::map<int, size_t> counts;
+  for (int s : t.n_sweeps) counts[s]++;
+  int lo = counts.begin()->first, hi = counts.rbegin()->first;
+  int width = std::max(1, (int)ceil((hi - lo + 1) / 16.0));
+  std::map<int, size_t> buckets;
+  for (const auto &c : counts) buckets[lo + (c.first - lo) / width * width] += c.second;
+  size_t peak = 0;
+  for (const auto &b : buckets) peak = std::max(peak, b.second);
+
+  printf("Sweep histogram:\n");
+  for (const auto &b : buckets) {
+    int bar = (int)(40.0 * b.second / peak + 0.5);
+    if (width == 1) printf("  %7d     ", b.first);
+    else printf("  %5d-%-5d ", b.first, b.first + width - 1);
+    printf("%8zu %6.2f%% ", b.second, 100.0 * b.second / samples);
+    for (int i = 0; i < bar; ++i) putchar('#');
+    putchar('\n');
+  }
+
+  // residual percentiles
+  std::vector<float> sorted = t.residual;
+  std::sort(sorted.begin(), sorted.end());
+  printf("Residual: p50 %.3e  p90 %.3e  p99 %.3e  max %.3e\n",
+         sorted_percentile(sorted, 50.0), sorted_percentile(sorted, 90.0),
+         sorted_percentile(sorted, 99.0), sorted.back());
+
+  // a batched solve lasts as long as its slowest matrix: compare the worst to the typical one
+  std::vector<double> mean_sweeps(iterations), max_sweeps(iterations), time(iterations);
+  for (int it = 0; it < iterations; ++it) {
+    const int *s = t.n_sweeps.data() + (size_t)it * batch;
+    double sum = 0.0;
+    int worst = 0;
+    for (int b = 0; b < batch; ++b) {
+      sum += s[b];
+      worst = std::max(worst, s[b]);
+    }
+    mean_sweeps[it] = sum / batch;
+    max_sweeps[it] = worst;
+    time[it] = t.iteration_ms[it];
+  }
+  double avg_mean = 0.0, avg_max = 0.0, avg_time = 0.0;
+  for (int it = 0; it < iterations; ++it) {
+    avg_mean += mean_sweeps[it];
+    avg_max += max_sweeps[it];
+    avg_time += time[it];
+  }
+  avg_mean /= iterations;
+  avg_max /= iterations;
+  avg_time /= iterations;
+  printf("Sweeps per iteration: mean %.2f, slowest matrix %.2f (%.2fx)\n",
+         avg_mean, avg_max, (avg_mean > 0.0) ? avg_max / avg_mean : 0.0);
+  if (avg_max > 0.0) printf("Time per sweep of the slowest matrix: %.3f ms\n", avg_time / avg_max);
+
+  // the most stubborn matrices over all iterations
+  std::vector<double> per_matrix(batch, 0.0);
+  for (size_t s = 0; s < samples; ++s) per_matrix[s % batch] += t.n_sweeps[s];
+  std::vector<int> order(batch);
+  for (int b = 0; b < batch; ++b) order[b] = b;
+  std::sort(order.begin(), order.end(), [&](int a, int b) { return per_matrix[a] > per_matrix[b]; });
+  printf("Most sweeps:");
+  for (int i = 0; i < std::min(batch, 5); ++i) {
+    printf(" #%d (%.1f)", order[i], per_matrix[order[i]] / iterations);
+  }
+  printf("\n");
+
+  // every iteration solves the same input, so the sweeps repeat across iterations; they vary
+  // across the matrices of the batch, so sweeps and time are correlated per matrix
+  if (t.matrix_ms.size() == samples) {
+    std::vector<double> sweeps(t.n_sweeps.begin(), t.n_sweeps.end());
+    std::vector<double> ms(t.matrix_ms.begin(), t.matrix_ms.end());
+    double r = 0.0;
+    if (pearson_correlation(sweeps, ms, &r)) {
+      double sweep_sum = 0.0, ms_sum = 0.0;
+      for (size_t s = 0; s < samples; ++s) {
+        sweep_sum += sweeps[s];
+        ms_sum += ms[s];
+      }
+      printf("Correlation of sweeps with matrix solve time: %+.3f (%.4f ms per sweep)\n", r,
+             (sweep_sum > 0.0) ? ms_sum / sweep_sum : 0.0);
+    } else {
+      printf("Correlation of sweeps with matrix solve time: n/a (every matrix took the same sweeps)\n");
+    }
+  } else {
+    printf("Correlation of sweeps with matrix solve time: n/a (per-matrix times not measured)\n");
+  }
+  printf("=================================\n\n");
+}
+
+// Per-matrix solve times of the CPU benches: ms[iteration * batch_count + b] for every timed
+// iteration. A matrix that is slow in every iteration is slow because of its input (e.g. slow
+// QR convergence), so the slowest matrices are ranked by their median over the iterations and
+// listed with the seed that regenerates them.
+inline void print_matrix_latency(const std::vector<float> &ms, int batch_count, int iterations,
+                                 int random_seed) {
+  printf("\n===== Per-Matrix Solve Time =====\n");
+  printf("Samples: %d iterations x %d matrices\n", iterations, batch_count);
+  if (ms.empty() || batch_count <= 0 || iterations <= 0) {
+    printf("=================================\n\n");
+    return;
+  }
+
+  std::vector<float> sorted = ms;
+  std::sort(sorted.begin(), sorted.end());
+  float p50 = sorted_percentile(sorted, 50.0);
+  printf("Time (ms): min %.4f  p50 %.4f  p90 %.4f  p99 %.4f  max %.4f (%.1fx p50)\n",
+         sorted.front(), p50, sorted_percentile(sorted, 90.0), sorted_percentile(sorted, 99.0),
+         sorted.back(), (p50 > 0.0f) ? sorted.back() / p50 : 0.0f);
+
+  // median of every matrix over the iterations
+  std::vector<float> median(batch_count), samples(iterations);
+  for (int b = 0; b < batch_count; ++b) {
+    for (int it = 0; it < iterations; ++it) samples[it] = ms[(size_t)it * batch_count + b];
+    std::sort(samples.begin(), samples.end());
+    median[b] = sorted_percentile(samples, 50.0);
+  }
+  std::vector<float> sorted_median = median;
+  std::sort(sorted_median.begin(), sorted_median.end());
+  float typical = sorted_percentile(sorted_median, 50.0);
+
+  std::vector<int> order(batch_count);
+  for (int b = 0; b < batch_count; ++b) order[b] = b;
+  std::sort(order.begin(), order.end(), [&](int a, int b) { return median[a] > median[b]; });
+  printf("Slowest matrices (median over iterations):\n");
+  for (int i = 0; i < std::min(batch_count, 10); ++i) {
+    int b = order[i];
+    printf("  #%-8d %.4f ms (%.1fx the typical matrix)\n", b, median[b],
+           (typical > 0.0f) ? median[b] / typical : 0.0f);
+  }
+  printf("Reproduce: rerun with the same size and spectrum options, -r %d and any -b above the index\n",
+         random_seed);
+  printf("=================================\n\n");
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <stdio.h> // for fopen, fprintf
+#include <stdint.h> // for int64_t
+#include <chrono> // for the trace clock
+#include <mutex> // for registering thread buffers
+#include <vector> // for the ring buffers
+
+// Timeline trace of a bench run in the Chrome trace event format.
+//
+// Spans are recorded into a ring buffer owned by the calling thread, so recording takes two clock
+// reads and a store with no locking; the buffer is registered once, on the first span of each
+// thread. A full ring overwrites its oldest spans, keeping the end of the run (the timed
+// iterations) when the warm-up produced more spans than fit. trace_write flushes every buffer
+// after the run into a JSON file that loads directly in chrome://tracing or Perfetto.
+//
+// While tracing is disabled trace_begin returns 0 and trace_end returns at once:
+//
+//   int64_t start = trace_begin();
+//   ... work ...
+//   trace_end("restore", "copy", start);        // optional last argument: matrix or iteration
+
+struct TraceEvent {
+  const char *name;      // string literals only: stored by pointer
+  const char *category;
+  int64_t start_ns;      // since trace_enable
+  int64_t duration_ns;
+  long long arg;         // matrix or iteration index, -1 for none
+};
+
+struct TraceRing {
+  std::vector<TraceEvent> events;
+  size_t mask;
+  size_t next;           // spans recorded so far; the ring holds the last events.size()
+  int tid;
+};
+
+struct TraceState {
+  bool enabled = false;
+  size_t capacity = 0;
+  std::chrono::steady_clock::time_point origin;
+  std::mutex mutex;
+  std::vector<TraceRing*> rings;
+};
+
+inline TraceState &trace_state() {
+  static TraceState state;
+  return state;
+}
+
+// Start recording, with room for capacity spans per thread (rounded up to a power of two).
+inline void trace_enable(size_t capacity) {
+  TraceState &state = trace_state();
+  size_t size = 2;
+  while (size < capacity) size <<= 1;
+  state.capacity = size;
+  state.origin = std::chrono::steady_clock::now();
+  state.enabled = true;
+}
+
+inline bool trace_enabled() {
+  return trace_state().enabled;
+}
+
+inline int64_t trace_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - trace_state().origin).count();
+}
+
+// The calling thread's buffer, created and registered on first use.
+inline TraceRing *trace_ring() {
+  thread_local TraceRing *ring = NULL;
+  if (!ring) {
+    TraceState &state = trace_state();
+    ring = new TraceRing();
+    ring->events.resize(state.capacity);
+    ring->mask = state.capacity - 1;
+    ring->next = 0;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    ring->tid = (int)state.rings.size();
+    state.rings.push_back(ring);
+  }
+  return ring;
+}
+
+inline int64_t trace_begin() {
+  return trace_state().enabled ? trace_now_ns() : 0;
+}
+
+inline void trace_end(const char *name, const char *category, int64_t start_ns, long long arg = -1) {
+  if (!trace_state().enabled) return;
+  int64_t end_ns = trace_now_ns();
+  TraceRing *ring = trace_ring();
+  TraceEvent &event = ring->events[ring->next & ring->mask];
+  event.name = name;
+  event.category = category;
+  event.start_ns = start_ns;
+  event.duration_ns = end_ns - start_ns;
+  event.arg = arg;
+  ring->next++;
+}
+
+// Write every recorded span as a complete ("X") event, one track per thread. Call after all
+// traced threads are done. Returns false if the file cannot be written.
+inline bool trace_write(const char *path, size_t *written, size_t *dropped) {
+  TraceState &state = trace_state();
+  *written = 0;
+  *dropped = 0;
+  FILE *out = fopen(path, "w");
+  if (!out) return false;
+
+  std::lock_guard<std::mutex> lock(state.mutex);
+  fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool first = true;
+  for (const TraceRing *ring : state.rings) {
+    fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+            first ? "" : ",\n", ring->tid, ring->tid == 0 ? "main thread" : "thread", ring->tid);
+    first = false;
+
+    size_t held = (ring->next < ring->events.size()) ? ring->next : ring->events.size();
+    *dropped += ring->next - held;
+    for (size_t i = ring->next - held; i < ring->next; ++i) {
+      const TraceEvent &event = ring->events[i & ring->mask];
+      fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                   "\"ts\":%.3f,\"dur\":%.3f",
+              event.name, event.category, ring->tid, event.start_ns / 1e3, event.duration_ns / 1e3);
+      if (event.arg >= 0) fprintf(out, ",\"args\":{\"index\":%lld}", event.arg);
+      fprintf(out, "}");
+      (*written)++;
+    }
+  }
+  fprintf(out, "\n]}\n");
+  return fclose(out) == 0;
+}
+
+// Write the trace if tracing was enabled and report where it went.
+inline void trace_finish(const char *path) {
+  if (!trace_enabled()) return;
+  size_t written, dropped;
+  if (!trace_write(path, &written, &dropped)) {
+    printf("Failed to write trace to %s\n", path);
+    return;
+  }
+  printf("Trace written to %s (%zu spans", path, written);
+  if (dropped > 0) printf(", %zu oldest spans overwritten; raise --trace-capacity to keep them", dropped);
+  printf(")\n");
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stdint.h> // for uint64_t
+#include <time.h> // for clock_gettime(CLOCK_MONOTONIC)
+#include <algorithm> // for std::min
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // for __rdtsc, __rdtscp, _mm_lfence
+#include <cpuid.h> // for the invariant TSC flag
+#endif
+
+// Cycle-counter timer for timing single matrices inside the OpenMP loops and for solves too
+// short for the system clocks.
+//
+// tsc_now reads the time-stamp counter (x86), the virtual counter (AArch64) or, elsewhere,
+// CLOCK_MONOTONIC in nanoseconds. A read costs a few tens of cycles and no system call, so every
+// matrix of a batch can be timed without disturbing the batch time. The counter is assumed to
+// be invariant (constant rate, synchronised across cores), as on every current x86 and AArch64
+// server (tsc_invariant reports the CPUID flag on x86); the rate is calibrated once against
+// CLOCK_MONOTONIC.
+//
+// For work of a few hundred cycles, tsc_begin and tsc_end fence the reads so the measured work
+// cannot move across them, and tsc_elapsed subtracts the cost of the timer itself (the minimum of
+// many back-to-back tsc_begin / tsc_end pairs). Work shorter than the counter resolution is
+// timed in samples of many repetitions: tsc_repetitions finds a repetition count whose sample
+// lasts at least a given time and tsc_sample_ns returns the net time of one repetition.
+//
+//   tsc_calibrate();                          // at start-up, before timing
+//   uint64_t start = tsc_begin();
+//   ... work ...
+//   uint64_t ticks = tsc_elapsed(start, tsc_end());
+
+inline uint64_t tsc_monotonic_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+inline uint64_t tsc_now() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return tsc_monotonic_ns();
+#endif
+}
+
+// Read the counter after all earlier instructions have completed.
+inline uint64_t tsc_begin() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_lfence();
+  uint64_t ticks = __rdtsc();
+  _mm_lfence();
+  return ticks;
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(ticks) :: "memory");
+  return ticks;
+#else
+  return tsc_monotonic_ns();
+#endif
+}
+
+// Read the counter after the timed work, before any later instruction starts.
+inline uint64_t tsc_end() {
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int aux;
+  uint64_t ticks = __rdtscp(&aux);
+  _mm_lfence();
+  return ticks;
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("isb\n\tmrs %0, cntvct_el0\n\tisb" : "=r"(ticks) :: "memory");
+  return ticks;
+#else
+  return tsc_monotonic_ns();
+#endif
+}
+
+// Whether the counter runs at a constant rate in all power states. Always true off x86, where
+// the counter is the architected timer or the monotonic clock.
+inline bool tsc_invariant() {
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+  return (edx >> 8) & 1;
+#else
+  return true;
+#endif
+}
+
+// Counter ticks per millisecond, measured against CLOCK_MONOTONIC over about 20 ms on first use.
+inline double tsc_ticks_per_ms() {
+  static double rate = []() {
+    uint64_t start = tsc_monotonic_ns();
+    uint64_t tsc_start = tsc_begin();
+    uint64_t elapsed_ns;
+    do {
+      elapsed_ns = tsc_monotonic_ns() - start;
+    } while (elapsed_ns < 20000000ull);
+    uint64_t tsc_stop = tsc_end();
+    return (tsc_stop - tsc_start) / (elapsed_ns * 1e-6);
+  }();
+  return rate;
+}
+
+// Cost of a tsc_begin / tsc_end pair with nothing between them, in ticks: the minimum over
+// many pairs, as every larger value includes an interruption.
+inline uint64_t tsc_overhead() {
+  static uint64_t overhead = []() {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 10000; ++i) {
+      uint64_t start = tsc_begin();
+      uint64_t stop = tsc_end();
+      best = std::min(best, stop - start);
+    }
+    return best;
+  }();
+  return overhead;
+}
+
+// Calibrate the rate and the overhead now rather than inside the first timed region.
+inline void tsc_calibrate() {
+  tsc_ticks_per_ms();
+  tsc_overhead();
+}
+
+// Ticks between tsc_begin and tsc_end, less the timer's own cost.
+inline uint64_t tsc_elapsed(uint64_t start, uint64_t stop) {
+  uint64_t ticks = stop - start;
+  return (ticks > tsc_overhead()) ? ticks - tsc_overhead() : 0;
+}
+
+inline double tsc_to_ms(uint64_t ticks) {
+  return ticks / tsc_ticks_per_ms();
+}
+
+inline double tsc_to_ns(double ticks) {
+  return ticks * 1e6 / tsc_ticks_per_ms();
+}
+
+// Ticks of one sample: repetitions calls of work(i), i counting up from first.
+template <typename Work>
+inline uint64_t tsc_sample(Work &&work, int repetitions, long long first = 0) {
+  uint64_t start = tsc_begin();
+  for (int i = 0; i < repetitions; ++i) work(first + i);
+  return tsc_elapsed(start, tsc_end());
+}
+
+// Smallest power-of-two repetition count whose sample lasts at least min_sample_ns (and at
+// most max_repetitions).
+template <typename Work>
+inline int tsc_repetitions(Work &&work, double min_sample_ns, int max_repetitions = 1 << 20) {
+  int repetitions = 1;
+  while (repetitions < max_repetitions && tsc_to_ns(tsc_sample(work, repetitions)) < min_sample_ns) {
+    repetitions *= 2;
+  }
+  return repetitions;
+}
+
+// Net time of one repetition in nanoseconds, from one sample of repetitions calls.
+template <typename Work>
+inline double tsc_sample_ns(Work &&work, int repetitions, long long first = 0) {
+  return tsc_to_ns((double)tsc_sample(work, repetitions, first)) / repetitions;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdio.h> // for fprintf
+#include <stdlib.h> // for strtol
+#include <cmath> // for log2
+#include <fstream> // for reading tables
+#include <sstream> // for parsing lines
+#include <string> // for routine and strategy names
+#include <vector> // for the entries
+
+#include "native_kernels.hpp" // for the ISA of native strategies
+
+// Autotune tables: the fastest strategy measured for each (routine, M, N, batch) of a tuning grid
+// (solverbench tune), read back by solve_batched.hpp to dispatch calls.
+//
+// A strategy is "<backend>[/<isa>][@<threads>]": the backend name (backends.hpp), the ISA of the
+// native kernels for the native backend, and the OpenMP threads the batch is split over (omitted
+// for backends that do not run on the host). The precision follows the routine (float syev and
+// gesvd, double geqrf), and the job is fixed: the backends always compute vectors.
+//
+// The file is plain text, one entry per line after '#' comments:
+//   syev 32 32 256 native/avx512@4 1.234
+// (routine, M, N, batch count, strategy, average ms of the winner).
+
+struct TuneStrategy {
+  std::string backend;
+  Isa isa;           // native backend only
+  int threads;       // 0: not set
+};
+
+struct TuneEntry {
+  std::string routine;
+  int M, N;
+  int batch_count;
+  std::string strategy;
+  float time_ms;
+};
+
+struct TuneTable {
+  std::vector<TuneEntry> entries;
+};
+
+inline std::string tune_strategy_name(const TuneStrategy &s) {
+  std::string name = s.backend;
+  if (s.backend == "native") name += std::string("/") + isa_name(s.isa);
+  if (s.threads > 0) name += "@" + std::to_string(s.threads);
+  return name;
+}
+
+inline bool parse_tune_strategy(const std::string &name, TuneStrategy *s) {
+  std::string rest = name;
+  s->threads = 0;
+  s->isa = isa_best();
+
+  size_t at = rest.rfind('@');
+  if (at != std::string::npos) {
+    char *end;
+    long threads = strtol(rest.c_str() + at + 1, &end, 10);
+    if (*end != '\0' || threads < 1) return false;
+    s->threads = (int)threads;
+    rest = rest.substr(0, at);
+  }
+  if (rest.compare(0, 7, "native/") == 0) {
+    if (!parse_isa(rest.substr(7), &s->isa)) return false;
+    rest = "native";
+  }
+  s->backend = rest;
+  return !rest.empty();
+}
+
+inline bool tune_table_save(const TuneTable &table, const std::string &path) {
+  FILE *f = fopen(path.c_str(), "w");
+  if (!f) return false;
+  fprintf(f, "# solverbench tune table: routine M N batch strategy time_ms\n");
+  for (const TuneEntry &e : table.entries) {
+    fprintf(f, "%s %d %d %d %s %.4f\n", e.routine.c_str(), e.M, e.N, e.batch_count, e.strategy.c_str(), e.time_ms);
+  }
+  return fclose(f) == 0;
+}
+
+// false with the reason in error if the file cannot be read or a line is malformed.
+inline bool tune_table_load(const std::string &path, TuneTable *table, std::string *error) {
+  std::ifstream file(path);
+  if (!file) {
+    *error = "cannot read tune table " + path;
+    return false;
+  }
+  table->entries.clear();
+  std::string line;
+  int line_number = 0;
+  while (std::getline(file, line)) {
+    line_number++;
+    line = line.substr(0, line.find('#'));
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    std::istringstream iss(line);
+    TuneEntry e;
+    TuneStrategy s;
+    if (!(iss >> e.routine >> e.M >> e.N >> e.batch_count >> e.strategy >> e.time_ms) ||
+        e.M < 1 || e.N < 1 || e.batch_count < 1 || !parse_tune_strategy(e.strategy, &s)) {
+      *error = path + ":" + std::to_string(line_number) + ": malformed tune table entry";
+      return false;
+    }
+    table->entries.push_back(e);
+  }
+  return true;
+}
+
+// Nearest entry of the routine, by distance in log2 of M, N and batch count; NULL if the table
+// has none.
+inline const TuneEntry *tune_table_lookup(const TuneTable &table, const std::string &routine,
+                                          int M, int N, int batch_count) {
+  const TuneEntry *best = NULL;
+  double best_distance = 0.0;
+  for (const TuneEntry &e : table.entries) {
+    if (e.routine != routine) continue;
+    double dm = log2((double)e.M / M), dn = log2((double)e.N / N);
+    double db = log2((double)e.batch_count / batch_count);
+    double distance = dm * dm + dn * dn + db * db;
+    if (!best || distance < best_distance) {
+      best = &e;
+      best_distance = distance;
+    }
+  }
+  return best;
+}
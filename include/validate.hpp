@@ -0,0 +1,257 @@
+#pragma once
+
+#include <stdio.h> // for printf
+#include <float.h> // for FLT_EPSILON
+#include <cmath> // for sqrt, isfinite
+#include <vector> // for per-matrix errors
+
+// Post-run accuracy validation shared by the benches.
+//
+// Validation runs once, after the timed loop, on a fresh solve of the pristine batch.
+// The O(n^3) products (AV, V'V, USV', ...) are formed by the bench with a batched sgemm
+// on its own backend; the helpers here only turn them into per-matrix Frobenius-norm
+// errors, in parallel across the batch, and summarise them.
+
+struct ValidationMetric {
+  const char *name;
+  double threshold;  // errors above this are counted as failures
+  double max_error;
+  double sum_error;
+  int max_index;     // batch index of the worst matrix
+  int count;
+  int failures;
+  bool enabled;      // false when the bench did not compute the required outputs
+};
+
+struct EigenValidation {
+  ValidationMetric residual;       // ||AV - VL|| / ||A||
+  ValidationMetric orthogonality;  // ||V'V - I||
+  int info_failures;
+  int batch_count;
+};
+
+struct SvdValidation {
+  ValidationMetric reconstruction;       // ||A - USV'|| / ||A||
+  ValidationMetric left_orthogonality;   // ||U'U - I||
+  ValidationMetric right_orthogonality;  // ||V'V - I||
+  int info_failures;
+  int batch_count;
+};
+
+// Failure threshold for an n-dimensional problem, in units of n * machine epsilon.
+inline double validation_threshold(double factor, int n) {
+  return factor * (double)n * FLT_EPSILON;
+}
+
+inline ValidationMetric make_validation_metric(const char *name, double threshold, bool enabled = true) {
+  ValidationMetric metric;
+  metric.name = name;
+  metric.threshold = threshold;
+  metric.max_error = 0.0;
+  metric.sum_error = 0.0;
+  metric.max_index = -1;
+  metric.count = 0;
+  metric.failures = 0;
+  metric.enabled = enabled;
+  return metric;
+}
+
+inline void accumulate_validation_metric(ValidationMetric *metric, const std::vector<double> &errors) {
+  for (size_t b = 0; b < errors.size(); ++b) {
+    double err = errors[b];
+    if (!std::isfinite(err)) err = INFINITY;
+    if (metric->max_index < 0 || err > metric->max_error) {
+      metric->max_error = err;
+      metric->max_index = (int)b;
+    }
+    metric->sum_error += err;
+    metric->count++;
+    if (!(err <= metric->threshold)) metric->failures++;
+  }
+}
+
+template <typename Int>
+int count_info_failures(const Int *info, int batch_count) {
+  int failures = 0;
+  for (int b = 0; b < batch_count; ++b) {
+    if (info[b] != 0) failures++;
+  }
+  return failures;
+}
+
+inline double frobenius_norm(int m, int n, const float *A, int lda) {
+  double sum = 0.0;
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < m; ++i) {
+      double a = A[i + (size_t)j * lda];
+      sum += a * a;
+    }
+  }
+  return sqrt(sum);
+}
+
+// errors[b] = ||A_b V_b - V_b diag(W_b)|| / ||A_b||, given AV_b = A_b V_b (n x n, leading dimension n).
+inline void eigen_residuals(int n,
+                            const float *A, int lda, size_t strideA,
+                            const float *V, int ldv, size_t strideV,
+                            const float *W, size_t strideW,
+                            const float *AV,
+                            int batch_count,
+                            std::vector<double> &errors) {
+  errors.assign(batch_count, 0.0);
+  size_t strideAV = (size_t)n * n;
+
+  #pragma omp parallel for
+  for (int b = 0; b < batch_count; ++b) {
+    const float *A_b = A + b * strideA;
+    const float *V_b = V + b * strideV;
+    const float *W_b = W + b * strideW;
+    const float *AV_b = AV + b * strideAV;
+
+    double sum = 0.0;
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < n; ++i) {
+        double r = (double)AV_b[i + (size_t)j * n] - (double)V_b[i + (size_t)j * ldv] * W_b[j];
+        sum += r * r;
+      }
+    }
+
+    double norm_A = frobenius_norm(n, n, A_b, lda);
+    errors[b] = (norm_A > 0.0) ? sqrt(sum) / norm_A : sqrt(sum);
+  }
+}
+
+// errors[b] = ||G_b - I||, given the Gram matrix G_b = Q_b' Q_b (k x k, leading dimension k).
+inline void orthogonality_errors(int k, const float *G, int batch_count, std::vector<double> &errors) {
+  errors.assign(batch_count, 0.0);
+  size_t strideG = (size_t)k * k;
+
+  #pragma omp parallel for
+  for (int b = 0; b < batch_count; ++b) {
+    const float *G_b = G + b * strideG;
+
+    double sum = 0.0;
+    for (int j = 0; j < k; ++j) {
+      for (int i = 0; i < k; ++i) {
+        double r = (double)G_b[i + (size_t)j * k] - ((i == j) ? 1.0 : 0.0);
+        sum += r * r;
+      }
+    }
+    errors[b] = sqrt(sum);
+  }
+}
+
+// errors[b] = ||A_b - USV'_b|| / ||A_b||, given the reconstruction USV'_b (m x n, leading dimension m).
+inline void reconstruction_errors(int m, int n,
+                                  const float *A, int lda, size_t strideA,
+                                  const float *USVt,
+                                  int batch_count,
+                                  std::vector<double> &errors) {
+  errors.assign(batch_count, 0.0);
+  size_t strideR = (size_t)m * n;
+
+  #pragma omp parallel for
+  for (int b = 0; b < batch_count; ++b) {
+    const float *A_b = A + b * strideA;
+    const float *R_b = USVt + b * strideR;
+
+    double sum = 0.0;
+    for (int j = 0; j < n; ++j) {
+      for (int i = 0; i < m; ++i) {
+        double r = (double)A_b[i + (size_t)j * lda] - (double)R_b[i + (size_t)j * m];
+        sum += r * r;
+      }
+    }
+
+    double norm_A = frobenius_norm(m, n, A_b, lda);
+    errors[b] = (norm_A > 0.0) ? sqrt(sum) / norm_A : sqrt(sum);
+  }
+}
+
+// Summarise the eigen-decomposition checks from the host copies of the inputs, outputs and products.
+inline EigenValidation finish_eigen_validation(int n,
+                                               const float *A, int lda, size_t strideA,
+                                               const float *V, int ldv, size_t strideV,
+                                               const float *W, size_t strideW,
+                                               const float *AV, const float *VtV,
+                                               int info_failures,
+                                               int batch_count,
+                                               double threshold_factor) {
+  EigenValidation result;
+  double threshold = validation_threshold(threshold_factor, n);
+  result.residual = make_validation_metric("||AV - VL|| / ||A||", threshold);
+  result.orthogonality = make_validation_metric("||V'V - I||", threshold);
+  result.info_failures = info_failures;
+  result.batch_count = batch_count;
+
+  std::vector<double> errors;
+  eigen_residuals(n, A, lda, strideA, V, ldv, strideV, W, strideW, AV, batch_count, errors);
+  accumulate_validation_metric(&result.residual, errors);
+  orthogonality_errors(n, VtV, batch_count, errors);
+  accumulate_validation_metric(&result.orthogonality, errors);
+
+  return result;
+}
+
+// Summarise the SVD checks. USVt, UtU and VtV may be NULL when the corresponding
+// singular vectors were not computed; those metrics are then reported as skipped.
+inline SvdValidation finish_svd_validation(int m, int n,
+                                           const float *A, int lda, size_t strideA,
+                                           const float *USVt, const float *UtU, const float *VtV,
+                                           int info_failures,
+                                           int batch_count,
+                                           double threshold_factor) {
+  SvdValidation result;
+  int k = (m < n) ? m : n;
+  int max_mn = (m > n) ? m : n;
+  result.reconstruction = make_validation_metric("||A - USV'|| / ||A||",
+                                                 validation_threshold(threshold_factor, max_mn), USVt != NULL);
+  result.left_orthogonality = make_validation_metric("||U'U - I||",
+                                                     validation_threshold(threshold_factor, k), UtU != NULL);
+  result.right_orthogonality = make_validation_metric("||V'V - I||",
+                                                      validation_threshold(threshold_factor, k), VtV != NULL);
+  result.info_failures = info_failures;
+  result.batch_count = batch_count;
+
+  std::vector<double> errors;
+  if (USVt) {
+    reconstruction_errors(m, n, A, lda, strideA, USVt, batch_count, errors);
+    accumulate_validation_metric(&result.reconstruction, errors);
+  }
+  if (UtU) {
+    orthogonality_errors(k, UtU, batch_count, errors);
+    accumulate_validation_metric(&result.left_orthogonality, errors);
+  }
+  if (VtV) {
+    orthogonality_errors(k, VtV, batch_count, errors);
+    accumulate_validation_metric(&result.right_orthogonality, errors);
+  }
+
+  return result;
+}
+
+inline void print_validation_metric(const ValidationMetric &metric) {
+  if (!metric.enabled) {
+    printf("  %-22s skipped (vectors not computed)\n", metric.name);
+    return;
+  }
+  double mean = (metric.count > 0) ? metric.sum_error / metric.count : 0.0;
+  printf("  %-22s max %.3e (matrix %d), mean %.3e, failures %d/%d (threshold %.1e)\n",
+         metric.name, metric.max_error, metric.max_index, mean,
+         metric.failures, metric.count, metric.threshold);
+}
+
+inline void print_eigen_validation(const EigenValidation &result) {
+  printf("Validation:\n");
+  printf("  %-22s %d/%d\n", "info != 0", result.info_failures, result.batch_count);
+  print_validation_metric(result.residual);
+  print_validation_metric(result.orthogonality);
+}
+
+inline void print_svd_validation(const SvdValidation &result) {
+  printf("Validation:\n");
+  printf("  %-22s %d/%d\n", "info != 0", result.info_failures, result.batch_count);
+  print_validation_metric(result.reconstruction);
+  print_validation_metric(result.left_orthogonality);
+  print_validation_metric(result.right_orthogonality);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdlib.h> // for malloc
+#include <cblas.h> // for OpenBLAS
+
+#include "validate.hpp"
+
+// Host side of the post-run validation: the products are formed with one cblas_sgemm
+// per matrix, parallelised across the batch with OpenMP.
+
+// C_b = alpha * op(A_b) * op(B_b) + beta * C_b for every matrix of a strided batch.
+inline void sgemm_strided_batched_host(CBLAS_TRANSPOSE transA, CBLAS_TRANSPOSE transB,
+                                       int m, int n, int k,
+                                       float alpha,
+                                       const float *A, int lda, size_t strideA,
+                                       const float *B, int ldb, size_t strideB,
+                                       float beta,
+                                       float *C, int ldc, size_t strideC,
+                                       int batch_count) {
+  #pragma omp parallel for
+  for (int b = 0; b < batch_count; ++b) {
+    cblas_sgemm(CblasColMajor, transA, transB, m, n, k,
+                alpha, A + b * strideA, lda, B + b * strideB, ldb,
+                beta, C + b * strideC, ldc);
+  }
+}
+
+// C_b = A_b * diag(x_b) for every matrix of a strided batch (m x n, column scaling).
+inline void sdgmm_strided_batched_host(int m, int n,
+                                       const float *A, int lda, size_t strideA,
+                                       const float *x, size_t stridex,
+                                       float *C, int ldc, size_t strideC,
+                                       int batch_count) {
+  #pragma omp parallel for
+  for (int b = 0; b < batch_count; ++b) {
+    for (int j = 0; j < n; ++j) {
+      float s = x[b * stridex + j];
+      for (int i = 0; i < m; ++i) {
+        C[b * strideC + i + (size_t)j * ldc] = A[b * strideA + i + (size_t)j * lda] * s;
+      }
+    }
+  }
+}
+
+// Validate eigenvalues W and eigenvectors V of the symmetric matrices A (all on the host).
+inline EigenValidation validate_eigen_host(int n,
+                                           const float *A, int lda, size_t strideA,
+                                           const float *V, int ldv, size_t strideV,
+                                           const float *W, size_t strideW,
+                                           int info_failures,
+                                           int batch_count,
+                                           double threshold_factor) {
+  size_t strideP = (size_t)n * n;
+  float *AV = (float*)malloc(sizeof(float) * strideP * batch_count);
+  float *VtV = (float*)malloc(sizeof(float) * strideP * batch_count);
+
+  sgemm_strided_batched_host(CblasNoTrans, CblasNoTrans, n, n, n,
+                             1.0f, A, lda, strideA, V, ldv, strideV,
+                             0.0f, AV, n, strideP, batch_count);
+  sgemm_strided_batched_host(CblasTrans, CblasNoTrans, n, n, n,
+                             1.0f, V, ldv, strideV, V, ldv, strideV,
+                             0.0f, VtV, n, strideP, batch_count);
+
+  EigenValidation result = finish_eigen_validation(n, A, lda, strideA, V, ldv, strideV, W, strideW,
+                                                   AV, VtV, info_failures, batch_count, threshold_factor);
+  free(AV);
+  free(VtV);
+  return result;
+}
+
+// Validate the SVD of the general matrices A (all on the host). U holds left singular vectors
+// as columns and VT right singular vectors as rows; pass NULL for vectors that were not computed.
+inline SvdValidation validate_svd_host(int m, int n,
+                                       const float *A, int lda, size_t strideA,
+                                       const float *S, size_t strideS,
+                                       const float *U, int ldu, size_t strideU,
+                                       const float *VT, int ldvt, size_t strideVT,
+                                       int info_failures,
+                                       int batch_count,
+                                       double threshold_factor) {
+  int k = (m < n) ? m : n;
+  size_t strideK = (size_t)k * k;
+  float *USVt = NULL, *UtU = NULL, *VtV = NULL;
+
+  if (U) {
+    UtU = (float*)malloc(sizeof(float) * strideK * batch_count);
+    sgemm_strided_batched_host(CblasTrans, CblasNoTrans, k, k, m,
+                               1.0f, U, ldu, strideU, U, ldu, strideU,
+                               0.0f, UtU, k, strideK, batch_count);
+  }
+  if (VT) {
+    VtV = (float*)malloc(sizeof(float) * strideK * batch_count);
+    sgemm_strided_batched_host(CblasNoTrans, CblasTrans, k, k, n,
+                               1.0f, VT, ldvt, strideVT, VT, ldvt, strideVT,
+                               0.0f, VtV, k, strideK, batch_count);
+  }
+  if (U && VT) {
+    size_t strideUS = (size_t)m * k;
+    size_t strideR = (size_t)m * n;
+    float *US = (float*)malloc(sizeof(float) * strideUS * batch_count);
+    USVt = (float*)malloc(sizeof(float) * strideR * batch_count);
+    sdgmm_strided_batched_host(m, k, U, ldu, strideU, S, strideS, US, m, strideUS, batch_count);
+    sgemm_strided_batched_host(CblasNoTrans, CblasNoTrans, m, n, k,
+                               1.0f, US, m, strideUS, VT, ldvt, strideVT,
+                               0.0f, USVt, m, strideR, batch_count);
+    free(US);
+  }
+
+  SvdValidation result = finish_svd_validation(m, n, A, lda, strideA, USVt, UtU, VtV,
+                                               info_failures, batch_count, threshold_factor);
+  free(USVt);
+  free(UtU);
+  free(VtV);
+  return result;
+}
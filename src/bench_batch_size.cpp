@@ -0,0 +1,293 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for measurements
+#include <map> // for measurements by batch size
+#include <cmath> // for sqrt
+#include <iostream> // for cout/cerr
+#include <chrono> // for high-resolution timing
+#include <cstring> // for memcpy
+#include <algorithm> // for std::sort, std::min, std::max
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the batched OpenBLAS paths
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "telemetry.hpp" // for sorted_percentile
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Find the batch size that maximises throughput under a latency SLO on the CPU.
+//
+// The batch count is doubled from 1 until the per-batch latency percentile exceeds the SLO
+// (or --max-batch-count is reached), then bisected between the last compliant and the first
+// violating batch count. Every point is timed over --iterations solves of a fresh copy.
+// The knee is the smallest batch count reaching --knee-fraction of the peak throughput; the
+// suggested bench_service settings use the same rule among the SLO-compliant batch counts.
+
+struct BatchPoint {
+  int batch_count;
+  float mean_ms, p50_ms, tail_ms;  // per-batch latency; tail_ms at --percentile
+  double throughput;               // matrices per second
+  bool compliant;                  // tail_ms <= SLO
+};
+
+// Time iterations solves of batch_count matrices tiled from the pool.
+BatchPoint measure_batch(const CpuSolverLayout &layout, const float *pool, int pool_size,
+                         int batch_count, int iterations, double percentile, float slo_ms) {
+  size_t size_A = layout.strideA * (size_t)batch_count;
+  float *hA = (float*)malloc(sizeof(float) * size_A);
+  float *hA_copy = (float*)malloc(sizeof(float) * size_A);
+  float *hW = (float*)malloc(sizeof(float) * layout.strideW * batch_count);
+  float *hU = (float*)malloc(sizeof(float) * (layout.strideU ? layout.strideU : 1) * batch_count);
+  float *hVT = (float*)malloc(sizeof(float) * (layout.strideVT ? layout.strideVT : 1) * batch_count);
+  for (int b = 0; b < batch_count; ++b) {
+    memcpy(hA + b * layout.strideA, pool + (b % pool_size) * layout.strideA, sizeof(float) * layout.strideA);
+  }
+
+  // one untimed solve to fault in the buffers and start the OpenMP team
+  memcpy(hA_copy, hA, sizeof(float) * size_A);
+  cpu_solver_batched(layout, hA_copy, hW, hU, hVT, NULL, batch_count);
+
+  std::vector<float> timings;
+  for (int iter = 0; iter < iterations; ++iter) {
+    // Copy the original matrices for this iteration
+    memcpy(hA_copy, hA, sizeof(float) * size_A);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    cpu_solver_batched(layout, hA_copy, hW, hU, hVT, NULL, batch_count);
+    auto stop = std::chrono::high_resolution_clock::now();
+
+    timings.push_back(std::chrono::duration<float, std::milli>(stop - start).count());
+  }
+
+  free(hA);
+  free(hA_copy);
+  free(hW);
+  free(hU);
+  free(hVT);
+
+  BatchPoint point = {};
+  point.batch_count = batch_count;
+  for (float t : timings) point.mean_ms += t;
+  point.mean_ms /= timings.size();
+  std::sort(timings.begin(), timings.end());
+  point.p50_ms = sorted_percentile(timings, 50.0);
+  point.tail_ms = sorted_percentile(timings, percentile);
+  point.throughput = (point.mean_ms > 0.0f) ? batch_count / (point.mean_ms / 1000.0) : 0.0;
+  point.compliant = point.tail_ms <= slo_ms;
+  return point;
+}
+
+// Search the batch count for a throughput-optimal, latency-compliant configuration.
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_batch_size");
+
+  program.add_argument("--solver")
+      .help("Solver path (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyevd"));
+
+  program.add_argument("-m", "--rows")
+      .help("Number of rows (M, sgesvd only)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N, or number of columns for sgesvd)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("--pool")
+      .help("Number of distinct matrices tiled into every batch")
+      .default_value(256)
+      .scan<'i', int>();
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of timed solves per batch count")
+      .default_value(50)
+      .scan<'i', int>();
+
+  program.add_argument("--slo-ms")
+      .help("Latency SLO of one batched solve in milliseconds")
+      .default_value(10.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--percentile")
+      .help("Latency percentile held to the SLO")
+      .default_value(99.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--max-batch-count")
+      .help("Upper limit of the search")
+      .default_value(65536)
+      .scan<'i', int>();
+
+  program.add_argument("--knee-fraction")
+      .help("The knee is the smallest batch count reaching this fraction of the peak throughput")
+      .default_value(0.9f)
+      .scan<'f', float>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str = program.get<std::string>("--solver");
+  int M = program.get<int>("--rows");
+  int N = program.get<int>("--size");
+  int random_seed = program.get<int>("--random-seed");
+  int pool_size = program.get<int>("--pool");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  int iterations = program.get<int>("--iterations");
+  float slo_ms = program.get<float>("--slo-ms");
+  float percentile = program.get<float>("--percentile");
+  int max_batch_count = program.get<int>("--max-batch-count");
+  float knee_fraction = program.get<float>("--knee-fraction");
+
+  CpuSolver solver;
+  if (!parse_cpu_solver(solver_str, &solver)) {
+    std::cerr << "Unknown solver: " << solver_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (iterations < 1) iterations = 1;
+  if (pool_size < 1) pool_size = 1;
+  if (max_batch_count < 1) max_batch_count = 1;
+
+  CpuSolverLayout layout = make_cpu_solver_layout(solver, M, N, M);
+  M = layout.M;
+
+  float *pool;
+  if (solver == CpuSolver::sgesvd) {
+    if (spectrum == SpectrumKind::random) {
+      pool = create_general_matrices(M, N, layout.lda, layout.strideA, pool_size, random_seed);
+    } else {
+      pool = create_general_matrices_with_spectrum<float>(M, N, layout.lda, layout.strideA, pool_size,
+                                                           random_seed, spectrum, cond);
+    }
+  } else {
+    if (spectrum == SpectrumKind::random) {
+      pool = create_symmetric_matrices(N, layout.lda, layout.strideA, pool_size, random_seed);
+    } else {
+      pool = create_symmetric_matrices_with_spectrum<float>(N, layout.lda, layout.strideA, pool_size,
+                                                             random_seed, spectrum, cond);
+    }
+  }
+
+  std::map<int, BatchPoint> points;
+  auto measure = [&](int batch_count) {
+    BatchPoint point = measure_batch(layout, pool, pool_size, batch_count, iterations, percentile, slo_ms);
+    points[batch_count] = point;
+    printf("  batch %6d: p%g %.3f ms, %.1f matrices/s%s\n", batch_count, percentile, point.tail_ms,
+           point.throughput, point.compliant ? "" : " (over SLO)");
+    fflush(stdout);
+    return point.compliant;
+  };
+
+  // expand: double until the SLO breaks
+  printf("Searching batch counts...\n");
+  int lo = 0, hi = 0;  // last compliant / first violating batch count
+  for (int b = 1; ; b = std::min(2 * b, max_batch_count)) {
+    if (measure(b)) lo = b;
+    else { hi = b; break; }
+    if (b == max_batch_count) break;
+  }
+
+  // bisect between the last compliant and the first violating batch count
+  if (hi > 0) {
+    while (hi - lo > 1) {
+      int mid = lo + (hi - lo) / 2;
+      if (measure(mid)) lo = mid;
+      else hi = mid;
+    }
+  }
+
+  // peak and knee over every measured point
+  double peak = 0.0;
+  for (const auto &p : points) peak = std::max(peak, p.second.throughput);
+  int knee = 0;
+  for (const auto &p : points) {
+    if (p.second.throughput >= knee_fraction * peak) { knee = p.first; break; }
+  }
+  const BatchPoint *best = NULL;
+  for (const auto &p : points) {
+    if (p.second.compliant && (!best || p.second.throughput > best->throughput)) best = &p.second;
+  }
+
+  // print results
+  printf("\n===== Batch Size Search (CPU - OpenBLAS) =====\n");
+  printf("Solver: %s\n", cpu_solver_name(solver));
+  if (solver == CpuSolver::sgesvd) printf("Matrix size: %d x %d\n", M, N);
+  else printf("Matrix size: %d x %d\n", N, N);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
+  printf("SLO: p%g <= %.3f ms per batched solve\n", percentile, slo_ms);
+  printf("Timing iterations per batch count: %d\n", iterations);
+  printf("  %8s %12s %12s %12s %16s %s\n", "batch", "mean (ms)", "p50 (ms)", "tail (ms)", "matrices/s", "SLO");
+  for (const auto &p : points) {
+    const BatchPoint &q = p.second;
+    printf("  %8d %12.3f %12.3f %12.3f %16.1f %s\n",
+           q.batch_count, q.mean_ms, q.p50_ms, q.tail_ms, q.throughput, q.compliant ? "ok" : "over");
+  }
+  printf("Peak throughput: %.1f matrices/s\n", peak);
+  printf("Knee: batch count %d (%.0f%% of peak)\n", knee, 100.0f * knee_fraction);
+  if (lo > 0) {
+    const BatchPoint &largest = points[lo];
+    printf("Largest SLO-compliant batch count: %d (p%g %.3f ms, %.1f matrices/s)%s\n",
+           lo, percentile, largest.tail_ms, largest.throughput,
+           (hi == 0) ? " - search limit reached" : "");
+    printf("Best SLO-compliant throughput: batch count %d (%.1f matrices/s)\n",
+           best->batch_count, best->throughput);
+
+    // suggest the smallest compliant batch count that is within the knee fraction of the best;
+    // the remaining SLO budget is what a request may wait for its micro-batch to fill
+    const BatchPoint *suggested = best;
+    for (const auto &p : points) {
+      if (p.second.compliant && p.second.throughput >= knee_fraction * best->throughput) {
+        suggested = &p.second;
+        break;
+      }
+    }
+    int max_wait_us = (int)std::max(0.0f, (slo_ms - suggested->tail_ms) * 1000.0f);
+    printf("Suggested micro-batching: --max-batch %d --max-wait-us %d\n",
+           suggested->batch_count, max_wait_us);
+  } else {
+    printf("Largest SLO-compliant batch count: none (a single matrix takes %.3f ms at p%g)\n",
+           points[1].tail_ms, percentile);
+  }
+  printf("==============================================\n\n");
+  print_environment();
+
+  // clean up
+  free(pool);
+}
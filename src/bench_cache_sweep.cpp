@@ -0,0 +1,258 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for measurements
+#include <iostream> // for cout/cerr
+#include <cstring> // for memcpy
+#include <cmath> // for floor, ceil
+#include <algorithm> // for std::sort, std::unique
+#include <omp.h> // for omp_get_wtime, omp_get_max_threads
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the batched OpenBLAS paths
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "cache_topology.hpp" // for the cache sizes
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Throughput of the CPU batch loop around the cache capacities.
+//
+// The working set of one batched solve is the pristine batch it is restored from, the batch
+// being solved, the outputs (W, and U and VT for sgesvd) and one workspace per thread. For every
+// data cache level the sweep picks the batch counts whose working set is --below and --above
+// the level's capacity for the thread count (see cache_topology.hpp), plus one matrix and a
+// batch well beyond the last level, and times each. Every result is annotated with the
+// innermost level its working set fits in; the largest batch that still fits the last level
+// is the largest cache-resident production batch.
+
+struct SweepPoint {
+  int batch_count;
+  double working_set;   // bytes
+  std::string fits;     // "L1", "L2", ... or "DRAM"
+  int iterations;
+  float mean_ms;
+  double throughput;    // matrices per second
+};
+
+// Time batched solves of batch_count matrices tiled from the pool for at least min_time_ms.
+void measure_point(const CpuSolverLayout &layout, const float *pool, int pool_size, float min_time_ms,
+                   SweepPoint *point) {
+  int batch_count = point->batch_count;
+  size_t size_A = layout.strideA * (size_t)batch_count;
+  float *hA = (float*)malloc(sizeof(float) * size_A);
+  float *hA_copy = (float*)malloc(sizeof(float) * size_A);
+  float *hW = (float*)malloc(sizeof(float) * layout.strideW * batch_count);
+  float *hU = (float*)malloc(sizeof(float) * (layout.strideU ? layout.strideU : 1) * batch_count);
+  float *hVT = (float*)malloc(sizeof(float) * (layout.strideVT ? layout.strideVT : 1) * batch_count);
+  for (int b = 0; b < batch_count; ++b) {
+    memcpy(hA + b * layout.strideA, pool + (b % pool_size) * layout.strideA, sizeof(float) * layout.strideA);
+  }
+
+  // one untimed solve to fault in the buffers and start the OpenMP team
+  memcpy(hA_copy, hA, sizeof(float) * size_A);
+  cpu_solver_batched(layout, hA_copy, hW, hU, hVT, NULL, batch_count);
+
+  double total = 0.0;
+  int iterations = 0;
+  while (iterations < 3 || total * 1e3 < min_time_ms) {
+    // Copy the original matrices for this iteration
+    memcpy(hA_copy, hA, sizeof(float) * size_A);
+    double start = omp_get_wtime();
+    cpu_solver_batched(layout, hA_copy, hW, hU, hVT, NULL, batch_count);
+    total += omp_get_wtime() - start;
+    iterations++;
+  }
+
+  free(hA);
+  free(hA_copy);
+  free(hW);
+  free(hU);
+  free(hVT);
+
+  point->iterations = iterations;
+  point->mean_ms = (float)(total / iterations * 1e3);
+  point->throughput = batch_count / (total / iterations);
+}
+
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_cache_sweep");
+
+  program.add_argument("--solver")
+      .help("Solver path (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyevd"));
+
+  program.add_argument("-m", "--rows")
+      .help("Number of rows (M, sgesvd only)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N, or number of columns for sgesvd)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("--pool")
+      .help("Number of distinct matrices tiled into every batch")
+      .default_value(256)
+      .scan<'i', int>();
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--below")
+      .help("Working set of the batch just below a cache level, as a fraction of its capacity")
+      .default_value(0.8f)
+      .scan<'f', float>();
+
+  program.add_argument("--above")
+      .help("Working set of the batch just above a cache level, as a fraction of its capacity")
+      .default_value(1.25f)
+      .scan<'f', float>();
+
+  program.add_argument("--min-time-ms")
+      .help("Minimum timed duration per batch count (at least 3 solves)")
+      .default_value(200.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--max-batch-count")
+      .help("Upper limit of the batch counts")
+      .default_value(1 << 20)
+      .scan<'i', int>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str = program.get<std::string>("--solver");
+  int M = program.get<int>("--rows");
+  int N = program.get<int>("--size");
+  int random_seed = program.get<int>("--random-seed");
+  int pool_size = program.get<int>("--pool");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  float below = program.get<float>("--below");
+  float above = program.get<float>("--above");
+  float min_time_ms = program.get<float>("--min-time-ms");
+  int max_batch_count = program.get<int>("--max-batch-count");
+
+  CpuSolver solver;
+  if (!parse_cpu_solver(solver_str, &solver)) {
+    std::cerr << "Unknown solver: " << solver_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (pool_size < 1) pool_size = 1;
+  if (max_batch_count < 1) max_batch_count = 1;
+
+  std::vector<CacheLevel> levels = read_cache_levels();
+  if (levels.empty()) {
+    std::cerr << "No cache information in /sys/devices/system/cpu/cpu*/cache" << std::endl;
+    return 1;
+  }
+
+  CpuSolverLayout layout = make_cpu_solver_layout(solver, M, N, M);
+  M = layout.M;
+  int threads = omp_get_max_threads();
+
+  // working set: pristine and solved batch, outputs, and the per-thread workspaces
+  double per_matrix = sizeof(float) * (2.0 * layout.strideA + layout.strideW + layout.strideU + layout.strideVT);
+  double fixed = (double)threads * (sizeof(float) * layout.lwork + sizeof(lapack_int) * layout.liwork);
+
+  std::vector<int> batch_counts = {1};
+  for (const CacheLevel &level : levels) {
+    double capacity = (double)cache_capacity(level, threads);
+    double fit = floor((below * capacity - fixed) / per_matrix);
+    double spill = ceil((above * capacity - fixed) / per_matrix);
+    if (fit >= 1.0) batch_counts.push_back((int)std::min(fit, (double)max_batch_count));
+    if (spill >= 1.0) batch_counts.push_back((int)std::min(spill, (double)max_batch_count));
+  }
+  double beyond = ceil((4.0 * cache_capacity(levels.back(), threads) - fixed) / per_matrix);
+  batch_counts.push_back((int)std::min(std::max(beyond, 1.0), (double)max_batch_count));
+  std::sort(batch_counts.begin(), batch_counts.end());
+  batch_counts.erase(std::unique(batch_counts.begin(), batch_counts.end()), batch_counts.end());
+
+  float *pool;
+  if (solver == CpuSolver::sgesvd) {
+    if (spectrum == SpectrumKind::random) {
+      pool = create_general_matrices(M, N, layout.lda, layout.strideA, pool_size, random_seed);
+    } else {
+      pool = create_general_matrices_with_spectrum<float>(M, N, layout.lda, layout.strideA, pool_size,
+                                                           random_seed, spectrum, cond);
+    }
+  } else {
+    if (spectrum == SpectrumKind::random) {
+      pool = create_symmetric_matrices(N, layout.lda, layout.strideA, pool_size, random_seed);
+    } else {
+      pool = create_symmetric_matrices_with_spectrum<float>(N, layout.lda, layout.strideA, pool_size,
+                                                             random_seed, spectrum, cond);
+    }
+  }
+
+  std::vector<SweepPoint> points;
+  for (int batch_count : batch_counts) {
+    SweepPoint point = {};
+    point.batch_count = batch_count;
+    point.working_set = fixed + per_matrix * batch_count;
+    point.fits = cache_fit(levels, point.working_set, threads);
+    measure_point(layout, pool, pool_size, min_time_ms, &point);
+    points.push_back(point);
+    printf("  batch %8d (%s): %.1f matrices/s\n", batch_count, point.fits.c_str(), point.throughput);
+    fflush(stdout);
+  }
+
+  double peak = 0.0;
+  for (const SweepPoint &p : points) peak = std::max(peak, p.throughput);
+
+  // print results
+  printf("\n===== Cache Sweep (CPU - OpenBLAS) =====\n");
+  printf("Solver: %s\n", cpu_solver_name(solver));
+  if (solver == CpuSolver::sgesvd) printf("Matrix size: %d x %d\n", M, N);
+  else printf("Matrix size: %d x %d\n", N, N);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
+  print_cache_levels(levels, threads);
+  printf("Working set: %.0f bytes per matrix + %.0f bytes of workspaces\n", per_matrix, fixed);
+  printf("  %10s %14s %6s %8s %12s %16s %8s\n", "batch", "working set", "fits", "solves", "mean (ms)", "matrices/s", "of peak");
+  for (const SweepPoint &p : points) {
+    printf("  %10d %10.2f MiB %6s %8d %12.3f %16.1f %7.1f%%\n", p.batch_count, p.working_set / 1048576.0,
+           p.fits.c_str(), p.iterations, p.mean_ms, p.throughput, 100.0 * p.throughput / peak);
+  }
+  for (const CacheLevel &level : levels) {
+    double resident = floor((cache_capacity(level, threads) - fixed) / per_matrix);
+    if (resident >= 1.0) printf("Largest batch resident in L%d: %.0f\n", level.level, resident);
+    else printf("Largest batch resident in L%d: none (one matrix does not fit)\n", level.level);
+  }
+  printf("========================================\n\n");
+  print_environment();
+
+  // clean up
+  free(pool);
+}
@@ -0,0 +1,435 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <random> // for random number generation
+#include <vector> // for storing timing results
+#include <cmath> // for sqrt in standard deviation calculation
+#include <iostream> // for cout/cerr
+#include <chrono> // for high-resolution timing
+#include <cstring> // for memcpy
+#include <algorithm> // for std::max
+
+#include <argparse/argparse.hpp>
+
+#include "jacobi_cpu.hpp" // for the native Jacobi engine
+#include "validate_host.hpp" // for post-run validation
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "trace.hpp" // for --trace timelines
+#include "pareto.hpp" // for the tolerance / max-sweeps exploration
+#include "telemetry.hpp" // for per-matrix convergence telemetry
+#include "tsc_timer.hpp" // for the per-matrix solve times of the telemetry
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Compute the eigenvalues and eigenvectors of an array of symmetric matrices on the CPU
+// with the native Jacobi engine (the CPU counterpart of bench_rocsolver_ssyevj_strided_batched)
+
+float *create_matrices(int N,
+                      int lda,
+                      size_t strideA,
+                      int batch_count,
+                      int random_seed) {
+  // allocate space for input matrix data on CPU
+  float *hA = (float*)malloc(sizeof(float) * strideA * batch_count);
+
+  // generate random symmetric matrices
+  std::mt19937 gen(random_seed);
+  std::uniform_real_distribution<float> dis(-10.0, 10.0);
+
+  for (int b = 0; b < batch_count; ++b) {
+    for (int i = 0; i < N; ++i) {
+      // Diagonal elements
+      hA[i + i * lda + b * strideA] = dis(gen) * 10.0; // Make diagonal dominant
+
+      // Off-diagonal elements (ensure symmetry)
+      for (int j = i + 1; j < N; ++j) {
+        float value = dis(gen);
+        hA[i + j * lda + b * strideA] = value;
+        hA[j + i * lda + b * strideA] = value; // Symmetric counterpart
+      }
+    }
+  }
+
+  return hA;
+}
+
+// Solve every matrix of the batch with jacobi_ssyevj, one matrix per OpenMP iteration
+void ssyevj_batch(int N, float *A, int lda, size_t strideA,
+                  float tolerance, float *residual, int max_sweeps, int *n_sweeps,
+                  float *W, size_t strideW, int *info, int batch_count, uint64_t *ticks = NULL) {
+  size_t lwork = jacobi_ssyevj_workspace_size(N);
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < batch_count; ++b) {
+      // sorted ascending, eigenvectors computed, upper triangle referenced
+      int64_t solve_start = trace_begin();
+      uint64_t tsc_start = ticks ? tsc_begin() : 0;
+      jacobi_ssyevj(true, true, 'U', N, A + b * strideA, lda,
+                    tolerance, residual + b, max_sweeps, n_sweeps + b,
+                    W + b * strideW, info + b, thread_work);
+      if (ticks) ticks[b] = tsc_elapsed(tsc_start, tsc_end());
+      trace_end("jacobi_ssyevj", "solve", solve_start, b);
+    }
+
+    // Free thread-local workspace
+    free(thread_work);
+  }
+}
+
+// Use the native Jacobi engine to compute eigenvalues and eigenvectors of an array of real symmetric matrices.
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_native_ssyevj");
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-l", "--lda")
+      .help("Leading dimension (lda)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-s", "--stride")
+      .help("Stride between matrices (default: lda * N)")
+      .scan<'i', int>();
+
+  program.add_argument("-b", "--batch-count")
+      .help("Batch count")
+      .default_value(2)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of iterations for timing")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-w", "--warmup-time")
+      .help("Warm-up time in milliseconds before timing")
+      .default_value(1000)
+      .scan<'i', int>();
+
+  program.add_argument("-t", "--tolerance")
+      .help("Tolerance for Jacobi method")
+      .default_value(1e-7f)
+      .scan<'f', float>();
+
+  program.add_argument("-j", "--max-sweeps")
+      .help("Maximum number of sweeps for Jacobi method")
+      .default_value(100)
+      .scan<'i', int>();
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--validate")
+      .help("Validate the results once after timing")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--validate-threshold")
+      .help("Validation failure threshold in units of N * machine epsilon")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--trace")
+      .help("Write a timeline of the run in Chrome trace format (chrome://tracing, Perfetto) to this file")
+      .default_value(std::string(""));
+
+  program.add_argument("--trace-capacity")
+      .help("Spans kept per thread for --trace; the oldest are overwritten first")
+      .default_value(65536)
+      .scan<'i', int>();
+
+  program.add_argument("--pareto")
+      .help("Explore the tolerance / max-sweeps trade-off after the timed run")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--tol-min")
+      .help("Smallest tolerance of the --pareto log grid")
+      .default_value(1e-8f)
+      .scan<'f', float>();
+
+  program.add_argument("--tol-max")
+      .help("Largest tolerance of the --pareto log grid")
+      .default_value(1e-1f)
+      .scan<'f', float>();
+
+  program.add_argument("--tol-steps")
+      .help("Number of tolerances on the --pareto log grid")
+      .default_value(8)
+      .scan<'i', int>();
+
+  program.add_argument("--sweep-limits")
+      .help("Comma-separated max-sweeps values for --pareto (default: --max-sweeps)");
+
+  program.add_argument("--telemetry")
+      .help("Report per-matrix convergence (sweeps, residual, info) of the timed iterations")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--isa")
+      .help("Instruction set of the Jacobi kernels (auto, generic, avx2, avx512)")
+      .default_value(std::string("auto"));
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  int N = program.get<int>("--size");
+  int lda = program.get<int>("--lda");
+  int batch_count = program.get<int>("--batch-count");
+  int random_seed = program.get<int>("--random-seed");
+  int iterations = program.get<int>("--iterations");
+  int warmup_time = program.get<int>("--warmup-time");
+  float tolerance = program.get<float>("--tolerance");
+  int max_sweeps = program.get<int>("--max-sweeps");
+  bool validate = program.get<bool>("--validate");
+  float validate_threshold = program.get<float>("--validate-threshold");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  std::string trace_path = program.get<std::string>("--trace");
+  int trace_capacity = program.get<int>("--trace-capacity");
+  bool pareto = program.get<bool>("--pareto");
+  bool telemetry = program.get<bool>("--telemetry");
+  std::string isa_str = program.get<std::string>("--isa");
+  float tol_min = program.get<float>("--tol-min");
+  float tol_max = program.get<float>("--tol-max");
+  int tol_steps = program.get<int>("--tol-steps");
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  Isa isa;
+  if (!parse_isa(isa_str, &isa)) {
+    std::cerr << "Unknown ISA: " << isa_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+  if (!select_native_isa(isa)) {
+    std::cerr << "ISA not supported by this CPU: " << isa_str << " (supported: " << isa_supported_names() << ")" << std::endl;
+    return 1;
+  }
+
+  if (lda < N) lda = N;
+  if (!trace_path.empty()) trace_enable(trace_capacity);
+
+  // ストライドの計算（指定されていない場合はlda * Nを使用）
+  size_t strideA;
+  if (program.present("--stride")) {
+    strideA = program.get<int>("--stride");
+  } else {
+    strideA = lda * N;
+  }
+
+  int64_t trace_start = trace_begin();
+  float *hA;
+  if (spectrum == SpectrumKind::random) {
+    hA = create_matrices(N, lda, strideA, batch_count, random_seed);
+  } else {
+    hA = create_symmetric_matrices_with_spectrum<float>(N, lda, strideA, batch_count, random_seed,
+                                                         spectrum, cond);
+  }
+  trace_end("generate", "setup", trace_start);
+  trace_start = trace_begin();
+
+  // calculate the sizes of our arrays
+  size_t size_A = strideA * (size_t)batch_count;   // elements in array for matrices
+  size_t strideW = N;                              // stride of eigenvalues
+  size_t size_W = strideW * (size_t)batch_count;   // elements in array for eigenvalues
+
+  // allocate memory for eigenvalues and convergence information
+  float *hW = (float*)malloc(sizeof(float) * size_W);
+  float *hResidual = (float*)malloc(sizeof(float) * batch_count);
+  int *hNSweeps = (int*)malloc(sizeof(int) * batch_count);
+  int *hInfo = (int*)malloc(sizeof(int) * batch_count);
+
+  // Create a copy of the original matrices for each iteration
+  float *hA_copy = (float*)malloc(sizeof(float) * size_A);
+  trace_end("allocate", "setup", trace_start);
+
+  // vector to store timing results
+  std::vector<float> timings;
+
+  // time-based warm-up phase
+  printf("Performing warm-up for %d ms...\n", warmup_time);
+
+  int64_t trace_warmup = trace_begin();
+  auto warmup_start = std::chrono::high_resolution_clock::now();
+  auto warmup_current = warmup_start;
+  float warmup_elapsed = 0.0f;
+  int warmup_count = 0;
+
+  while (warmup_elapsed < warmup_time || warmup_count == 0) {
+    // Copy the original matrices for this warm-up iteration
+    trace_start = trace_begin();
+    memcpy(hA_copy, hA, sizeof(float) * size_A);
+    trace_end("restore", "copy", trace_start);
+
+    ssyevj_batch(N, hA_copy, lda, strideA, tolerance, hResidual, max_sweeps, hNSweeps,
+                 hW, strideW, hInfo, batch_count);
+
+    warmup_count++;
+
+    // check elapsed time
+    warmup_current = std::chrono::high_resolution_clock::now();
+    warmup_elapsed = std::chrono::duration<float, std::milli>(warmup_current - warmup_start).count();
+  }
+
+  trace_end("warm-up", "phase", trace_warmup);
+  printf("Completed %d warm-up iterations in %.2f ms\n", warmup_count, warmup_elapsed);
+
+  // per-matrix convergence and solve time of the timed iterations
+  JacobiTelemetry convergence;
+  std::vector<uint64_t> matrix_ticks;
+  if (telemetry) {
+    matrix_ticks.resize(batch_count);
+    tsc_calibrate();  // rate and timer overhead, before timing
+  }
+
+  // run the computation multiple times for timing
+  for (int iter = 0; iter < iterations; ++iter) {
+    // Copy the original matrices for this iteration
+    trace_start = trace_begin();
+    memcpy(hA_copy, hA, sizeof(float) * size_A);
+    trace_end("restore", "copy", trace_start, iter);
+
+    // start timing
+    trace_start = trace_begin();
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ssyevj_batch(N, hA_copy, lda, strideA, tolerance, hResidual, max_sweeps, hNSweeps,
+                 hW, strideW, hInfo, batch_count, telemetry ? matrix_ticks.data() : NULL);
+
+    // stop timing
+    auto stop = std::chrono::high_resolution_clock::now();
+    trace_end("iteration", "phase", trace_start, iter);
+
+    // calculate elapsed time
+    float elapsed_time = std::chrono::duration<float, std::milli>(stop - start).count();
+    timings.push_back(elapsed_time);
+
+    // record the per-matrix convergence outside the timed region
+    if (telemetry) {
+      record_jacobi_telemetry(&convergence, elapsed_time, hNSweeps, hResidual, hInfo, batch_count,
+                              [](void *dst, const void *src, size_t bytes) {
+                                memcpy(dst, src, bytes);
+                              });
+      for (uint64_t t : matrix_ticks) convergence.matrix_ms.push_back((float)tsc_to_ms(t));
+    }
+  }
+
+  // calculate statistics
+  float avg_time = 0.0f;
+  for (float t : timings) avg_time += t;
+  avg_time /= timings.size();
+
+  float std_dev = 0.0f;
+  for (float t : timings) std_dev += (t - avg_time) * (t - avg_time);
+  std_dev = sqrt(std_dev / timings.size());
+
+  // validate the results outside the timed region (hA_copy holds the last iteration's eigenvectors)
+  EigenValidation validation = {};
+  if (validate) {
+    trace_start = trace_begin();
+    validation = validate_eigen_host(N, hA, lda, strideA, hA_copy, lda, strideA, hW, strideW,
+                                     count_info_failures(hInfo, batch_count), batch_count,
+                                     validate_threshold);
+    trace_end("validate", "phase", trace_start);
+  }
+
+  // print timing results
+  printf("\n===== Performance Results (CPU - native Jacobi) =====\n");
+  printf("Matrix size: %d x %d\n", N, N);
+  printf("Batch count: %d\n", batch_count);
+  printf("Kernels: %s (%s)\n", isa_name(native_kernels().isa), isa_str == "auto" ? "auto-selected" : "--isa");
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
+  printf("Tolerance: %e\n", tolerance);
+  printf("Max sweeps: %d\n", max_sweeps);
+  printf("Warm-up time: %d ms (completed %d iterations)\n", warmup_time, warmup_count);
+  printf("Timing iterations: %d\n", iterations);
+  printf("Average execution time: %.3f ms\n", avg_time);
+  printf("Standard deviation: %.3f ms\n", std_dev);
+  if (validate) print_eigen_validation(validation);
+  printf("=====================================================\n\n");
+  print_environment();
+
+  if (telemetry) print_jacobi_telemetry(convergence);
+
+  // explore the tolerance / max-sweeps trade-off
+  if (pareto) {
+    std::vector<float> tolerances = log_grid(tol_min, tol_max, tol_steps);
+    std::vector<int> sweep_limits = {max_sweeps};
+    if (auto limits = program.present("--sweep-limits")) sweep_limits = parse_int_list(*limits);
+
+    auto run = [&](float trial_tolerance, int trial_sweeps, JacobiTrial *trial, float *values) {
+      float total = 0.0f;
+      for (int iter = 0; iter < iterations; ++iter) {
+        memcpy(hA_copy, hA, sizeof(float) * size_A);
+        auto start = std::chrono::high_resolution_clock::now();
+        ssyevj_batch(N, hA_copy, lda, strideA, trial_tolerance, hResidual, trial_sweeps, hNSweeps,
+                     hW, strideW, hInfo, batch_count);
+        auto stop = std::chrono::high_resolution_clock::now();
+        total += std::chrono::duration<float, std::milli>(stop - start).count();
+      }
+      trial->time_ms = total / iterations;
+      summarise_jacobi_convergence(hNSweeps, hResidual, hInfo, batch_count, trial);
+      memcpy(values, hW, sizeof(float) * size_W);
+    };
+
+    // reference eigenvalues at machine precision
+    float *hRef = (float*)malloc(sizeof(float) * size_W);
+    JacobiTrial reference = {};
+    int reference_sweeps = std::max(max_sweeps, 100);
+    for (int limit : sweep_limits) reference_sweeps = std::max(reference_sweeps, limit);
+    run(0.0f, reference_sweeps, &reference, hRef);
+
+    std::vector<JacobiTrial> trials = explore_jacobi_tradeoff(tolerances, sweep_limits, N, strideW,
+                                                              batch_count, hRef, run);
+    print_pareto_report("eigenvalue", trials);
+    free(hRef);
+  }
+
+  // clean up
+  trace_start = trace_begin();
+  free(hA);
+  free(hA_copy);
+  free(hW);
+  free(hResidual);
+  free(hNSweeps);
+  free(hInfo);
+  trace_end("teardown", "setup", trace_start);
+  trace_finish(trace_path.c_str());
+
+  return 0;
+}
@@ -11,6 +11,18 @@
 
 #include <argparse/argparse.hpp>
 
+#include "validate_host.hpp" // for post-run validation
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "trace.hpp" // for --trace timelines
+#include "tsc_timer.hpp" // for per-matrix timing
+#include "telemetry.hpp" // for the per-matrix report
+#include "omp_balance.hpp" // for --schedule and the load-balance report
+#include "energy.hpp" // for RAPL energy
+#include "flops.hpp" // for GFLOP/J and the roofline models
+#include "roofline.hpp" // for the roofline report
+#include "run_quality.hpp" // for the run-quality verdict
+#include "env_fingerprint.hpp" // for the environment of the results
+
 // Example: Compute the singular values and singular vectors of an array of general matrices on the CPU using OpenBLAS
 
 float *create_matrices(lapack_int M,
@@ -88,6 +100,68 @@ int main(int argc, char *argv[]) {
   program.add_argument("--right-svect")
       .help("Right singular vectors computation (none, singular, all)")
       .default_value(std::string("all"));
+      
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+      
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+      
+  program.add_argument("--validate")
+      .help("Validate the results once after timing")
+      .default_value(false)
+      .implicit_value(true);
+      
+  program.add_argument("--validate-threshold")
+      .help("Validation failure threshold in units of max(M,N) * machine epsilon")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--trace")
+      .help("Write a timeline of the run in Chrome trace format (chrome://tracing, Perfetto) to this file")
+      .default_value(std::string(""));
+
+  program.add_argument("--trace-capacity")
+      .help("Spans kept per thread for --trace; the oldest are overwritten first")
+      .default_value(65536)
+      .scan<'i', int>();
+
+  program.add_argument("--per-matrix")
+      .help("Time every matrix of the timed iterations and report the distribution")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--schedule")
+      .help("OpenMP schedule of the batch loop (static, dynamic, guided, auto; optionally ',chunk')")
+      .default_value(std::string("static"));
+
+  program.add_argument("--imbalance")
+      .help("Report per-thread busy and barrier wait time of the timed iterations")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--energy")
+      .help("Report package and DRAM energy of the timed iterations from the RAPL counters")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--roofline")
+      .help("Measure the machine's bandwidth and FMA peak after timing and report the percent of roofline")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--quality")
+      .help("Monitor preemption, CPU frequency, throttling and load during the timed iterations and report a verdict")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--rerun-noisy")
+      .help("Re-run up to this many noisy timed iterations instead of keeping them (implies --quality)")
+      .default_value(0)
+      .scan<'i', int>();
   
   // 引数の解析
   try {
@@ -108,8 +182,35 @@ int main(int argc, char *argv[]) {
   int warmup_time = program.get<int>("--warmup-time");
   std::string left_svect_str = program.get<std::string>("--left-svect");
   std::string right_svect_str = program.get<std::string>("--right-svect");
+  bool validate = program.get<bool>("--validate");
+  float validate_threshold = program.get<float>("--validate-threshold");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  std::string trace_path = program.get<std::string>("--trace");
+  int trace_capacity = program.get<int>("--trace-capacity");
+  bool per_matrix = program.get<bool>("--per-matrix");
+  std::string schedule_str = program.get<std::string>("--schedule");
+  bool imbalance = program.get<bool>("--imbalance");
+  bool energy = program.get<bool>("--energy");
+  bool roofline = program.get<bool>("--roofline");
+  int rerun_noisy = program.get<int>("--rerun-noisy");
+  bool quality = program.get<bool>("--quality") || rerun_noisy > 0;
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (!set_omp_schedule(schedule_str)) {
+    std::cerr << "Unknown schedule: " << schedule_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
 
   if (lda < M) lda = M;
+  if (!trace_path.empty()) trace_enable(trace_capacity);
   
   // ストライドの計算（指定されていない場合はlda * Nを使用）
   size_t strideA;
@@ -138,7 +239,16 @@ int main(int argc, char *argv[]) {
     jobvt = 'A'; // All N rows of V^T are returned in the array VT
   }
   
-  float *hA = create_matrices(M, N, lda, strideA, batch_count, random_seed);
+  int64_t trace_start = trace_begin();
+  float *hA;
+  if (spectrum == SpectrumKind::random) {
+    hA = create_matrices(M, N, lda, strideA, batch_count, random_seed);
+  } else {
+    hA = create_general_matrices_with_spectrum<float>(M, N, lda, strideA, batch_count, random_seed,
+                                                       spectrum, cond);
+  }
+  trace_end("generate", "setup", trace_start);
+  trace_start = trace_begin();
 
   // calculate the sizes of our arrays
   size_t size_A = strideA * (size_t)batch_count;   // elements in array for matrices
@@ -167,6 +277,7 @@ int main(int argc, char *argv[]) {
   // Determine workspace size for LAPACK
   // For simplicity, we'll use a large workspace
   lapack_int lwork = 5 * std::max(M, N);
+  trace_end("allocate", "setup", trace_start);
   
   // vector to store timing results
   std::vector<float> timings;
@@ -174,6 +285,7 @@ int main(int argc, char *argv[]) {
   // time-based warm-up phase
   printf("Performing warm-up for %d ms...\n", warmup_time);
 
+  int64_t trace_warmup = trace_begin();
   auto warmup_start = std::chrono::high_resolution_clock::now();
   auto warmup_current = warmup_start;
   float warmup_elapsed = 0.0f;
@@ -181,7 +293,9 @@ int main(int argc, char *argv[]) {
 
   while (warmup_elapsed < warmup_time || warmup_count == 0) {
     // Copy the original matrices for this warm-up iteration
+    trace_start = trace_begin();
     memcpy(hA_copy, hA, sizeof(float) * size_A);
+    trace_end("restore", "copy", trace_start);
     
     // Process each matrix in the batch
     #pragma omp parallel
@@ -189,7 +303,7 @@ int main(int argc, char *argv[]) {
       // Allocate thread-local workspace
       float *thread_work = (float*)malloc(sizeof(float) * lwork);
       
-      #pragma omp for
+      #pragma omp for schedule(runtime)
       for (lapack_int b = 0; b < batch_count; ++b) {
         float* A_batch = hA_copy + b * strideA;
         float* S_batch = hS + b * strideS;
@@ -212,10 +326,12 @@ int main(int argc, char *argv[]) {
         // - ldvt: leading dimension of vt
         // - work: thread-local workspace
         // - lwork: size of workspace
+        int64_t solve_start = trace_begin();
         lapack_int info = LAPACKE_sgesvd_work(LAPACK_COL_MAJOR, jobu, jobvt, 
                                              M, N, A_batch, lda, S_batch, 
                                              U_batch, ldu, VT_batch, ldvt, 
                                              thread_work, lwork);
+        trace_end("LAPACKE_sgesvd_work", "solve", solve_start, b);
       
         if (info != 0) {
           printf("LAPACKE_sgesvd failed for matrix %d with error %d\n", (int)b, (int)info);
@@ -233,14 +349,39 @@ int main(int argc, char *argv[]) {
     warmup_elapsed = std::chrono::duration<float, std::milli>(warmup_current - warmup_start).count();
   }
 
+  trace_end("warm-up", "phase", trace_warmup);
   printf("Completed %d warm-up iterations in %.2f ms\n", warmup_count, warmup_elapsed);
   
+  // per-matrix solve times of the timed iterations, in counter ticks
+  std::vector<uint64_t> matrix_ticks;
+  if (per_matrix) {
+    matrix_ticks.resize((size_t)iterations * batch_count);
+    tsc_calibrate();  // rate and timer overhead, before timing
+  }
+
+  // per-thread busy and barrier wait times of the timed iterations
+  TeamTimes team_times(omp_get_max_threads());
+  LoadBalance balance;
+
+  // package and DRAM energy of the timed iterations; nothing is reported if unreadable
+  EnergyMeter energy_meter;
+  if (energy) energy_open(&energy_meter);
+
+  // preemption, frequency and throttling of every timed iteration
+  RunQuality run_quality;
+  if (quality) quality_open(&run_quality, omp_get_max_threads());
+
   // run the computation multiple times for timing
   for (int iter = 0; iter < iterations; ++iter) {
     // Copy the original matrices for this iteration
+    trace_start = trace_begin();
     memcpy(hA_copy, hA, sizeof(float) * size_A);
+    trace_end("restore", "copy", trace_start, iter);
     
     // start timing
+    trace_start = trace_begin();
+    if (quality) quality_begin(&run_quality);
+    if (energy) energy_start(&energy_meter);
     auto start = std::chrono::high_resolution_clock::now();
     
     // Process each matrix in the batch
@@ -249,7 +390,8 @@ int main(int argc, char *argv[]) {
       // Allocate thread-local workspace
       float *thread_work = (float*)malloc(sizeof(float) * lwork);
       
-      #pragma omp for
+      double loop_start = omp_get_wtime();
+      #pragma omp for schedule(runtime) nowait
       for (lapack_int b = 0; b < batch_count; ++b) {
         float* A_batch = hA_copy + b * strideA;
         float* S_batch = hS + b * strideS;
@@ -257,26 +399,45 @@ int main(int argc, char *argv[]) {
         float* VT_batch = hVT + b * strideVT;
         
         // Compute SVD
+        int64_t solve_start = trace_begin();
+        uint64_t tsc_start = per_matrix ? tsc_begin() : 0;
         lapack_int info = LAPACKE_sgesvd_work(LAPACK_COL_MAJOR, jobu, jobvt, 
                                              M, N, A_batch, lda, S_batch, 
                                              U_batch, ldu, VT_batch, ldvt, 
                                              thread_work, lwork);
+        if (per_matrix) matrix_ticks[(size_t)iter * batch_count + b] = tsc_elapsed(tsc_start, tsc_end());
+        trace_end("LAPACKE_sgesvd_work", "solve", solve_start, b);
       
         //if (info != 0) {
         //  printf("LAPACKE_sgesvd failed for matrix %d with error %d\n", (int)b, (int)info);
         //}
       }
       
+      if (imbalance) team_times.loop_done(loop_start);
+      #pragma omp barrier
+      if (imbalance) team_times.barrier_done();
+
       // Free thread-local workspace
       free(thread_work);
     }
     
     // stop timing
     auto stop = std::chrono::high_resolution_clock::now();
+    if (energy) energy_stop(&energy_meter);
+    trace_end("iteration", "phase", trace_start, iter);
+
+    // drop a noisy iteration and run it again while the re-run budget lasts
+    if (quality && quality_end(&run_quality) && run_quality.reruns < rerun_noisy) {
+      run_quality.reruns++;
+      --iter;
+      continue;
+    }
     
     // calculate elapsed time
     float elapsed_time = std::chrono::duration<float, std::milli>(stop - start).count();
     timings.push_back(elapsed_time);
+    if (energy) energy_keep(&energy_meter);
+    if (imbalance) record_load_balance(&balance, team_times);
   }
   
   // calculate statistics
@@ -287,25 +448,81 @@ int main(int argc, char *argv[]) {
   float std_dev = 0.0f;
   for (float t : timings) std_dev += (t - avg_time) * (t - avg_time);
   std_dev = sqrt(std_dev / timings.size());
-  
+
+  // validate the results outside the timed region
+  SvdValidation validation = {};
+  if (validate) {
+    trace_start = trace_begin();
+    // Solve the pristine matrices once more, this time keeping info for every matrix
+    memcpy(hA_copy, hA, sizeof(float) * size_A);
+    lapack_int *hInfo = (lapack_int*)malloc(sizeof(lapack_int) * batch_count);
+
+    #pragma omp parallel
+    {
+      float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+      #pragma omp for
+      for (lapack_int b = 0; b < batch_count; ++b) {
+        hInfo[b] = LAPACKE_sgesvd_work(LAPACK_COL_MAJOR, jobu, jobvt,
+                                       M, N, hA_copy + b * strideA, lda, hS + b * strideS,
+                                       hU + b * strideU, ldu, hVT + b * strideVT, ldvt,
+                                       thread_work, lwork);
+      }
+
+      free(thread_work);
+    }
+
+    validation = validate_svd_host(M, N, hA, lda, strideA, hS, strideS,
+                                   (jobu == 'N') ? NULL : hU, ldu, strideU,
+                                   (jobvt == 'N') ? NULL : hVT, ldvt, strideVT,
+                                   count_info_failures(hInfo, batch_count), batch_count,
+                                   validate_threshold);
+    free(hInfo);
+    trace_end("validate", "phase", trace_start);
+  }
+
   // print timing results
   printf("\n===== Performance Results (CPU - OpenBLAS) =====\n");
   printf("Matrix size: %d x %d\n", (int)M, (int)N);
   printf("Batch count: %d\n", (int)batch_count);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
   printf("Left singular vectors: %s\n", left_svect_str.c_str());
   printf("Right singular vectors: %s\n", right_svect_str.c_str());
   printf("Warm-up time: %d ms (completed %d iterations)\n", warmup_time, warmup_count);
   printf("Timing iterations: %d\n", iterations);
+  printf("Schedule: %s\n", schedule_str.c_str());
   printf("Average execution time: %.3f ms\n", avg_time);
   printf("Standard deviation: %.3f ms\n", std_dev);
+  if (validate) print_svd_validation(validation);
   printf("==============================================\n\n");
+  print_environment();
+
+  if (per_matrix) {
+    std::vector<float> matrix_ms(matrix_ticks.size());
+    for (size_t i = 0; i < matrix_ticks.size(); ++i) matrix_ms[i] = tsc_to_ms(matrix_ticks[i]);
+    print_matrix_latency(matrix_ms, batch_count, iterations, random_seed);
+  }
+  if (imbalance) print_load_balance(balance, schedule_str);
+  if (energy) print_energy(energy_meter, batch_count, sgesvd_flops(M, N) * batch_count, avg_time);
+  if (roofline) {
+    print_roofline(roofline_calibrate(omp_get_max_threads()), omp_get_max_threads(),
+                   sgesvd_flops(M, N) * batch_count, sgesvd_bytes(M, N) * batch_count, avg_time);
+  }
+  if (quality) print_run_quality(&run_quality);
 
   // clean up
+  trace_start = trace_begin();
   free(hA);
   free(hA_copy);
   free(hS);
   free(hU);
   free(hVT);
+  trace_end("teardown", "setup", trace_start);
+  trace_finish(trace_path.c_str());
   
   return 0;
 }
@@ -11,6 +11,18 @@
 
 #include <argparse/argparse.hpp>
 
+#include "validate_host.hpp" // for post-run validation
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "trace.hpp" // for --trace timelines
+#include "tsc_timer.hpp" // for per-matrix timing
+#include "telemetry.hpp" // for the per-matrix report
+#include "omp_balance.hpp" // for --schedule and the load-balance report
+#include "energy.hpp" // for RAPL energy
+#include "flops.hpp" // for GFLOP/J and the roofline models
+#include "roofline.hpp" // for the roofline report
+#include "run_quality.hpp" // for the run-quality verdict
+#include "env_fingerprint.hpp" // for the environment of the results
+
 // Example: Compute the eigenvalues and eigenvectors of an array of symmetric matrices on the CPU using OpenBLAS
 // Using the divide-and-conquer method (ssyevd)
 
@@ -82,6 +94,68 @@ int main(int argc, char *argv[]) {
       .help("Warm-up time in milliseconds before timing")
       .default_value(1000)
       .scan<'i', int>();
+      
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+      
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+      
+  program.add_argument("--validate")
+      .help("Validate the results once after timing")
+      .default_value(false)
+      .implicit_value(true);
+      
+  program.add_argument("--validate-threshold")
+      .help("Validation failure threshold in units of N * machine epsilon")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--trace")
+      .help("Write a timeline of the run in Chrome trace format (chrome://tracing, Perfetto) to this file")
+      .default_value(std::string(""));
+
+  program.add_argument("--trace-capacity")
+      .help("Spans kept per thread for --trace; the oldest are overwritten first")
+      .default_value(65536)
+      .scan<'i', int>();
+
+  program.add_argument("--per-matrix")
+      .help("Time every matrix of the timed iterations and report the distribution")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--schedule")
+      .help("OpenMP schedule of the batch loop (static, dynamic, guided, auto; optionally ',chunk')")
+      .default_value(std::string("static"));
+
+  program.add_argument("--imbalance")
+      .help("Report per-thread busy and barrier wait time of the timed iterations")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--energy")
+      .help("Report package and DRAM energy of the timed iterations from the RAPL counters")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--roofline")
+      .help("Measure the machine's bandwidth and FMA peak after timing and report the percent of roofline")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--quality")
+      .help("Monitor preemption, CPU frequency, throttling and load during the timed iterations and report a verdict")
+      .default_value(false)
+      .implicit_value(true);
+
+  program.add_argument("--rerun-noisy")
+      .help("Re-run up to this many noisy timed iterations instead of keeping them (implies --quality)")
+      .default_value(0)
+      .scan<'i', int>();
   
   // 引数の解析
   try {
@@ -99,8 +173,35 @@ int main(int argc, char *argv[]) {
   int random_seed = program.get<int>("--random-seed");
   int iterations = program.get<int>("--iterations");
   int warmup_time = program.get<int>("--warmup-time");
+  bool validate = program.get<bool>("--validate");
+  float validate_threshold = program.get<float>("--validate-threshold");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  std::string trace_path = program.get<std::string>("--trace");
+  int trace_capacity = program.get<int>("--trace-capacity");
+  bool per_matrix = program.get<bool>("--per-matrix");
+  std::string schedule_str = program.get<std::string>("--schedule");
+  bool imbalance = program.get<bool>("--imbalance");
+  bool energy = program.get<bool>("--energy");
+  bool roofline = program.get<bool>("--roofline");
+  int rerun_noisy = program.get<int>("--rerun-noisy");
+  bool quality = program.get<bool>("--quality") || rerun_noisy > 0;
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (!set_omp_schedule(schedule_str)) {
+    std::cerr << "Unknown schedule: " << schedule_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
 
   if (lda < N) lda = N;
+  if (!trace_path.empty()) trace_enable(trace_capacity);
   
   // ストライドの計算（指定されていない場合はlda * Nを使用）
   size_t strideA;
@@ -110,7 +211,16 @@ int main(int argc, char *argv[]) {
     strideA = lda * N;
   }
   
-  float *hA = create_matrices(N, lda, strideA, batch_count, random_seed);
+  int64_t trace_start = trace_begin();
+  float *hA;
+  if (spectrum == SpectrumKind::random) {
+    hA = create_matrices(N, lda, strideA, batch_count, random_seed);
+  } else {
+    hA = create_symmetric_matrices_with_spectrum<float>(N, lda, strideA, batch_count, random_seed,
+                                                         spectrum, cond);
+  }
+  trace_end("generate", "setup", trace_start);
+  trace_start = trace_begin();
 
   // calculate the sizes of our arrays
   size_t size_A = strideA * (size_t)batch_count;   // elements in array for matrices
@@ -138,6 +248,7 @@ int main(int argc, char *argv[]) {
   // Get the optimal workspace sizes
   lwork = (lapack_int)work_query;
   liwork = iwork_query;
+  trace_end("allocate", "setup", trace_start);
   
   // vector to store timing results
   std::vector<float> timings;
@@ -145,6 +256,7 @@ int main(int argc, char *argv[]) {
   // time-based warm-up phase
   printf("Performing warm-up for %d ms...\n", warmup_time);
 
+  int64_t trace_warmup = trace_begin();
   auto warmup_start = std::chrono::high_resolution_clock::now();
   auto warmup_current = warmup_start;
   float warmup_elapsed = 0.0f;
@@ -152,7 +264,9 @@ int main(int argc, char *argv[]) {
 
   while (warmup_elapsed < warmup_time || warmup_count == 0) {
     // Copy the original matrices for this warm-up iteration
+    trace_start = trace_begin();
     memcpy(hA_copy, hA, sizeof(float) * size_A);
+    trace_end("restore", "copy", trace_start);
     
     // Process each matrix in the batch
     #pragma omp parallel
@@ -161,7 +275,7 @@ int main(int argc, char *argv[]) {
       float *thread_work = (float*)malloc(sizeof(float) * lwork);
       lapack_int *thread_iwork = (lapack_int*)malloc(sizeof(lapack_int) * liwork);
       
-      #pragma omp for
+      #pragma omp for schedule(runtime)
       for (lapack_int b = 0; b < batch_count; ++b) {
         float* A_batch = hA_copy + b * strideA;
         float* W_batch = hW + b * strideW;
@@ -179,10 +293,12 @@ int main(int argc, char *argv[]) {
         // - lwork: size of floating-point workspace
         // - iwork: integer workspace array
         // - liwork: size of integer workspace
+        int64_t solve_start = trace_begin();
         lapack_int info = LAPACKE_ssyevd_work(LAPACK_COL_MAJOR, 'V', 'U', 
                                              N, A_batch, lda, W_batch, 
                                              thread_work, lwork, 
                                              thread_iwork, liwork);
+        trace_end("LAPACKE_ssyevd_work", "solve", solve_start, b);
       
         if (info != 0) {
           printf("LAPACKE_ssyevd failed for matrix %d with error %d\n", (int)b, (int)info);
@@ -201,14 +317,39 @@ int main(int argc, char *argv[]) {
     warmup_elapsed = std::chrono::duration<float, std::milli>(warmup_current - warmup_start).count();
   }
 
+  trace_end("warm-up", "phase", trace_warmup);
   printf("Completed %d warm-up iterations in %.2f ms\n", warmup_count, warmup_elapsed);
   
+  // per-matrix solve times of the timed iterations, in counter ticks
+  std::vector<uint64_t> matrix_ticks;
+  if (per_matrix) {
+    matrix_ticks.resize((size_t)iterations * batch_count);
+    tsc_calibrate();  // rate and timer overhead, before timing
+  }
+
+  // per-thread busy and barrier wait times of the timed iterations
+  TeamTimes team_times(omp_get_max_threads());
+  LoadBalance balance;
+
+  // package and DRAM energy of the timed iterations; nothing is reported if unreadable
+  EnergyMeter energy_meter;
+  if (energy) energy_open(&energy_meter);
+
+  // preemption, frequency and throttling of every timed iteration
+  RunQuality run_quality;
+  if (quality) quality_open(&run_quality, omp_get_max_threads());
+
   // run the computation multiple times for timing
   for (int iter = 0; iter < iterations; ++iter) {
     // Copy the original matrices for this iteration
+    trace_start = trace_begin();
     memcpy(hA_copy, hA, sizeof(float) * size_A);
+    trace_end("restore", "copy", trace_start, iter);
     
     // start timing
+    trace_start = trace_begin();
+    if (quality) quality_begin(&run_quality);
+    if (energy) energy_start(&energy_meter);
     auto start = std::chrono::high_resolution_clock::now();
     
     // Process each matrix in the batch
@@ -218,22 +359,31 @@ int main(int argc, char *argv[]) {
       float *thread_work = (float*)malloc(sizeof(float) * lwork);
       lapack_int *thread_iwork = (lapack_int*)malloc(sizeof(lapack_int) * liwork);
       
-      #pragma omp for
+      double loop_start = omp_get_wtime();
+      #pragma omp for schedule(runtime) nowait
       for (lapack_int b = 0; b < batch_count; ++b) {
         float* A_batch = hA_copy + b * strideA;
         float* W_batch = hW + b * strideW;
         
         // Compute eigenvalues and eigenvectors using ssyevd_work variant with thread-local workspaces
+        int64_t solve_start = trace_begin();
+        uint64_t tsc_start = per_matrix ? tsc_begin() : 0;
         lapack_int info = LAPACKE_ssyevd_work(LAPACK_COL_MAJOR, 'V', 'U', 
                                              N, A_batch, lda, W_batch, 
                                              thread_work, lwork, 
                                              thread_iwork, liwork);
+        if (per_matrix) matrix_ticks[(size_t)iter * batch_count + b] = tsc_elapsed(tsc_start, tsc_end());
+        trace_end("LAPACKE_ssyevd_work", "solve", solve_start, b);
       
         //if (info != 0) {
         //  printf("LAPACKE_ssyevd failed for matrix %d with error %d\n", (int)b, (int)info);
         //}
       }
       
+      if (imbalance) team_times.loop_done(loop_start);
+      #pragma omp barrier
+      if (imbalance) team_times.barrier_done();
+
       // Free thread-local workspaces
       free(thread_work);
       free(thread_iwork);
@@ -241,10 +391,21 @@ int main(int argc, char *argv[]) {
     
     // stop timing
     auto stop = std::chrono::high_resolution_clock::now();
+    if (energy) energy_stop(&energy_meter);
+    trace_end("iteration", "phase", trace_start, iter);
+
+    // drop a noisy iteration and run it again while the re-run budget lasts
+    if (quality && quality_end(&run_quality) && run_quality.reruns < rerun_noisy) {
+      run_quality.reruns++;
+      --iter;
+      continue;
+    }
     
     // calculate elapsed time
     float elapsed_time = std::chrono::duration<float, std::milli>(stop - start).count();
     timings.push_back(elapsed_time);
+    if (energy) energy_keep(&energy_meter);
+    if (imbalance) record_load_balance(&balance, team_times);
   }
   
   // calculate statistics
@@ -255,22 +416,79 @@ int main(int argc, char *argv[]) {
   float std_dev = 0.0f;
   for (float t : timings) std_dev += (t - avg_time) * (t - avg_time);
   std_dev = sqrt(std_dev / timings.size());
-  
+
+  // validate the results outside the timed region
+  EigenValidation validation = {};
+  if (validate) {
+    trace_start = trace_begin();
+    // Solve the pristine matrices once more, this time keeping info for every matrix
+    memcpy(hA_copy, hA, sizeof(float) * size_A);
+    lapack_int *hInfo = (lapack_int*)malloc(sizeof(lapack_int) * batch_count);
+
+    #pragma omp parallel
+    {
+      float *thread_work = (float*)malloc(sizeof(float) * lwork);
+      lapack_int *thread_iwork = (lapack_int*)malloc(sizeof(lapack_int) * liwork);
+
+      #pragma omp for
+      for (lapack_int b = 0; b < batch_count; ++b) {
+        hInfo[b] = LAPACKE_ssyevd_work(LAPACK_COL_MAJOR, 'V', 'U',
+                                       N, hA_copy + b * strideA, lda, hW + b * strideW,
+                                       thread_work, lwork,
+                                       thread_iwork, liwork);
+      }
+
+      free(thread_work);
+      free(thread_iwork);
+    }
+
+    // hA_copy now holds the eigenvectors
+    validation = validate_eigen_host(N, hA, lda, strideA, hA_copy, lda, strideA, hW, strideW,
+                                     count_info_failures(hInfo, batch_count), batch_count,
+                                     validate_threshold);
+    free(hInfo);
+    trace_end("validate", "phase", trace_start);
+  }
+
   // print timing results
   printf("\n===== Performance Results (CPU - OpenBLAS) =====\n");
   printf("Algorithm: Divide-and-Conquer (ssyevd)\n");
   printf("Matrix size: %d x %d\n", (int)N, (int)N);
   printf("Batch count: %d\n", (int)batch_count);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
   printf("Warm-up time: %d ms (completed %d iterations)\n", warmup_time, warmup_count);
   printf("Timing iterations: %d\n", iterations);
+  printf("Schedule: %s\n", schedule_str.c_str());
   printf("Average execution time: %.3f ms\n", avg_time);
   printf("Standard deviation: %.3f ms\n", std_dev);
+  if (validate) print_eigen_validation(validation);
   printf("==============================================\n\n");
+  print_environment();
+
+  if (per_matrix) {
+    std::vector<float> matrix_ms(matrix_ticks.size());
+    for (size_t i = 0; i < matrix_ticks.size(); ++i) matrix_ms[i] = tsc_to_ms(matrix_ticks[i]);
+    print_matrix_latency(matrix_ms, batch_count, iterations, random_seed);
+  }
+  if (imbalance) print_load_balance(balance, schedule_str);
+  if (energy) print_energy(energy_meter, batch_count, ssyevd_flops(N) * batch_count, avg_time);
+  if (roofline) {
+    print_roofline(roofline_calibrate(omp_get_max_threads()), omp_get_max_threads(),
+                   ssyevd_flops(N) * batch_count, ssyevd_bytes(N) * batch_count, avg_time);
+  }
+  if (quality) print_run_quality(&run_quality);
 
   // clean up
+  trace_start = trace_begin();
   free(hA);
   free(hA_copy);
   free(hW);
+  trace_end("teardown", "setup", trace_start);
+  trace_finish(trace_path.c_str());
   
   return 0;
 }
@@ -0,0 +1,503 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for chunks and stage threads
+#include <cmath> // for sqrt in standard deviation calculation
+#include <iostream> // for cout/cerr
+#include <chrono> // for high-resolution timing
+#include <thread> // for the stage threads
+#include <cstring> // for memcpy
+#include <omp.h> // for per-stage OpenMP team sizes
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the batched OpenBLAS paths
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "mpmc_queue.hpp" // for the bounded stage queues
+#include "pareto.hpp" // for parse_int_list
+#include "validate_host.hpp" // for validate_eigen_host / validate_svd_host
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Overlap generate -> restore -> solve -> validate on a stream of chunks.
+//
+// The batch is processed in chunks. In the sequential mode every chunk goes through the four
+// phases one after the other, each phase using every thread. In the pipelined mode each phase
+// is a stage with its own thread and OpenMP team; the stages hand chunks on through bounded
+// queues, so chunk k+1 is generated while chunk k is solved and chunk k-1 is validated.
+// A fixed number of chunk buffers circulates, which bounds the memory in flight.
+
+enum Stage { STAGE_GENERATE, STAGE_RESTORE, STAGE_SOLVE, STAGE_VALIDATE, STAGE_COUNT };
+
+const char *stage_names[STAGE_COUNT] = {"generate", "restore", "solve", "validate"};
+
+// One chunk of the stream and its buffers.
+struct Chunk {
+  int index;
+  float *pristine;
+  float *A;      // restored copy, overwritten by the solver
+  float *W;
+  float *U;
+  float *VT;
+  lapack_int *info;
+};
+
+// What every stage needs to process a chunk.
+struct PipelineSetup {
+  CpuSolverLayout layout;
+  int chunk_size;
+  int random_seed;
+  SpectrumKind spectrum;
+  float cond;
+  float validate_threshold;
+};
+
+// Validation summed over the chunks.
+struct PipelineValidation {
+  ValidationMetric metrics[3];
+  int metric_count;
+  int info_failures;
+  int batch_count;
+};
+
+Chunk *allocate_chunk(const PipelineSetup &setup) {
+  const CpuSolverLayout &layout = setup.layout;
+  int count = setup.chunk_size;
+  Chunk *chunk = (Chunk*)malloc(sizeof(Chunk));
+  chunk->index = -1;
+  chunk->pristine = (float*)malloc(sizeof(float) * layout.strideA * count);
+  chunk->A = (float*)malloc(sizeof(float) * layout.strideA * count);
+  chunk->W = (float*)malloc(sizeof(float) * layout.strideW * count);
+  chunk->U = (layout.strideU > 0) ? (float*)malloc(sizeof(float) * layout.strideU * count) : NULL;
+  chunk->VT = (layout.strideVT > 0) ? (float*)malloc(sizeof(float) * layout.strideVT * count) : NULL;
+  chunk->info = (lapack_int*)malloc(sizeof(lapack_int) * count);
+  return chunk;
+}
+
+void free_chunk(Chunk *chunk) {
+  free(chunk->pristine);
+  free(chunk->A);
+  free(chunk->W);
+  free(chunk->U);
+  free(chunk->VT);
+  free(chunk->info);
+  free(chunk);
+}
+
+void merge_validation_metric(ValidationMetric *total, const ValidationMetric &part, int offset) {
+  if (!part.enabled) {
+    total->enabled = false;
+    return;
+  }
+  if (part.max_index >= 0 && (total->max_index < 0 || part.max_error > total->max_error)) {
+    total->max_error = part.max_error;
+    total->max_index = offset + part.max_index;
+  }
+  total->sum_error += part.sum_error;
+  total->count += part.count;
+  total->failures += part.failures;
+}
+
+void reset_pipeline_validation(PipelineValidation *v, const PipelineSetup &setup) {
+  const CpuSolverLayout &layout = setup.layout;
+  double factor = setup.validate_threshold;
+  if (layout.solver == CpuSolver::sgesvd) {
+    int max_mn = (layout.M > layout.N) ? layout.M : layout.N;
+    int k = (layout.M < layout.N) ? layout.M : layout.N;
+    v->metrics[0] = make_validation_metric("||A - USV'|| / ||A||", validation_threshold(factor, max_mn));
+    v->metrics[1] = make_validation_metric("||U'U - I||", validation_threshold(factor, k));
+    v->metrics[2] = make_validation_metric("||V'V - I||", validation_threshold(factor, k));
+    v->metric_count = 3;
+  } else {
+    v->metrics[0] = make_validation_metric("||AV - VL|| / ||A||", validation_threshold(factor, layout.N));
+    v->metrics[1] = make_validation_metric("||V'V - I||", validation_threshold(factor, layout.N));
+    v->metric_count = 2;
+  }
+  v->info_failures = 0;
+  v->batch_count = 0;
+}
+
+// Run one stage on one chunk. Only the validate stage touches the shared validation summary,
+// and only one thread runs it.
+void run_stage(Stage stage, Chunk *chunk, const PipelineSetup &setup, PipelineValidation *validation) {
+  const CpuSolverLayout &layout = setup.layout;
+  int count = setup.chunk_size;
+  size_t size_A = layout.strideA * count;
+
+  switch (stage) {
+    case STAGE_GENERATE: {
+      // every chunk has its own seed, so both modes see the same matrices
+      int seed = setup.random_seed + chunk->index;
+      float *hA;
+      if (layout.solver == CpuSolver::sgesvd) {
+        if (setup.spectrum == SpectrumKind::random) {
+          hA = create_general_matrices(layout.M, layout.N, layout.lda, layout.strideA, count, seed);
+        } else {
+          hA = create_general_matrices_with_spectrum<float>(layout.M, layout.N, layout.lda, layout.strideA,
+                                                             count, seed, setup.spectrum, setup.cond);
+        }
+      } else {
+        if (setup.spectrum == SpectrumKind::random) {
+          hA = create_symmetric_matrices(layout.N, layout.lda, layout.strideA, count, seed);
+        } else {
+          hA = create_symmetric_matrices_with_spectrum<float>(layout.N, layout.lda, layout.strideA,
+                                                               count, seed, setup.spectrum, setup.cond);
+        }
+      }
+      memcpy(chunk->pristine, hA, sizeof(float) * size_A);
+      free(hA);
+      break;
+    }
+    case STAGE_RESTORE:
+      #pragma omp parallel for
+      for (int b = 0; b < count; ++b) {
+        memcpy(chunk->A + b * layout.strideA, chunk->pristine + b * layout.strideA,
+               sizeof(float) * layout.strideA);
+      }
+      break;
+    case STAGE_SOLVE:
+      cpu_solver_batched(layout, chunk->A, chunk->W, chunk->U, chunk->VT, chunk->info, count);
+      break;
+    case STAGE_VALIDATE: {
+      int info_failures = count_info_failures(chunk->info, count);
+      int offset = chunk->index * count;
+      if (layout.solver == CpuSolver::sgesvd) {
+        SvdValidation result = validate_svd_host(layout.M, layout.N, chunk->pristine, layout.lda, layout.strideA,
+                                                 chunk->W, layout.strideW,
+                                                 chunk->U, layout.ldu, layout.strideU,
+                                                 chunk->VT, layout.ldvt, layout.strideVT,
+                                                 info_failures, count, setup.validate_threshold);
+        merge_validation_metric(&validation->metrics[0], result.reconstruction, offset);
+        merge_validation_metric(&validation->metrics[1], result.left_orthogonality, offset);
+        merge_validation_metric(&validation->metrics[2], result.right_orthogonality, offset);
+      } else {
+        // A now holds the eigenvectors
+        EigenValidation result = validate_eigen_host(layout.N, chunk->pristine, layout.lda, layout.strideA,
+                                                     chunk->A, layout.lda, layout.strideA,
+                                                     chunk->W, layout.strideW,
+                                                     info_failures, count, setup.validate_threshold);
+        merge_validation_metric(&validation->metrics[0], result.residual, offset);
+        merge_validation_metric(&validation->metrics[1], result.orthogonality, offset);
+      }
+      validation->info_failures += info_failures;
+      validation->batch_count += count;
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+struct PipelineRun {
+  double elapsed_ms;
+  double busy_ms[STAGE_COUNT];  // time each stage spent processing chunks
+};
+
+double elapsed_ms_since(std::chrono::high_resolution_clock::time_point start) {
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+  return elapsed.count();
+}
+
+// Every chunk through every phase in turn, each phase using all threads.
+PipelineRun run_sequential(const PipelineSetup &setup, int chunk_count, Chunk *chunk,
+                           PipelineValidation *validation) {
+  PipelineRun run = {};
+  reset_pipeline_validation(validation, setup);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int k = 0; k < chunk_count; ++k) {
+    chunk->index = k;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+      auto stage_start = std::chrono::high_resolution_clock::now();
+      run_stage((Stage)s, chunk, setup, validation);
+      run.busy_ms[s] += elapsed_ms_since(stage_start);
+    }
+  }
+  run.elapsed_ms = elapsed_ms_since(start);
+  return run;
+}
+
+// One thread per stage with its own OpenMP team; chunks flow from a free list through the
+// stage queues and back. NULL marks the end of the stream.
+PipelineRun run_pipelined(const PipelineSetup &setup, int chunk_count, std::vector<Chunk*> &chunks,
+                          const std::vector<int> &stage_threads, PipelineValidation *validation) {
+  PipelineRun run = {};
+  reset_pipeline_validation(validation, setup);
+
+  size_t capacity = chunks.size() + 1;
+  MutexQueue<Chunk*> free_chunks(capacity);
+  std::vector<MutexQueue<Chunk*>*> inputs;
+  for (int s = 0; s < STAGE_COUNT; ++s) inputs.push_back(new MutexQueue<Chunk*>(capacity));
+  for (Chunk *chunk : chunks) free_chunks.push(chunk);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  std::vector<std::thread> threads;
+  for (int s = 0; s < STAGE_COUNT; ++s) {
+    threads.emplace_back([&, s]() {
+      omp_set_num_threads(stage_threads[s]);
+      double busy = 0.0;
+      for (int k = 0; ; ++k) {
+        Chunk *chunk;
+        if (s == STAGE_GENERATE) {
+          if (k == chunk_count) break;
+          free_chunks.pop(chunk);
+          chunk->index = k;
+        } else {
+          inputs[s]->pop(chunk);
+          if (chunk == NULL) break;
+        }
+
+        auto stage_start = std::chrono::high_resolution_clock::now();
+        run_stage((Stage)s, chunk, setup, validation);
+        busy += elapsed_ms_since(stage_start);
+
+        if (s + 1 < STAGE_COUNT) inputs[s + 1]->push(chunk);
+        else free_chunks.push(chunk);
+      }
+      if (s + 1 < STAGE_COUNT) inputs[s + 1]->push(NULL);
+      run.busy_ms[s] = busy;
+    });
+  }
+  for (std::thread &t : threads) t.join();
+  run.elapsed_ms = elapsed_ms_since(start);
+
+  for (MutexQueue<Chunk*> *queue : inputs) delete queue;
+  return run;
+}
+
+// Whether a stage runs on one thread whatever its team size: the legacy random generator is
+// sequential (one generator for the whole chunk).
+bool stage_is_serial(Stage stage, const PipelineSetup &setup) {
+  return stage == STAGE_GENERATE && setup.spectrum == SpectrumKind::random;
+}
+
+// Split the threads across the stages in proportion to their share of the sequential time,
+// at least one each. Serial stages get exactly one, whatever their share.
+std::vector<int> balance_stage_threads(const PipelineRun &sequential, const PipelineSetup &setup, int threads) {
+  std::vector<int> result(STAGE_COUNT, 1);
+  int spare = threads - STAGE_COUNT;
+  if (spare <= 0) return result;
+
+  double total = 0.0;
+  for (int s = 0; s < STAGE_COUNT; ++s) {
+    if (!stage_is_serial((Stage)s, setup)) total += sequential.busy_ms[s];
+  }
+  if (total <= 0.0) return result;
+
+  std::vector<double> remainder(STAGE_COUNT, -1.0);
+  int given = 0;
+  for (int s = 0; s < STAGE_COUNT; ++s) {
+    if (stage_is_serial((Stage)s, setup)) continue;
+    double share = spare * sequential.busy_ms[s] / total;
+    result[s] += (int)share;
+    given += (int)share;
+    remainder[s] = share - (int)share;
+  }
+  // hand out what rounding left over, largest remainder first
+  for (; given < spare; ++given) {
+    int best = -1;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+      if (remainder[s] >= 0.0 && (best < 0 || remainder[s] > remainder[best])) best = s;
+    }
+    if (best < 0) break;
+    result[best]++;
+    remainder[best] = -1.0;
+  }
+  return result;
+}
+
+void statistics(const std::vector<double> &timings, double *avg, double *std_dev) {
+  *avg = 0.0;
+  for (double t : timings) *avg += t;
+  *avg /= timings.size();
+  *std_dev = 0.0;
+  for (double t : timings) *std_dev += (t - *avg) * (t - *avg);
+  *std_dev = sqrt(*std_dev / timings.size());
+}
+
+void print_pipeline_validation(const PipelineValidation &v) {
+  printf("Validation:\n");
+  printf("  %-22s %d/%d\n", "info != 0", v.info_failures, v.batch_count);
+  for (int i = 0; i < v.metric_count; ++i) print_validation_metric(v.metrics[i]);
+}
+
+// Compare sequential phases with the overlapped pipeline on the same stream of chunks.
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_pipeline");
+
+  program.add_argument("--solver")
+      .help("Solver path (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyevd"));
+
+  program.add_argument("-m", "--rows")
+      .help("Number of rows (M, sgesvd only)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N, or number of columns for sgesvd)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-b", "--chunk-size")
+      .help("Matrices per chunk")
+      .default_value(256)
+      .scan<'i', int>();
+
+  program.add_argument("-c", "--chunks")
+      .help("Number of chunks in the stream")
+      .default_value(32)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation (chunk k uses seed + k)")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of runs of each mode")
+      .default_value(3)
+      .scan<'i', int>();
+
+  program.add_argument("--depth")
+      .help("Chunk buffers in flight in the pipeline (at least one per stage)")
+      .default_value(8)
+      .scan<'i', int>();
+
+  program.add_argument("--stage-threads")
+      .help("Comma-separated OpenMP threads for generate,restore,solve,validate "
+            "(default: split by the sequential phase times)")
+      .default_value(std::string(""));
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--validate-threshold")
+      .help("Validation failure threshold in units of N * machine epsilon")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str = program.get<std::string>("--solver");
+  int M = program.get<int>("--rows");
+  int N = program.get<int>("--size");
+  int chunk_size = program.get<int>("--chunk-size");
+  int chunk_count = program.get<int>("--chunks");
+  int random_seed = program.get<int>("--random-seed");
+  int iterations = program.get<int>("--iterations");
+  int depth = program.get<int>("--depth");
+  std::vector<int> stage_threads = parse_int_list(program.get<std::string>("--stage-threads"));
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  float validate_threshold = program.get<float>("--validate-threshold");
+
+  PipelineSetup setup;
+  if (!parse_cpu_solver(solver_str, &setup.layout.solver)) {
+    std::cerr << "Unknown solver: " << solver_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+  if (!parse_spectrum_kind(spectrum_str, &setup.spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+  if (!stage_threads.empty() && stage_threads.size() != STAGE_COUNT) {
+    std::cerr << "--stage-threads needs one count per stage (generate,restore,solve,validate)" << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (chunk_size < 1) chunk_size = 1;
+  if (chunk_count < 1) chunk_count = 1;
+  if (iterations < 1) iterations = 1;
+  if (depth < STAGE_COUNT) depth = STAGE_COUNT;
+  for (int &t : stage_threads) t = (t < 1) ? 1 : t;
+
+  setup.layout = make_cpu_solver_layout(setup.layout.solver, M, N, M);
+  setup.chunk_size = chunk_size;
+  setup.random_seed = random_seed;
+  setup.cond = cond;
+  setup.validate_threshold = validate_threshold;
+  M = setup.layout.M;
+
+  int max_threads = omp_get_max_threads();
+  std::vector<Chunk*> chunks;
+  for (int d = 0; d < depth; ++d) chunks.push_back(allocate_chunk(setup));
+
+  // Warm-up: one chunk through every phase
+  PipelineValidation validation;
+  run_sequential(setup, 1, chunks[0], &validation);
+
+  std::vector<double> sequential_timings, pipelined_timings;
+  PipelineRun sequential = {}, pipelined = {};
+  PipelineValidation sequential_validation, pipelined_validation;
+  bool balanced = stage_threads.empty();
+  for (int iter = 0; iter < iterations; ++iter) {
+    PipelineRun run = run_sequential(setup, chunk_count, chunks[0], &sequential_validation);
+    sequential_timings.push_back(run.elapsed_ms);
+    for (int s = 0; s < STAGE_COUNT; ++s) sequential.busy_ms[s] += run.busy_ms[s] / iterations;
+
+    if (balanced) stage_threads = balance_stage_threads(run, setup, max_threads);
+    run = run_pipelined(setup, chunk_count, chunks, stage_threads, &pipelined_validation);
+    pipelined_timings.push_back(run.elapsed_ms);
+    for (int s = 0; s < STAGE_COUNT; ++s) pipelined.busy_ms[s] += run.busy_ms[s] / iterations;
+  }
+
+  double sequential_avg, sequential_std, pipelined_avg, pipelined_std;
+  statistics(sequential_timings, &sequential_avg, &sequential_std);
+  statistics(pipelined_timings, &pipelined_avg, &pipelined_std);
+  int total_matrices = chunk_size * chunk_count;
+
+  // print timing results
+  printf("\n===== Performance Results (CPU - pipelined phases) =====\n");
+  printf("Solver: %s\n", cpu_solver_name(setup.layout.solver));
+  if (setup.layout.solver == CpuSolver::sgesvd) printf("Matrix size: %d x %d\n", M, N);
+  else printf("Matrix size: %d x %d\n", N, N);
+  printf("Chunks: %d x %d matrices\n", chunk_count, chunk_size);
+  if (setup.spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(setup.spectrum), cond);
+  }
+  printf("Threads: %d, chunk buffers in flight: %d\n", max_threads, depth);
+  printf("Iterations: %d\n", iterations);
+
+  printf("Stages (average per run):\n");
+  printf("  %-10s %12s %10s %9s %12s %12s\n",
+         "stage", "seq (ms)", "seq share", "threads", "pipe (ms)", "utilisation");
+  for (int s = 0; s < STAGE_COUNT; ++s) {
+    printf("  %-10s %12.3f %9.1f%% %9d %12.3f %11.1f%%\n", stage_names[s],
+           sequential.busy_ms[s], 100.0 * sequential.busy_ms[s] / sequential_avg,
+           stage_threads[s], pipelined.busy_ms[s], 100.0 * pipelined.busy_ms[s] / pipelined_avg);
+  }
+  if (balanced) printf("  (threads split by the sequential phase times)\n");
+
+  printf("End to end:\n");
+  printf("  %-10s %12.3f ms +- %8.3f ms, %12.1f matrices/s\n", "sequential",
+         sequential_avg, sequential_std, total_matrices / (sequential_avg / 1000.0));
+  printf("  %-10s %12.3f ms +- %8.3f ms, %12.1f matrices/s\n", "pipelined",
+         pipelined_avg, pipelined_std, total_matrices / (pipelined_avg / 1000.0));
+  printf("  Speedup: %.2fx\n", (pipelined_avg > 0.0) ? sequential_avg / pipelined_avg : 0.0);
+
+  print_pipeline_validation(pipelined_validation);
+  printf("=========================================================\n\n");
+  print_environment();
+
+  // clean up
+  for (Chunk *chunk : chunks) free_chunk(chunk);
+}
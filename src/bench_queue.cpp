@@ -0,0 +1,175 @@
+#include <stdio.h>   // for printf
+#include <vector> // for thread lists and timing results
+#include <cmath> // for sqrt in standard deviation calculation
+#include <iostream> // for cout/cerr
+#include <chrono> // for high-resolution timing
+#include <thread> // for producer and consumer threads
+#include <atomic> // for the start flag and the checksum
+
+#include <argparse/argparse.hpp>
+
+#include "mpmc_queue.hpp" // for the queues under test
+#include "pareto.hpp" // for parse_int_list
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Throughput of the submission queues under contention.
+//
+// P producers push items 0..items-1 between them and C consumers pop them until each receives
+// a stop item (-1), so the same number of items crosses the queue in every configuration.
+// Every item is checked off through a checksum.
+
+struct QueueRun {
+  double mops;   // million items per second
+  bool valid;    // every item popped exactly once
+};
+
+template <typename Queue>
+QueueRun run_queue(int producers, int consumers, long items, size_t capacity) {
+  Queue queue(capacity);
+  std::atomic<int> ready{0};
+  std::atomic<bool> go{false};
+  std::atomic<long> checksum{0};
+  std::atomic<long> popped{0};
+
+  std::vector<std::thread> producer_threads, consumer_threads;
+  for (int p = 0; p < producers; ++p) {
+    producer_threads.emplace_back([&, p]() {
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      for (long i = p; i < items; i += producers) queue.push(i);
+    });
+  }
+  for (int c = 0; c < consumers; ++c) {
+    consumer_threads.emplace_back([&]() {
+      long sum = 0, count = 0, item;
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      for (;;) {
+        queue.pop(item);
+        if (item < 0) break;
+        sum += item;
+        count++;
+      }
+      checksum.fetch_add(sum);
+      popped.fetch_add(count);
+    });
+  }
+
+  // start everybody at once
+  while (ready.load() < producers + consumers) std::this_thread::yield();
+  auto start = std::chrono::high_resolution_clock::now();
+  go.store(true, std::memory_order_release);
+
+  for (std::thread &t : producer_threads) t.join();
+  for (int c = 0; c < consumers; ++c) queue.push(-1);
+  for (std::thread &t : consumer_threads) t.join();
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  double elapsed_s = std::chrono::duration<double>(stop - start).count();
+
+  QueueRun run;
+  run.mops = (elapsed_s > 0.0) ? items / elapsed_s / 1e6 : 0.0;
+  run.valid = popped.load() == items && checksum.load() == items * (items - 1) / 2;
+  return run;
+}
+
+// Average and standard deviation of the throughput over the iterations.
+template <typename Queue>
+void measure_queue(int producers, int consumers, long items, size_t capacity, int iterations,
+                   double *avg, double *std_dev, bool *valid) {
+  std::vector<double> results;
+  *valid = true;
+  for (int iter = 0; iter < iterations; ++iter) {
+    QueueRun run = run_queue<Queue>(producers, consumers, items, capacity);
+    results.push_back(run.mops);
+    *valid = *valid && run.valid;
+  }
+
+  *avg = 0.0;
+  for (double r : results) *avg += r;
+  *avg /= results.size();
+
+  *std_dev = 0.0;
+  for (double r : results) *std_dev += (r - *avg) * (r - *avg);
+  *std_dev = sqrt(*std_dev / results.size());
+}
+
+// Compare the lock-free ring queue with the mutex + condvar queue at several producer/consumer counts.
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_queue");
+
+  program.add_argument("-p", "--producers")
+      .help("Comma-separated producer thread counts")
+      .default_value(std::string("1,2,4,8,16,32"));
+
+  program.add_argument("-c", "--consumers")
+      .help("Comma-separated consumer thread counts")
+      .default_value(std::string("1,4"));
+
+  program.add_argument("--items")
+      .help("Items pushed through the queue per measurement")
+      .default_value(1000000)
+      .scan<'i', int>();
+
+  program.add_argument("--capacity")
+      .help("Queue capacity (rounded up to a power of two for the lock-free ring)")
+      .default_value(1024)
+      .scan<'i', int>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of measurements per configuration")
+      .default_value(5)
+      .scan<'i', int>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::vector<int> producer_counts = parse_int_list(program.get<std::string>("--producers"));
+  std::vector<int> consumer_counts = parse_int_list(program.get<std::string>("--consumers"));
+  long items = program.get<int>("--items");
+  int capacity = program.get<int>("--capacity");
+  int iterations = program.get<int>("--iterations");
+
+  if (iterations < 1) iterations = 1;
+  if (capacity < 1) capacity = 1;
+
+  // print results as they are measured
+  printf("\n===== Queue Throughput (million items/s) =====\n");
+  printf("Items per measurement: %ld\n", items);
+  printf("Capacity: %d\n", capacity);
+  printf("Iterations: %d\n", iterations);
+  printf("Hardware threads: %u\n", std::thread::hardware_concurrency());
+  printf("  %9s %9s %18s %18s %8s\n", "producers", "consumers", "mutex+condvar", "lock-free ring", "speedup");
+
+  bool all_valid = true;
+  for (int consumers : consumer_counts) {
+    for (int producers : producer_counts) {
+      if (producers < 1 || consumers < 1) continue;
+      double mutex_avg, mutex_std, ring_avg, ring_std;
+      bool mutex_valid, ring_valid;
+      measure_queue<MutexQueue<long>>(producers, consumers, items, capacity, iterations,
+                                      &mutex_avg, &mutex_std, &mutex_valid);
+      measure_queue<MpmcRingQueue<long>>(producers, consumers, items, capacity, iterations,
+                                         &ring_avg, &ring_std, &ring_valid);
+      all_valid = all_valid && mutex_valid && ring_valid;
+
+      printf("  %9d %9d %9.2f +- %5.2f %9.2f +- %5.2f %7.2fx%s\n",
+             producers, consumers, mutex_avg, mutex_std, ring_avg, ring_std,
+             (mutex_avg > 0.0) ? ring_avg / mutex_avg : 0.0,
+             (mutex_valid && ring_valid) ? "" : "  (items lost or duplicated)");
+      fflush(stdout);
+    }
+  }
+  printf("==============================================\n\n");
+  print_environment();
+
+  return all_valid ? 0 : 1;
+}
@@ -9,6 +9,8 @@
 
 #include <argparse/argparse.hpp>
 
+#include "env_fingerprint.hpp" // for the environment of the results
+
 // Example: Compute the QR Factorizations of a batch of matrices on the GPU
 
 double **create_matrices_for_dgeqrf_batched(rocblas_int M,
@@ -201,6 +203,7 @@ int main(int argc, char *argv[]) {
   printf("Average execution time: %.3f ms\n", avg_time);
   printf("Standard deviation: %.3f ms\n", std_dev);
   printf("==============================\n\n");
+  print_environment();
 
   // clean up
   for (rocblas_int b = 0; b < batch_count; ++b)
@@ -9,6 +9,8 @@
 
 #include <argparse/argparse.hpp>
 
+#include "env_fingerprint.hpp" // for the environment of the results
+
 // Example: Compute the QR Factorizations of an array of matrices on the GPU
 
 double *create_matrices_for_dgeqrf_strided_batched(rocblas_int M,
@@ -202,6 +204,7 @@ int main(int argc, char *argv[]) {
   printf("Average execution time: %.3f ms\n", avg_time);
   printf("Standard deviation: %.3f ms\n", std_dev);
   printf("==============================\n\n");
+  print_environment();
 
   // clean up
   hipFree(dA);
@@ -6,9 +6,17 @@
 #include <vector> // for storing timing results
 #include <cmath> // for sqrt in standard deviation calculation
 #include <iostream> // for cout/cerr
+#include <algorithm> // for std::max
 
 #include <argparse/argparse.hpp>
 
+#include "validate.hpp" // for post-run validation
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "trace.hpp" // for --trace timelines
+#include "pareto.hpp" // for the tolerance / max-sweeps exploration
+#include "telemetry.hpp" // for per-matrix convergence telemetry
+#include "env_fingerprint.hpp" // for the environment of the results
+
 // Example: Compute the singular values and singular vectors of an array of general matrices on the GPU
 
 float *create_matrices_for_sgesvdj_strided_batched(rocblas_int M,
@@ -96,6 +104,62 @@ int main(int argc, char *argv[]) {
   program.add_argument("--right-svect")
       .help("Right singular vectors computation (none, singular, all)")
       .default_value(std::string("all"));
+      
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+      
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+      
+  program.add_argument("--validate")
+      .help("Validate the results once after timing")
+      .default_value(false)
+      .implicit_value(true);
+      
+  program.add_argument("--validate-threshold")
+      .help("Validation failure threshold in units of max(M,N) * machine epsilon")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--trace")
+      .help("Write a timeline of the run in Chrome trace format (chrome://tracing, Perfetto) to this file")
+      .default_value(std::string(""));
+
+  program.add_argument("--trace-capacity")
+      .help("Spans kept per thread for --trace; the oldest are overwritten first")
+      .default_value(65536)
+      .scan<'i', int>();
+      
+  program.add_argument("--pareto")
+      .help("Explore the tolerance / max-sweeps trade-off after the timed run")
+      .default_value(false)
+      .implicit_value(true);
+      
+  program.add_argument("--tol-min")
+      .help("Smallest tolerance of the --pareto log grid")
+      .default_value(1e-8f)
+      .scan<'f', float>();
+      
+  program.add_argument("--tol-max")
+      .help("Largest tolerance of the --pareto log grid")
+      .default_value(1e-1f)
+      .scan<'f', float>();
+      
+  program.add_argument("--tol-steps")
+      .help("Number of tolerances on the --pareto log grid")
+      .default_value(8)
+      .scan<'i', int>();
+      
+  program.add_argument("--sweep-limits")
+      .help("Comma-separated max-sweeps values for --pareto (default: --max-sweeps)");
+      
+  program.add_argument("--telemetry")
+      .help("Report per-matrix convergence (sweeps, residual, info) of the timed iterations")
+      .default_value(false)
+      .implicit_value(true);
   
   // 引数の解析
   try {
@@ -118,8 +182,27 @@ int main(int argc, char *argv[]) {
   rocblas_int max_sweeps = program.get<int>("--max-sweeps");
   std::string left_svect_str = program.get<std::string>("--left-svect");
   std::string right_svect_str = program.get<std::string>("--right-svect");
+  bool validate = program.get<bool>("--validate");
+  float validate_threshold = program.get<float>("--validate-threshold");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  std::string trace_path = program.get<std::string>("--trace");
+  int trace_capacity = program.get<int>("--trace-capacity");
+  bool pareto = program.get<bool>("--pareto");
+  bool telemetry = program.get<bool>("--telemetry");
+  float tol_min = program.get<float>("--tol-min");
+  float tol_max = program.get<float>("--tol-max");
+  int tol_steps = program.get<int>("--tol-steps");
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
 
   if (lda < M) lda = M;
+  if (!trace_path.empty()) trace_enable(trace_capacity);
   
   // ストライドの計算（指定されていない場合はlda * Nを使用）
   rocblas_stride strideA;
@@ -149,9 +232,18 @@ int main(int argc, char *argv[]) {
   }
   
   // create_matrices_for_sgesvdj_strided_batched関数の呼び出し
-  float *hA = create_matrices_for_sgesvdj_strided_batched(M, N, lda, strideA, batch_count, random_seed);
+  int64_t trace_start = trace_begin();
+  float *hA;
+  if (spectrum == SpectrumKind::random) {
+    hA = create_matrices_for_sgesvdj_strided_batched(M, N, lda, strideA, batch_count, random_seed);
+  } else {
+    hA = create_general_matrices_with_spectrum<float>(M, N, lda, strideA, batch_count, random_seed,
+                                                       spectrum, cond);
+  }
+  trace_end("generate", "setup", trace_start);
 
   // initialization
+  trace_start = trace_begin();
   rocblas_handle handle;
   rocblas_create_handle(&handle);
 
@@ -185,8 +277,12 @@ int main(int argc, char *argv[]) {
   hipMalloc((void**)&dResidual, sizeof(float)*batch_count);
   hipMalloc((void**)&dNSweeps, sizeof(rocblas_int)*batch_count);
 
+  trace_end("allocate", "setup", trace_start);
+
   // copy data to GPU
+  trace_start = trace_begin();
   hipMemcpy(dA, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+  trace_end("H2D copy", "copy", trace_start);
 
   // create events for timing
   hipEvent_t start, stop;
@@ -202,6 +298,7 @@ int main(int argc, char *argv[]) {
   hipEvent_t warmup_start, warmup_current;
   hipEventCreate(&warmup_start);
   hipEventCreate(&warmup_current);
+  int64_t trace_warmup = trace_begin();
   hipEventRecord(warmup_start, 0);
 
   float warmup_elapsed = 0.0f;
@@ -222,16 +319,23 @@ int main(int argc, char *argv[]) {
     hipEventElapsedTime(&warmup_elapsed, warmup_start, warmup_current);
   }
 
+  trace_end("warm-up", "phase", trace_warmup);
   printf("Completed %d warm-up iterations in %.2f ms\n", warmup_count, warmup_elapsed);
   hipEventDestroy(warmup_start);
   hipEventDestroy(warmup_current);
   
+  // per-matrix convergence of the timed iterations
+  JacobiTelemetry convergence;
+  
   // run the computation multiple times for timing
   for (int iter = 0; iter < iterations; ++iter) {
     // Copy fresh data to GPU for each iteration
+    trace_start = trace_begin();
     hipMemcpy(dA, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+    trace_end("restore", "copy", trace_start, iter);
     
     // start timing
+    trace_start = trace_begin();
     hipEventRecord(start, 0);
     
     // compute the SVD on the GPU
@@ -243,11 +347,20 @@ int main(int argc, char *argv[]) {
     // stop timing
     hipEventRecord(stop, 0);
     hipEventSynchronize(stop);
+    trace_end("iteration", "phase", trace_start, iter);
     
     // calculate elapsed time
     float elapsed_time;
     hipEventElapsedTime(&elapsed_time, start, stop);
     timings.push_back(elapsed_time);
+    
+    // fetch the per-matrix convergence outside the timed region
+    if (telemetry) {
+      record_jacobi_telemetry(&convergence, elapsed_time, dNSweeps, dResidual, dInfo, batch_count,
+                              [](void *dst, const void *src, size_t bytes) {
+                                hipMemcpy(dst, src, bytes, hipMemcpyDeviceToHost);
+                              });
+    }
   }
   
   // calculate statistics
@@ -258,11 +371,85 @@ int main(int argc, char *argv[]) {
   float std_dev = 0.0f;
   for (float t : timings) std_dev += (t - avg_time) * (t - avg_time);
   std_dev = sqrt(std_dev / timings.size());
-  
+
+  // validate the results outside the timed region
+  SvdValidation validation = {};
+  if (validate) {
+    trace_start = trace_begin();
+    // Solve the pristine matrices once more
+    hipMemcpy(dA, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+    rocsolver_sgesvdj_strided_batched(handle, left_svect, right_svect, M, N, dA, lda, strideA, 
+                                     tolerance, dResidual, max_sweeps, dNSweeps, 
+                                     dS, strideS, dU, ldu, strideU, dV, ldv, strideV, 
+                                     dInfo, batch_count);
+
+    // U'U, V'V and USV' with batched sgemm on the GPU (dV holds V' as rows)
+    bool have_u = (left_svect != rocblas_svect_none);
+    bool have_v = (right_svect != rocblas_svect_none);
+    rocblas_stride strideK = (rocblas_stride)min_mn * min_mn;
+    rocblas_stride strideUS = (rocblas_stride)M * min_mn;
+    rocblas_stride strideR = (rocblas_stride)M * N;
+    float one = 1.0f, zero = 0.0f;
+    float *hUtU = NULL, *hVtV = NULL, *hUSVt = NULL;
+
+    if (have_u) {
+      float *dUtU;
+      hipMalloc((void**)&dUtU, sizeof(float)*strideK*batch_count);
+      rocblas_sgemm_strided_batched(handle, rocblas_operation_transpose, rocblas_operation_none,
+                                    min_mn, min_mn, M, &one, dU, ldu, strideU, dU, ldu, strideU,
+                                    &zero, dUtU, min_mn, strideK, batch_count);
+      hUtU = (float*)malloc(sizeof(float)*strideK*batch_count);
+      hipMemcpy(hUtU, dUtU, sizeof(float)*strideK*batch_count, hipMemcpyDeviceToHost);
+      hipFree(dUtU);
+    }
+    if (have_v) {
+      float *dVtV;
+      hipMalloc((void**)&dVtV, sizeof(float)*strideK*batch_count);
+      rocblas_sgemm_strided_batched(handle, rocblas_operation_none, rocblas_operation_transpose,
+                                    min_mn, min_mn, N, &one, dV, ldv, strideV, dV, ldv, strideV,
+                                    &zero, dVtV, min_mn, strideK, batch_count);
+      hVtV = (float*)malloc(sizeof(float)*strideK*batch_count);
+      hipMemcpy(hVtV, dVtV, sizeof(float)*strideK*batch_count, hipMemcpyDeviceToHost);
+      hipFree(dVtV);
+    }
+    if (have_u && have_v) {
+      float *dUS, *dUSVt;
+      hipMalloc((void**)&dUS, sizeof(float)*strideUS*batch_count);
+      hipMalloc((void**)&dUSVt, sizeof(float)*strideR*batch_count);
+      rocblas_sdgmm_strided_batched(handle, rocblas_side_right, M, min_mn, dU, ldu, strideU,
+                                    dS, 1, strideS, dUS, M, strideUS, batch_count);
+      rocblas_sgemm_strided_batched(handle, rocblas_operation_none, rocblas_operation_none,
+                                    M, N, min_mn, &one, dUS, M, strideUS, dV, ldv, strideV,
+                                    &zero, dUSVt, M, strideR, batch_count);
+      hUSVt = (float*)malloc(sizeof(float)*strideR*batch_count);
+      hipMemcpy(hUSVt, dUSVt, sizeof(float)*strideR*batch_count, hipMemcpyDeviceToHost);
+      hipFree(dUS);
+      hipFree(dUSVt);
+    }
+
+    rocblas_int *hInfo = (rocblas_int*)malloc(sizeof(rocblas_int)*size_info);
+    hipMemcpy(hInfo, dInfo, sizeof(rocblas_int)*size_info, hipMemcpyDeviceToHost);
+
+    validation = finish_svd_validation(M, N, hA, lda, strideA, hUSVt, hUtU, hVtV,
+                                       count_info_failures(hInfo, batch_count),
+                                       batch_count, validate_threshold);
+
+    free(hUtU);
+    free(hVtV);
+    free(hUSVt);
+    free(hInfo);
+    trace_end("validate", "phase", trace_start);
+  }
+
   // print timing results
   printf("\n===== Performance Results =====\n");
   printf("Matrix size: %d x %d\n", M, N);
   printf("Batch count: %d\n", batch_count);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
   printf("Left singular vectors: %s\n", left_svect_str.c_str());
   printf("Right singular vectors: %s\n", right_svect_str.c_str());
   printf("Tolerance: %e\n", tolerance);
@@ -271,9 +458,66 @@ int main(int argc, char *argv[]) {
   printf("Timing iterations: %d\n", iterations);
   printf("Average execution time: %.3f ms\n", avg_time);
   printf("Standard deviation: %.3f ms\n", std_dev);
+  if (validate) print_svd_validation(validation);
   printf("==============================\n\n");
+  print_environment();
+
+  if (telemetry) print_jacobi_telemetry(convergence);
+
+  // explore the tolerance / max-sweeps trade-off
+  if (pareto) {
+    std::vector<float> tolerances = log_grid(tol_min, tol_max, tol_steps);
+    std::vector<int> sweep_limits = {max_sweeps};
+    if (auto limits = program.present("--sweep-limits")) sweep_limits = parse_int_list(*limits);
+
+    rocblas_int *hNSweeps = (rocblas_int*)malloc(sizeof(rocblas_int)*batch_count);
+    rocblas_int *hInfo = (rocblas_int*)malloc(sizeof(rocblas_int)*size_info);
+    float *hResidual = (float*)malloc(sizeof(float)*batch_count);
+
+    auto run = [&](float trial_tolerance, int trial_sweeps, JacobiTrial *trial, float *values) {
+      float total = 0.0f;
+      for (int iter = 0; iter < iterations; ++iter) {
+        // restore the input outside the timed region
+        hipMemcpy(dA, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+        hipEventRecord(start, 0);
+        rocsolver_sgesvdj_strided_batched(handle, left_svect, right_svect, M, N, dA, lda, strideA, 
+                                         trial_tolerance, dResidual, trial_sweeps, dNSweeps, 
+                                         dS, strideS, dU, ldu, strideU, dV, ldv, strideV, 
+                                         dInfo, batch_count);
+        hipEventRecord(stop, 0);
+        hipEventSynchronize(stop);
+        float elapsed_time;
+        hipEventElapsedTime(&elapsed_time, start, stop);
+        total += elapsed_time;
+      }
+      trial->time_ms = total / iterations;
+
+      hipMemcpy(hNSweeps, dNSweeps, sizeof(rocblas_int)*batch_count, hipMemcpyDeviceToHost);
+      hipMemcpy(hInfo, dInfo, sizeof(rocblas_int)*size_info, hipMemcpyDeviceToHost);
+      hipMemcpy(hResidual, dResidual, sizeof(float)*batch_count, hipMemcpyDeviceToHost);
+      hipMemcpy(values, dS, sizeof(float)*size_S, hipMemcpyDeviceToHost);
+      summarise_jacobi_convergence(hNSweeps, hResidual, hInfo, batch_count, trial);
+    };
+
+    // reference singular values at machine precision
+    float *hRef = (float*)malloc(sizeof(float)*size_S);
+    JacobiTrial reference = {};
+    int reference_sweeps = std::max((int)max_sweeps, 100);
+    for (int limit : sweep_limits) reference_sweeps = std::max(reference_sweeps, limit);
+    run(0.0f, reference_sweeps, &reference, hRef);
+
+    std::vector<JacobiTrial> trials = explore_jacobi_tradeoff(tolerances, sweep_limits, min_mn, strideS,
+                                                              batch_count, hRef, run);
+    print_pareto_report("singular value", trials);
+
+    free(hRef);
+    free(hNSweeps);
+    free(hInfo);
+    free(hResidual);
+  }
 
   // clean up
+  trace_start = trace_begin();
   hipFree(dA);
   hipFree(dS);
   hipFree(dU);
@@ -285,4 +529,6 @@ int main(int argc, char *argv[]) {
   hipEventDestroy(start);
   hipEventDestroy(stop);
   rocblas_destroy_handle(handle);
+  trace_end("teardown", "setup", trace_start);
+  trace_finish(trace_path.c_str());
 }
@@ -6,9 +6,17 @@
 #include <vector> // for storing timing results
 #include <cmath> // for sqrt in standard deviation calculation
 #include <iostream> // for cout/cerr
+#include <algorithm> // for std::max
 
 #include <argparse/argparse.hpp>
 
+#include "validate.hpp" // for post-run validation
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "trace.hpp" // for --trace timelines
+#include "pareto.hpp" // for the tolerance / max-sweeps exploration
+#include "telemetry.hpp" // for per-matrix convergence telemetry
+#include "env_fingerprint.hpp" // for the environment of the results
+
 // Example: Compute the eigenvalues and eigenvectors of an array of symmetric matrices on the GPU
 
 float *create_matrices_for_ssyevj_strided_batched(rocblas_int N,
@@ -88,6 +96,62 @@ int main(int argc, char *argv[]) {
       .help("Maximum number of sweeps for Jacobi method")
       .default_value(100)
       .scan<'i', int>();
+      
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+      
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+      
+  program.add_argument("--validate")
+      .help("Validate the results once after timing")
+      .default_value(false)
+      .implicit_value(true);
+      
+  program.add_argument("--validate-threshold")
+      .help("Validation failure threshold in units of N * machine epsilon")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--trace")
+      .help("Write a timeline of the run in Chrome trace format (chrome://tracing, Perfetto) to this file")
+      .default_value(std::string(""));
+
+  program.add_argument("--trace-capacity")
+      .help("Spans kept per thread for --trace; the oldest are overwritten first")
+      .default_value(65536)
+      .scan<'i', int>();
+      
+  program.add_argument("--pareto")
+      .help("Explore the tolerance / max-sweeps trade-off after the timed run")
+      .default_value(false)
+      .implicit_value(true);
+      
+  program.add_argument("--tol-min")
+      .help("Smallest tolerance of the --pareto log grid")
+      .default_value(1e-8f)
+      .scan<'f', float>();
+      
+  program.add_argument("--tol-max")
+      .help("Largest tolerance of the --pareto log grid")
+      .default_value(1e-1f)
+      .scan<'f', float>();
+      
+  program.add_argument("--tol-steps")
+      .help("Number of tolerances on the --pareto log grid")
+      .default_value(8)
+      .scan<'i', int>();
+      
+  program.add_argument("--sweep-limits")
+      .help("Comma-separated max-sweeps values for --pareto (default: --max-sweeps)");
+      
+  program.add_argument("--telemetry")
+      .help("Report per-matrix convergence (sweeps, residual, info) of the timed iterations")
+      .default_value(false)
+      .implicit_value(true);
   
   // 引数の解析
   try {
@@ -107,8 +171,27 @@ int main(int argc, char *argv[]) {
   int warmup_time = program.get<int>("--warmup-time");
   float tolerance = program.get<float>("--tolerance");
   rocblas_int max_sweeps = program.get<int>("--max-sweeps");
+  bool validate = program.get<bool>("--validate");
+  float validate_threshold = program.get<float>("--validate-threshold");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  std::string trace_path = program.get<std::string>("--trace");
+  int trace_capacity = program.get<int>("--trace-capacity");
+  bool pareto = program.get<bool>("--pareto");
+  bool telemetry = program.get<bool>("--telemetry");
+  float tol_min = program.get<float>("--tol-min");
+  float tol_max = program.get<float>("--tol-max");
+  int tol_steps = program.get<int>("--tol-steps");
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
 
   if (lda < N) lda = N;
+  if (!trace_path.empty()) trace_enable(trace_capacity);
   
   // ストライドの計算（指定されていない場合はlda * Nを使用）
   rocblas_stride strideA;
@@ -119,9 +202,18 @@ int main(int argc, char *argv[]) {
   }
   
   // create_matrices_for_ssyevj_strided_batched関数の呼び出し
-  float *hA = create_matrices_for_ssyevj_strided_batched(N, lda, strideA, batch_count, random_seed);
+  int64_t trace_start = trace_begin();
+  float *hA;
+  if (spectrum == SpectrumKind::random) {
+    hA = create_matrices_for_ssyevj_strided_batched(N, lda, strideA, batch_count, random_seed);
+  } else {
+    hA = create_symmetric_matrices_with_spectrum<float>(N, lda, strideA, batch_count, random_seed,
+                                                         spectrum, cond);
+  }
+  trace_end("generate", "setup", trace_start);
 
   // initialization
+  trace_start = trace_begin();
   rocblas_handle handle;
   rocblas_create_handle(&handle);
 
@@ -140,8 +232,12 @@ int main(int argc, char *argv[]) {
   hipMalloc((void**)&dResidual, sizeof(float)*batch_count);
   hipMalloc((void**)&dNSweeps, sizeof(rocblas_int)*batch_count);
 
+  trace_end("allocate", "setup", trace_start);
+
   // copy data to GPU
+  trace_start = trace_begin();
   hipMemcpy(dA, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+  trace_end("H2D copy", "copy", trace_start);
 
   // create events for timing
   hipEvent_t start, stop;
@@ -157,6 +253,7 @@ int main(int argc, char *argv[]) {
   hipEvent_t warmup_start, warmup_current;
   hipEventCreate(&warmup_start);
   hipEventCreate(&warmup_current);
+  int64_t trace_warmup = trace_begin();
   hipEventRecord(warmup_start, 0);
 
   float warmup_elapsed = 0.0f;
@@ -181,13 +278,23 @@ int main(int argc, char *argv[]) {
     hipEventElapsedTime(&warmup_elapsed, warmup_start, warmup_current);
   }
 
+  trace_end("warm-up", "phase", trace_warmup);
   printf("Completed %d warm-up iterations in %.2f ms\n", warmup_count, warmup_elapsed);
   hipEventDestroy(warmup_start);
   hipEventDestroy(warmup_current);
   
+  // per-matrix convergence of the timed iterations
+  JacobiTelemetry convergence;
+  
   // run the computation multiple times for timing
   for (int iter = 0; iter < iterations; ++iter) {
+    // Copy fresh data to GPU for each iteration (dA is overwritten by the eigenvectors)
+    trace_start = trace_begin();
+    hipMemcpy(dA, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+    trace_end("restore", "copy", trace_start, iter);
+    
     // start timing
+    trace_start = trace_begin();
     hipEventRecord(start, 0);
     
     // compute the eigenvalues and eigenvectors on the GPU
@@ -198,11 +305,20 @@ int main(int argc, char *argv[]) {
     // stop timing
     hipEventRecord(stop, 0);
     hipEventSynchronize(stop);
+    trace_end("iteration", "phase", trace_start, iter);
     
     // calculate elapsed time
     float elapsed_time;
     hipEventElapsedTime(&elapsed_time, start, stop);
     timings.push_back(elapsed_time);
+    
+    // fetch the per-matrix convergence outside the timed region
+    if (telemetry) {
+      record_jacobi_telemetry(&convergence, elapsed_time, dNSweeps, dResidual, dInfo, batch_count,
+                              [](void *dst, const void *src, size_t bytes) {
+                                hipMemcpy(dst, src, bytes, hipMemcpyDeviceToHost);
+                              });
+    }
   }
   
   // calculate statistics
@@ -213,20 +329,135 @@ int main(int argc, char *argv[]) {
   float std_dev = 0.0f;
   for (float t : timings) std_dev += (t - avg_time) * (t - avg_time);
   std_dev = sqrt(std_dev / timings.size());
-  
+
+  // validate the results outside the timed region
+  EigenValidation validation = {};
+  if (validate) {
+    trace_start = trace_begin();
+    // Solve the pristine matrices once more
+    hipMemcpy(dA, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+    rocsolver_ssyevj_strided_batched(handle, esort, evect, uplo, N, dA, lda, strideA, 
+                                    tolerance, dResidual, max_sweeps, dNSweeps, 
+                                    dW, strideW, dInfo, batch_count);
+
+    // AV and V'V with batched sgemm on the GPU; dA now holds the eigenvectors
+    rocblas_stride strideP = (rocblas_stride)N * N;
+    size_t size_P = strideP * (size_t)batch_count;
+    float *dA0, *dAV, *dVtV;
+    hipMalloc((void**)&dA0, sizeof(float)*size_A);
+    hipMalloc((void**)&dAV, sizeof(float)*size_P);
+    hipMalloc((void**)&dVtV, sizeof(float)*size_P);
+    hipMemcpy(dA0, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+
+    float one = 1.0f, zero = 0.0f;
+    rocblas_sgemm_strided_batched(handle, rocblas_operation_none, rocblas_operation_none, N, N, N,
+                                  &one, dA0, lda, strideA, dA, lda, strideA,
+                                  &zero, dAV, N, strideP, batch_count);
+    rocblas_sgemm_strided_batched(handle, rocblas_operation_transpose, rocblas_operation_none, N, N, N,
+                                  &one, dA, lda, strideA, dA, lda, strideA,
+                                  &zero, dVtV, N, strideP, batch_count);
+
+    // copy everything needed for the norms back to the CPU
+    float *hV = (float*)malloc(sizeof(float)*size_A);
+    float *hW = (float*)malloc(sizeof(float)*size_W);
+    float *hAV = (float*)malloc(sizeof(float)*size_P);
+    float *hVtV = (float*)malloc(sizeof(float)*size_P);
+    rocblas_int *hInfo = (rocblas_int*)malloc(sizeof(rocblas_int)*size_info);
+    hipMemcpy(hV, dA, sizeof(float)*size_A, hipMemcpyDeviceToHost);
+    hipMemcpy(hW, dW, sizeof(float)*size_W, hipMemcpyDeviceToHost);
+    hipMemcpy(hAV, dAV, sizeof(float)*size_P, hipMemcpyDeviceToHost);
+    hipMemcpy(hVtV, dVtV, sizeof(float)*size_P, hipMemcpyDeviceToHost);
+    hipMemcpy(hInfo, dInfo, sizeof(rocblas_int)*size_info, hipMemcpyDeviceToHost);
+
+    validation = finish_eigen_validation(N, hA, lda, strideA, hV, lda, strideA, hW, strideW,
+                                         hAV, hVtV, count_info_failures(hInfo, batch_count),
+                                         batch_count, validate_threshold);
+
+    hipFree(dA0);
+    hipFree(dAV);
+    hipFree(dVtV);
+    free(hV);
+    free(hW);
+    free(hAV);
+    free(hVtV);
+    free(hInfo);
+    trace_end("validate", "phase", trace_start);
+  }
+
   // print timing results
   printf("\n===== Performance Results =====\n");
   printf("Matrix size: %d x %d\n", N, N);
   printf("Batch count: %d\n", batch_count);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
   printf("Tolerance: %e\n", tolerance);
   printf("Max sweeps: %d\n", max_sweeps);
   printf("Warm-up time: %d ms (completed %d iterations)\n", warmup_time, warmup_count);
   printf("Timing iterations: %d\n", iterations);
   printf("Average execution time: %.3f ms\n", avg_time);
   printf("Standard deviation: %.3f ms\n", std_dev);
+  if (validate) print_eigen_validation(validation);
   printf("==============================\n\n");
+  print_environment();
+
+  if (telemetry) print_jacobi_telemetry(convergence);
+
+  // explore the tolerance / max-sweeps trade-off
+  if (pareto) {
+    std::vector<float> tolerances = log_grid(tol_min, tol_max, tol_steps);
+    std::vector<int> sweep_limits = {max_sweeps};
+    if (auto limits = program.present("--sweep-limits")) sweep_limits = parse_int_list(*limits);
+
+    rocblas_int *hNSweeps = (rocblas_int*)malloc(sizeof(rocblas_int)*batch_count);
+    rocblas_int *hInfo = (rocblas_int*)malloc(sizeof(rocblas_int)*size_info);
+    float *hResidual = (float*)malloc(sizeof(float)*batch_count);
+
+    auto run = [&](float trial_tolerance, int trial_sweeps, JacobiTrial *trial, float *values) {
+      float total = 0.0f;
+      for (int iter = 0; iter < iterations; ++iter) {
+        // restore the input outside the timed region
+        hipMemcpy(dA, hA, sizeof(float)*size_A, hipMemcpyHostToDevice);
+        hipEventRecord(start, 0);
+        rocsolver_ssyevj_strided_batched(handle, esort, evect, uplo, N, dA, lda, strideA, 
+                                        trial_tolerance, dResidual, trial_sweeps, dNSweeps, 
+                                        dW, strideW, dInfo, batch_count);
+        hipEventRecord(stop, 0);
+        hipEventSynchronize(stop);
+        float elapsed_time;
+        hipEventElapsedTime(&elapsed_time, start, stop);
+        total += elapsed_time;
+      }
+      trial->time_ms = total / iterations;
+
+      hipMemcpy(hNSweeps, dNSweeps, sizeof(rocblas_int)*batch_count, hipMemcpyDeviceToHost);
+      hipMemcpy(hInfo, dInfo, sizeof(rocblas_int)*size_info, hipMemcpyDeviceToHost);
+      hipMemcpy(hResidual, dResidual, sizeof(float)*batch_count, hipMemcpyDeviceToHost);
+      hipMemcpy(values, dW, sizeof(float)*size_W, hipMemcpyDeviceToHost);
+      summarise_jacobi_convergence(hNSweeps, hResidual, hInfo, batch_count, trial);
+    };
+
+    // reference eigenvalues at machine precision
+    float *hRef = (float*)malloc(sizeof(float)*size_W);
+    JacobiTrial reference = {};
+    int reference_sweeps = std::max((int)max_sweeps, 100);
+    for (int limit : sweep_limits) reference_sweeps = std::max(reference_sweeps, limit);
+    run(0.0f, reference_sweeps, &reference, hRef);
+
+    std::vector<JacobiTrial> trials = explore_jacobi_tradeoff(tolerances, sweep_limits, N, strideW,
+                                                              batch_count, hRef, run);
+    print_pareto_report("eigenvalue", trials);
+
+    free(hRef);
+    free(hNSweeps);
+    free(hInfo);
+    free(hResidual);
+  }
 
   // clean up
+  trace_start = trace_begin();
   hipFree(dA);
   hipFree(dW);
   hipFree(dInfo);
@@ -236,4 +467,6 @@ int main(int argc, char *argv[]) {
   hipEventDestroy(start);
   hipEventDestroy(stop);
   rocblas_destroy_handle(handle);
+  trace_end("teardown", "setup", trace_start);
+  trace_finish(trace_path.c_str());
 }
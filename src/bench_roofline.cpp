@@ -0,0 +1,176 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for measurements
+#include <sstream> // for splitting the size list
+#include <iostream> // for cout/cerr
+#include <cstring> // for memcpy
+#include <algorithm> // for std::min
+#include <omp.h> // for omp_get_wtime, omp_get_max_threads
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the batched OpenBLAS paths
+#include "flops.hpp" // for the flop and byte models
+#include "matrix_gen.hpp" // for the random test matrices
+#include "roofline.hpp" // for the machine ceilings
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Place the batched OpenBLAS solvers on the roofline of this machine.
+//
+// The ceilings (STREAM triad bandwidth and FMA peak per thread count) are measured first, then
+// every size of --sizes is solved as one batch of --batch-count matrices --iterations times.
+// The table gives the arithmetic intensity of the compulsory traffic, the attained rate, the
+// attainable bound and the percent of roofline, so a size that is far below its bound points
+// at the solver rather than the hardware.
+
+double solver_flops(const CpuSolverLayout &layout) {
+  switch (layout.solver) {
+    case CpuSolver::ssyev: return ssyev_flops(layout.N);
+    case CpuSolver::ssyevd: return ssyevd_flops(layout.N);
+    case CpuSolver::sgesvd: return sgesvd_flops(layout.M, layout.N);
+  }
+  return 0.0;
+}
+
+double solver_bytes(const CpuSolverLayout &layout) {
+  switch (layout.solver) {
+    case CpuSolver::ssyev: return ssyev_bytes(layout.N);
+    case CpuSolver::ssyevd: return ssyevd_bytes(layout.N);
+    case CpuSolver::sgesvd: return sgesvd_bytes(layout.M, layout.N);
+  }
+  return 0.0;
+}
+
+// Average time in ms of one batched solve, after one untimed solve.
+float measure_batch(const CpuSolverLayout &layout, const float *hA, int batch_count, int iterations) {
+  size_t size_A = layout.strideA * (size_t)batch_count;
+  float *hA_copy = (float*)malloc(sizeof(float) * size_A);
+  float *hW = (float*)malloc(sizeof(float) * layout.strideW * batch_count);
+  float *hU = (float*)malloc(sizeof(float) * (layout.strideU ? layout.strideU : 1) * batch_count);
+  float *hVT = (float*)malloc(sizeof(float) * (layout.strideVT ? layout.strideVT : 1) * batch_count);
+
+  double total = 0.0;
+  for (int iter = -1; iter < iterations; ++iter) {  // iteration -1 is untimed
+    // Copy the original matrices for this iteration
+    memcpy(hA_copy, hA, sizeof(float) * size_A);
+    double start = omp_get_wtime();
+    cpu_solver_batched(layout, hA_copy, hW, hU, hVT, NULL, batch_count);
+    if (iter >= 0) total += omp_get_wtime() - start;
+  }
+
+  free(hA_copy);
+  free(hW);
+  free(hU);
+  free(hVT);
+  return (float)(total / iterations * 1e3);
+}
+
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_roofline");
+
+  program.add_argument("--solver")
+      .help("Solver path (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyevd"));
+
+  program.add_argument("--sizes")
+      .help("Space-separated matrix sizes (N x N; sgesvd uses M = N)")
+      .default_value(std::string("16 32 64 128 256"));
+
+  program.add_argument("-b", "--batch-count")
+      .help("Batch count")
+      .default_value(64)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of timed solves per size")
+      .default_value(5)
+      .scan<'i', int>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str = program.get<std::string>("--solver");
+  std::string sizes_str = program.get<std::string>("--sizes");
+  int batch_count = program.get<int>("--batch-count");
+  int random_seed = program.get<int>("--random-seed");
+  int iterations = program.get<int>("--iterations");
+
+  CpuSolver solver;
+  if (!parse_cpu_solver(solver_str, &solver)) {
+    std::cerr << "Unknown solver: " << solver_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::vector<int> sizes;
+  std::istringstream size_list(sizes_str);
+  for (int N; size_list >> N;) {
+    if (N < 1) {
+      std::cerr << "Invalid size: " << N << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+    sizes.push_back(N);
+  }
+  if (sizes.empty()) {
+    std::cerr << "No sizes given" << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (iterations < 1) iterations = 1;
+  if (batch_count < 1) batch_count = 1;
+
+  int threads = omp_get_max_threads();
+  printf("Measuring the ceilings...\n");
+  RooflineCeilings ceilings = roofline_calibrate(threads);
+  double peak, gbps;
+  roofline_ceiling(ceilings, threads, &peak, &gbps);
+
+  std::vector<float> times;
+  for (int N : sizes) {
+    CpuSolverLayout layout = make_cpu_solver_layout(solver, N, N, N);
+    float *hA = (solver == CpuSolver::sgesvd)
+                    ? create_general_matrices(N, N, layout.lda, layout.strideA, batch_count, random_seed)
+                    : create_symmetric_matrices(N, layout.lda, layout.strideA, batch_count, random_seed);
+    times.push_back(measure_batch(layout, hA, batch_count, iterations));
+    printf("  N = %d: %.3f ms\n", N, times.back());
+    fflush(stdout);
+    free(hA);
+  }
+
+  // print results
+  printf("\n===== Roofline (CPU - OpenBLAS) =====\n");
+  printf("Solver: %s\n", cpu_solver_name(solver));
+  printf("Batch count: %d\n", batch_count);
+  printf("Threads: %d\n", threads);
+  printf("Timing iterations per size: %d\n", iterations);
+  print_roofline_ceilings(ceilings);
+  printf("  %6s %12s %12s %12s %14s %9s %8s\n", "N", "time (ms)", "flop/byte", "GFLOP/s", "bound GFLOP/s", "bound", "roofline");
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    CpuSolverLayout layout = make_cpu_solver_layout(solver, sizes[i], sizes[i], sizes[i]);
+    double intensity, attained, bound;
+    bool memory_bound;
+    double percent = roofline_percent(solver_flops(layout) * batch_count, solver_bytes(layout) * batch_count,
+                                      times[i] * 1e-3, peak, gbps, &intensity, &attained, &bound, &memory_bound);
+    printf("  %6d %12.3f %12.2f %12.2f %14.2f %9s %7.1f%%\n", sizes[i], times[i], intensity, attained, bound,
+           memory_bound ? "memory" : "compute", percent);
+  }
+  printf("=====================================\n\n");
+  print_environment();
+
+  return 0;
+}
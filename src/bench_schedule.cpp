@@ -0,0 +1,263 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for measurements
+#include <sstream> // for splitting the schedule list
+#include <iostream> // for cout/cerr
+#include <cstring> // for memcpy
+#include <algorithm> // for std::min
+#include <omp.h> // for omp_get_wtime, omp_get_max_threads
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the batched OpenBLAS paths
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "omp_balance.hpp" // for per-thread busy and barrier wait times
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Compare OpenMP schedules of the CPU batch loop.
+//
+// The same batch is solved under every schedule of --schedules (omp_set_schedule with a
+// schedule(runtime) loop), each after one untimed solve, and every timed iteration records the
+// per-thread busy and barrier wait times. The report gives the batch time, the imbalance factor
+// (slowest thread / mean thread busy time) and the idle fraction of every schedule and names the
+// fastest one; pass it to the OpenBLAS benches as --schedule. Matrices whose cost varies (ssyev
+// on clustered spectra, small batches on many threads) are where the schedules differ.
+
+struct ScheduleResult {
+  std::string schedule;
+  float mean_ms, min_ms;
+  LoadBalance balance;
+};
+
+// Solve the batch iterations times under the current runtime schedule.
+ScheduleResult measure_schedule(const CpuSolverLayout &layout, const float *hA, int batch_count,
+                                int iterations) {
+  size_t size_A = layout.strideA * (size_t)batch_count;
+  float *hA_copy = (float*)malloc(sizeof(float) * size_A);
+  float *hW = (float*)malloc(sizeof(float) * layout.strideW * batch_count);
+  float *hU = (float*)malloc(sizeof(float) * (layout.strideU ? layout.strideU : 1) * batch_count);
+  float *hVT = (float*)malloc(sizeof(float) * (layout.strideVT ? layout.strideVT : 1) * batch_count);
+
+  ScheduleResult result = {};
+  TeamTimes team_times(omp_get_max_threads());
+  std::vector<float> timings;
+  for (int iter = -1; iter < iterations; ++iter) {  // iteration -1 is untimed
+    // Copy the original matrices for this iteration
+    memcpy(hA_copy, hA, sizeof(float) * size_A);
+
+    double start = omp_get_wtime();
+    #pragma omp parallel
+    {
+      // Allocate thread-local workspaces
+      float *thread_work = (float*)malloc(sizeof(float) * layout.lwork);
+      lapack_int *thread_iwork = (lapack_int*)malloc(sizeof(lapack_int) * (layout.liwork > 0 ? layout.liwork : 1));
+
+      double loop_start = omp_get_wtime();
+      #pragma omp for schedule(runtime) nowait
+      for (int b = 0; b < batch_count; ++b) {
+        cpu_solver_one(layout, hA_copy, hW, hU, hVT, b, thread_work, thread_iwork);
+      }
+      team_times.loop_done(loop_start);
+      #pragma omp barrier
+      team_times.barrier_done();
+
+      // Free thread-local workspaces
+      free(thread_work);
+      free(thread_iwork);
+    }
+    double stop = omp_get_wtime();
+
+    if (iter < 0) continue;
+    timings.push_back((float)((stop - start) * 1e3));
+    record_load_balance(&result.balance, team_times);
+  }
+
+  free(hA_copy);
+  free(hW);
+  free(hU);
+  free(hVT);
+
+  result.min_ms = timings[0];
+  for (float t : timings) {
+    result.mean_ms += t;
+    result.min_ms = std::min(result.min_ms, t);
+  }
+  result.mean_ms /= timings.size();
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_schedule");
+
+  program.add_argument("--solver")
+      .help("Solver path (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyev"));
+
+  program.add_argument("-m", "--rows")
+      .help("Number of rows (M, sgesvd only)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N, or number of columns for sgesvd)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-b", "--batch-count")
+      .help("Batch count")
+      .default_value(1000)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of timed solves per schedule")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--schedules")
+      .help("Space-separated OpenMP schedules to compare (static, dynamic, guided, auto; optionally ',chunk')")
+      .default_value(std::string("static static,1 dynamic,1 dynamic,4 guided"));
+
+  program.add_argument("--details")
+      .help("Print the per-thread load balance of every schedule")
+      .default_value(false)
+      .implicit_value(true);
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str = program.get<std::string>("--solver");
+  int M = program.get<int>("--rows");
+  int N = program.get<int>("--size");
+  int batch_count = program.get<int>("--batch-count");
+  int random_seed = program.get<int>("--random-seed");
+  int iterations = program.get<int>("--iterations");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  std::string schedules_str = program.get<std::string>("--schedules");
+  bool details = program.get<bool>("--details");
+
+  CpuSolver solver;
+  if (!parse_cpu_solver(solver_str, &solver)) {
+    std::cerr << "Unknown solver: " << solver_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::vector<std::string> schedules;
+  std::istringstream schedule_list(schedules_str);
+  for (std::string schedule; schedule_list >> schedule;) {
+    omp_sched_t kind;
+    int chunk;
+    if (!parse_omp_schedule(schedule, &kind, &chunk)) {
+      std::cerr << "Unknown schedule: " << schedule << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+    schedules.push_back(schedule);
+  }
+  if (schedules.empty()) {
+    std::cerr << "No schedules given" << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (iterations < 1) iterations = 1;
+  if (batch_count < 1) batch_count = 1;
+
+  CpuSolverLayout layout = make_cpu_solver_layout(solver, M, N, M);
+  M = layout.M;
+
+  float *hA;
+  if (solver == CpuSolver::sgesvd) {
+    if (spectrum == SpectrumKind::random) {
+      hA = create_general_matrices(M, N, layout.lda, layout.strideA, batch_count, random_seed);
+    } else {
+      hA = create_general_matrices_with_spectrum<float>(M, N, layout.lda, layout.strideA, batch_count,
+                                                         random_seed, spectrum, cond);
+    }
+  } else {
+    if (spectrum == SpectrumKind::random) {
+      hA = create_symmetric_matrices(N, layout.lda, layout.strideA, batch_count, random_seed);
+    } else {
+      hA = create_symmetric_matrices_with_spectrum<float>(N, layout.lda, layout.strideA, batch_count,
+                                                           random_seed, spectrum, cond);
+    }
+  }
+
+  std::vector<ScheduleResult> results;
+  for (const std::string &schedule : schedules) {
+    set_omp_schedule(schedule);
+    results.push_back(measure_schedule(layout, hA, batch_count, iterations));
+    results.back().schedule = schedule;
+    printf("  %-12s %.3f ms\n", schedule.c_str(), results.back().mean_ms);
+    fflush(stdout);
+  }
+
+  size_t best = 0;
+  for (size_t s = 1; s < results.size(); ++s) {
+    if (results[s].mean_ms < results[best].mean_ms) best = s;
+  }
+
+  // print results
+  printf("\n===== OpenMP Schedule Comparison (CPU - OpenBLAS) =====\n");
+  printf("Solver: %s\n", cpu_solver_name(solver));
+  if (solver == CpuSolver::sgesvd) printf("Matrix size: %d x %d\n", M, N);
+  else printf("Matrix size: %d x %d\n", N, N);
+  printf("Batch count: %d\n", batch_count);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
+  printf("Threads: %d\n", omp_get_max_threads());
+  printf("Timing iterations per schedule: %d\n", iterations);
+  printf("  %-12s %12s %12s %10s %10s %8s\n", "schedule", "mean (ms)", "min (ms)", "imbalance", "idle", "vs best");
+  for (const ScheduleResult &r : results) {
+    double imbalance = 0.0, idle = 0.0;
+    for (double v : r.balance.imbalance) imbalance += v;
+    for (double v : r.balance.idle) idle += v;
+    imbalance /= r.balance.imbalance.size();
+    idle /= r.balance.idle.size();
+    printf("  %-12s %12.3f %12.3f %10.3f %9.2f%% %7.3fx\n", r.schedule.c_str(), r.mean_ms, r.min_ms,
+           imbalance, 100.0 * idle, r.mean_ms / results[best].mean_ms);
+  }
+  printf("Fastest: --schedule %s\n", results[best].schedule.c_str());
+  printf("========================================================\n\n");
+  print_environment();
+
+  if (details) {
+    for (const ScheduleResult &r : results) print_load_balance(r.balance, r.schedule);
+  }
+
+  // clean up
+  free(hA);
+}
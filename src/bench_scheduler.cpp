@@ -0,0 +1,614 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <random> // for random number generation and Poisson arrivals
+#include <vector> // for requests, work items and latencies
+#include <deque> // for the FIFO queue
+#include <iostream> // for cout/cerr
+#include <chrono> // for high-resolution timing
+#include <cstring> // for memcpy
+#include <thread> // for the submitter and the workers
+#include <mutex> // for the scheduler state
+#include <condition_variable> // for waking idle workers
+#include <algorithm> // for std::push_heap, std::sort
+#include <omp.h> // for single-threaded solves inside the workers
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the batched OpenBLAS paths
+#include "flops.hpp" // for the cost model
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "telemetry.hpp" // for sorted_percentile
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Earliest-deadline-first scheduling of mixed-size solve requests on the CPU.
+//
+// Two request classes share a pool of worker threads: small latency-critical requests (one small
+// matrix, tight deadline) and large jobs (a batch of big matrices, loose deadline), arriving as
+// one Poisson stream. Every request carries an absolute deadline. Two schedulers are compared
+// on the same arrivals:
+//
+// - fifo: requests are served in arrival order; consecutive small requests at the head of the
+//   queue are packed into one batched solve, a large job runs whole on one worker.
+// - edf:  the queued work with the earliest deadline runs first. A large job is split into
+//   slices that idle workers pick up in parallel, but --reserve workers are held back for small
+//   requests unless the large job's slack has run out. Small requests are packed with the next
+//   earliest small requests only while the cost estimate says the first one still meets its
+//   deadline.
+//
+// Costs are estimated from the flop model, scaled by a single-thread rate calibrated per class
+// at start-up. Workers are non-preemptive: a running slice always finishes.
+
+using Clock = std::chrono::steady_clock;
+
+float *create_pool(const CpuSolverLayout &layout, int pool_size, int random_seed,
+                   SpectrumKind spectrum, float cond) {
+  if (layout.solver == CpuSolver::sgesvd) {
+    if (spectrum == SpectrumKind::random) {
+      return create_general_matrices(layout.M, layout.N, layout.lda, layout.strideA, pool_size, random_seed);
+    }
+    return create_general_matrices_with_spectrum<float>(layout.M, layout.N, layout.lda, layout.strideA,
+                                                        pool_size, random_seed, spectrum, cond);
+  }
+  if (spectrum == SpectrumKind::random) {
+    return create_symmetric_matrices(layout.N, layout.lda, layout.strideA, pool_size, random_seed);
+  }
+  return create_symmetric_matrices_with_spectrum<float>(layout.N, layout.lda, layout.strideA,
+                                                        pool_size, random_seed, spectrum, cond);
+}
+
+double solver_flops(const CpuSolverLayout &layout) {
+  switch (layout.solver) {
+    case CpuSolver::ssyev: return ssyev_flops(layout.N);
+    case CpuSolver::ssyevd: return ssyevd_flops(layout.N);
+    case CpuSolver::sgesvd: return sgesvd_flops(layout.M, layout.N);
+  }
+  return 0.0;
+}
+
+enum { CLASS_SMALL, CLASS_LARGE, CLASS_COUNT };
+
+const char *class_names[CLASS_COUNT] = {"small", "large"};
+
+struct RequestClass {
+  CpuSolverLayout layout;
+  int matrices;         // matrices per request
+  double deadline_ms;   // relative deadline
+  double flops;         // per matrix
+  double flops_per_ms;  // calibrated single-thread rate
+  float *pool;
+  int pool_size;
+};
+
+struct Request {
+  int cls;
+  double arrival_ms;   // scheduled arrival, from the start of the run
+};
+
+// A unit of work: count matrices of one request.
+struct WorkItem {
+  int request;
+  int cls;
+  int first;           // first matrix of the request in this item
+  int count;
+  double deadline_ms;  // absolute
+  double cost_ms;      // estimated
+};
+
+struct LaterDeadline {
+  bool operator()(const WorkItem &a, const WorkItem &b) const {
+    return a.deadline_ms > b.deadline_ms || (a.deadline_ms == b.deadline_ms && a.request > b.request);
+  }
+};
+
+enum class Policy { fifo, edf };
+
+struct ClassResult {
+  int requests;
+  int misses;
+  float p50, p99, max;      // latency in ms
+  double max_lateness_ms;
+  double cost_ratio;        // measured / estimated solve time
+};
+
+struct PolicyResult {
+  ClassResult classes[CLASS_COUNT];
+  int requests;
+  int misses;
+  double elapsed_ms;
+};
+
+double estimate_cost_ms(const RequestClass &c, int count) {
+  return c.flops * count / c.flops_per_ms;
+}
+
+// Serve the request stream with the given policy.
+PolicyResult run_policy(Policy policy, const RequestClass *classes, const std::vector<Request> &requests,
+                        int workers, int max_batch, int slices, int reserve) {
+  int request_count = (int)requests.size();
+  std::vector<double> finish_ms(request_count, 0.0);
+  double measured_ms[CLASS_COUNT] = {0.0, 0.0};
+  double estimated_ms[CLASS_COUNT] = {0.0, 0.0};
+
+  std::mutex mutex;
+  std::condition_variable work_ready;
+  std::deque<WorkItem> fifo;
+  std::vector<WorkItem> heaps[CLASS_COUNT];  // min-heaps on the deadline, one per class
+  int busy_large = 0;                        // workers running large slices (edf)
+  int max_large = std::max(1, workers - reserve);
+  bool submitted_all = false;
+
+  Clock::time_point start = Clock::now() + std::chrono::milliseconds(10);
+  auto now_ms = [&]() {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  };
+  auto queue_empty = [&]() {
+    return (policy == Policy::fifo) ? fifo.empty() : heaps[CLASS_SMALL].empty() && heaps[CLASS_LARGE].empty();
+  };
+
+  // submitter: release every request at its arrival time
+  std::thread submitter([&]() {
+    for (int r = 0; r < request_count; ++r) {
+      const Request &request = requests[r];
+      const RequestClass &c = classes[request.cls];
+      std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+                                                std::chrono::duration<double, std::milli>(request.arrival_ms)));
+      int parts = (policy == Policy::edf && request.cls == CLASS_LARGE) ? std::min(slices, c.matrices) : 1;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int p = 0; p < parts; ++p) {
+          WorkItem item;
+          item.request = r;
+          item.cls = request.cls;
+          item.first = c.matrices * p / parts;
+          item.count = c.matrices * (p + 1) / parts - item.first;
+          item.deadline_ms = request.arrival_ms + c.deadline_ms;
+          item.cost_ms = estimate_cost_ms(c, item.count);
+          if (policy == Policy::fifo) {
+            fifo.push_back(item);
+          } else {
+            std::vector<WorkItem> &heap = heaps[item.cls];
+            heap.push_back(item);
+            std::push_heap(heap.begin(), heap.end(), LaterDeadline());
+          }
+        }
+      }
+      work_ready.notify_all();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      submitted_all = true;
+    }
+    work_ready.notify_all();
+  });
+
+  // take the next work for one worker; the items returned are all of one class. Returns false
+  // when the queued work may not start yet (edf holding the reserved workers back).
+  auto pick = [&](std::vector<WorkItem> &picked) {
+    if (policy == Policy::fifo) {
+      picked.push_back(fifo.front());
+      fifo.pop_front();
+      int count = picked.back().count;
+      while (picked.back().cls == CLASS_SMALL && !fifo.empty() && fifo.front().cls == CLASS_SMALL &&
+             count + fifo.front().count <= max_batch) {
+        count += fifo.front().count;
+        picked.push_back(fifo.front());
+        fifo.pop_front();
+      }
+      return true;
+    }
+
+    double start_ms = now_ms();
+    std::vector<WorkItem> &small = heaps[CLASS_SMALL];
+    std::vector<WorkItem> &large = heaps[CLASS_LARGE];
+
+    // a large slice may take a reserved worker only once its slack is down to its own cost
+    bool large_ready = !large.empty() &&
+                       (busy_large < max_large || start_ms + 2.0 * large.front().cost_ms >= large.front().deadline_ms);
+    bool take_large = large_ready && (small.empty() || large.front().deadline_ms < small.front().deadline_ms);
+    if (!take_large && small.empty()) return false;
+
+    std::vector<WorkItem> &heap = take_large ? large : small;
+    std::pop_heap(heap.begin(), heap.end(), LaterDeadline());
+    picked.push_back(heap.back());
+    heap.pop_back();
+    if (take_large) {
+      busy_large++;
+      return true;
+    }
+
+    // pack the next earliest small requests while the first one can still make its deadline
+    double first_deadline = picked.back().deadline_ms;
+    double cost = picked.back().cost_ms;
+    int count = picked.back().count;
+    while (!small.empty() && count + small.front().count <= max_batch &&
+           start_ms + cost + small.front().cost_ms <= first_deadline) {
+      std::pop_heap(small.begin(), small.end(), LaterDeadline());
+      cost += small.back().cost_ms;
+      count += small.back().count;
+      picked.push_back(small.back());
+      small.pop_back();
+    }
+    return true;
+  };
+
+  auto pick_next = [&](std::vector<WorkItem> &picked) { return !queue_empty() && pick(picked); };
+
+  size_t max_items = 0;
+  for (int k = 0; k < CLASS_COUNT; ++k) {
+    int most = (k == CLASS_SMALL) ? std::max(max_batch, classes[k].matrices) : classes[k].matrices;
+    max_items = std::max(max_items, (size_t)most);
+  }
+
+  std::vector<std::thread> threads;
+  for (int w = 0; w < workers; ++w) {
+    threads.emplace_back([&]() {
+      // parallelism comes from the workers; every solve is single-threaded
+      omp_set_num_threads(1);
+
+      size_t size_A = 0, size_W = 0, size_U = 1, size_VT = 1;
+      for (int k = 0; k < CLASS_COUNT; ++k) {
+        const CpuSolverLayout &l = classes[k].layout;
+        size_A = std::max(size_A, l.strideA * max_items);
+        size_W = std::max(size_W, l.strideW * max_items);
+        size_U = std::max(size_U, l.strideU * max_items);
+        size_VT = std::max(size_VT, l.strideVT * max_items);
+      }
+      float *A = (float*)malloc(sizeof(float) * size_A);
+      float *W = (float*)malloc(sizeof(float) * size_W);
+      float *U = (float*)malloc(sizeof(float) * size_U);
+      float *VT = (float*)malloc(sizeof(float) * size_VT);
+      std::vector<WorkItem> picked;
+
+      while (true) {
+        picked.clear();
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          while (!pick_next(picked)) {
+            if (queue_empty() && submitted_all) break;
+            // held-back large work becomes urgent with time alone, so wake up regularly
+            work_ready.wait_for(lock, std::chrono::milliseconds(1));
+          }
+          if (picked.empty()) break;
+        }
+
+        // gather the matrices of the picked items into one batch
+        const RequestClass &c = classes[picked[0].cls];
+        int count = 0;
+        double estimate = 0.0;
+        for (const WorkItem &item : picked) {
+          for (int i = 0; i < item.count; ++i) {
+            int source = (item.request * c.matrices + item.first + i) % c.pool_size;
+            memcpy(A + (count + i) * c.layout.strideA, c.pool + source * c.layout.strideA,
+                   sizeof(float) * c.layout.strideA);
+          }
+          count += item.count;
+          estimate += item.cost_ms;
+        }
+
+        double solve_start = now_ms();
+        cpu_solver_batched(c.layout, A, W, U, VT, NULL, count);
+        double done = now_ms();
+
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          for (const WorkItem &item : picked) {
+            finish_ms[item.request] = std::max(finish_ms[item.request], done);
+          }
+          measured_ms[picked[0].cls] += done - solve_start;
+          estimated_ms[picked[0].cls] += estimate;
+          if (policy == Policy::edf && picked[0].cls == CLASS_LARGE) busy_large--;
+        }
+        work_ready.notify_all();
+      }
+
+      free(A);
+      free(W);
+      free(U);
+      free(VT);
+    });
+  }
+
+  submitter.join();
+  for (std::thread &t : threads) t.join();
+
+  PolicyResult result = {};
+  result.requests = request_count;
+  std::vector<float> latencies[CLASS_COUNT];
+  for (int r = 0; r < request_count; ++r) {
+    const Request &request = requests[r];
+    ClassResult &cr = result.classes[request.cls];
+    double latency = finish_ms[r] - request.arrival_ms;
+    double lateness = latency - classes[request.cls].deadline_ms;
+    latencies[request.cls].push_back((float)latency);
+    cr.requests++;
+    if (lateness > 0.0) {
+      cr.misses++;
+      result.misses++;
+    }
+    cr.max_lateness_ms = (cr.requests == 1) ? lateness : std::max(cr.max_lateness_ms, lateness);
+    result.elapsed_ms = std::max(result.elapsed_ms, finish_ms[r]);
+  }
+  for (int k = 0; k < CLASS_COUNT; ++k) {
+    ClassResult &cr = result.classes[k];
+    std::sort(latencies[k].begin(), latencies[k].end());
+    cr.p50 = sorted_percentile(latencies[k], 50.0);
+    cr.p99 = sorted_percentile(latencies[k], 99.0);
+    cr.max = latencies[k].empty() ? 0.0f : latencies[k].back();
+    cr.cost_ratio = (estimated_ms[k] > 0.0) ? measured_ms[k] / estimated_ms[k] : 0.0;
+  }
+  return result;
+}
+
+// Single-thread rate of the solver on this class, in flops per millisecond.
+double calibrate_class(const RequestClass &c, int probe) {
+  float *A = (float*)malloc(sizeof(float) * c.layout.strideA * probe);
+  float *W = (float*)malloc(sizeof(float) * c.layout.strideW * probe);
+  float *U = (float*)malloc(sizeof(float) * (c.layout.strideU ? c.layout.strideU : 1) * probe);
+  float *VT = (float*)malloc(sizeof(float) * (c.layout.strideVT ? c.layout.strideVT : 1) * probe);
+
+  double best_ms = 0.0;
+  for (int rep = 0; rep < 3; ++rep) {
+    for (int i = 0; i < probe; ++i) {
+      memcpy(A + i * c.layout.strideA, c.pool + (i % c.pool_size) * c.layout.strideA,
+             sizeof(float) * c.layout.strideA);
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    cpu_solver_batched(c.layout, A, W, U, VT, NULL, probe);
+    auto stop = std::chrono::high_resolution_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    if (rep == 0 || ms < best_ms) best_ms = ms;
+  }
+
+  free(A);
+  free(W);
+  free(U);
+  free(VT);
+  return (best_ms > 0.0) ? c.flops * probe / best_ms : c.flops * probe;
+}
+
+void print_policy_result(const char *name, const PolicyResult &result) {
+  for (int k = 0; k < CLASS_COUNT; ++k) {
+    const ClassResult &cr = result.classes[k];
+    printf("  %-6s %-6s %9d %7.2f%% %10.3f %10.3f %10.3f %12.3f %10.2f\n",
+           name, class_names[k], cr.requests,
+           cr.requests ? 100.0 * cr.misses / cr.requests : 0.0,
+           cr.p50, cr.p99, cr.max, cr.max_lateness_ms, cr.cost_ratio);
+  }
+  printf("  %-6s %-6s %9d %7.2f%%\n", name, "all", result.requests,
+         result.requests ? 100.0 * result.misses / result.requests : 0.0);
+}
+
+// Compare EDF with FIFO batching on a mixed stream of small and large requests.
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_scheduler");
+
+  program.add_argument("--small-solver")
+      .help("Solver path of the small requests (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyevd"));
+
+  program.add_argument("--small-size")
+      .help("Matrix size of the small requests (N x N)")
+      .default_value(8)
+      .scan<'i', int>();
+
+  program.add_argument("--small-deadline-ms")
+      .help("Deadline of the small requests, relative to arrival")
+      .default_value(5.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--large-solver")
+      .help("Solver path of the large jobs (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("sgesvd"));
+
+  program.add_argument("--large-rows")
+      .help("Number of rows of the large matrices (sgesvd only)")
+      .default_value(256)
+      .scan<'i', int>();
+
+  program.add_argument("--large-size")
+      .help("Matrix size of the large jobs (N x N, or number of columns for sgesvd)")
+      .default_value(256)
+      .scan<'i', int>();
+
+  program.add_argument("--large-matrices")
+      .help("Matrices per large job")
+      .default_value(8)
+      .scan<'i', int>();
+
+  program.add_argument("--large-deadline-ms")
+      .help("Deadline of the large jobs, relative to arrival")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--large-fraction")
+      .help("Fraction of the requests that are large jobs")
+      .default_value(0.005f)
+      .scan<'f', float>();
+
+  program.add_argument("--rate")
+      .help("Offered load in requests per second")
+      .default_value(2000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("-d", "--duration")
+      .help("Duration of the load in milliseconds")
+      .default_value(3000)
+      .scan<'i', int>();
+
+  program.add_argument("-w", "--workers")
+      .help("Worker threads (default: one per hardware thread)")
+      .default_value(0)
+      .scan<'i', int>();
+
+  program.add_argument("--max-batch")
+      .help("Most small requests packed into one solve")
+      .default_value(32)
+      .scan<'i', int>();
+
+  program.add_argument("--reserve")
+      .help("Workers EDF keeps free for small requests while large jobs have slack")
+      .default_value(1)
+      .scan<'i', int>();
+
+  program.add_argument("--slices")
+      .help("Slices a large job is split into under EDF (default: one per unreserved worker)")
+      .default_value(0)
+      .scan<'i', int>();
+
+  program.add_argument("--pool")
+      .help("Number of distinct matrices per class cycled through by the requests")
+      .default_value(64)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation and arrivals")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str[CLASS_COUNT] = {program.get<std::string>("--small-solver"),
+                                         program.get<std::string>("--large-solver")};
+  int small_size = program.get<int>("--small-size");
+  int large_rows = program.get<int>("--large-rows");
+  int large_size = program.get<int>("--large-size");
+  int large_matrices = program.get<int>("--large-matrices");
+  float deadline_ms[CLASS_COUNT] = {program.get<float>("--small-deadline-ms"),
+                                    program.get<float>("--large-deadline-ms")};
+  float large_fraction = program.get<float>("--large-fraction");
+  float rate = program.get<float>("--rate");
+  int duration = program.get<int>("--duration");
+  int workers = program.get<int>("--workers");
+  int max_batch = program.get<int>("--max-batch");
+  int reserve = program.get<int>("--reserve");
+  int slices = program.get<int>("--slices");
+  int pool_size = program.get<int>("--pool");
+  int random_seed = program.get<int>("--random-seed");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+
+  CpuSolver solvers[CLASS_COUNT];
+  for (int k = 0; k < CLASS_COUNT; ++k) {
+    if (!parse_cpu_solver(solver_str[k], &solvers[k])) {
+      std::cerr << "Unknown solver: " << solver_str[k] << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+  }
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (workers < 1) workers = (int)std::max(1u, std::thread::hardware_concurrency());
+  if (reserve < 0) reserve = 0;
+  if (slices < 1) slices = std::max(1, workers - reserve);
+  if (max_batch < 1) max_batch = 1;
+  if (large_matrices < 1) large_matrices = 1;
+  if (pool_size < 1) pool_size = 1;
+
+  RequestClass classes[CLASS_COUNT];
+  classes[CLASS_SMALL].layout = make_cpu_solver_layout(solvers[CLASS_SMALL], small_size, small_size, small_size);
+  classes[CLASS_SMALL].matrices = 1;
+  classes[CLASS_LARGE].layout = make_cpu_solver_layout(solvers[CLASS_LARGE], large_rows, large_size, large_rows);
+  classes[CLASS_LARGE].matrices = large_matrices;
+
+  // generate the pools and calibrate the cost model on one thread
+  omp_set_num_threads(1);
+  printf("Calibrating the cost model...\n");
+  fflush(stdout);
+  for (int k = 0; k < CLASS_COUNT; ++k) {
+    RequestClass &c = classes[k];
+    c.deadline_ms = deadline_ms[k];
+    c.flops = solver_flops(c.layout);
+    c.pool_size = pool_size;
+    c.pool = create_pool(c.layout, pool_size, random_seed + k, spectrum, cond);
+    c.flops_per_ms = calibrate_class(c, (k == CLASS_SMALL) ? max_batch : 1);
+  }
+
+  // one mixed Poisson stream
+  std::vector<Request> requests;
+  {
+    std::mt19937 gen(random_seed);
+    std::exponential_distribution<double> gap(rate / 1e3);
+    std::bernoulli_distribution large(large_fraction);
+    for (double t = gap(gen); t < duration; t += gap(gen)) {
+      Request request;
+      request.cls = large(gen) ? CLASS_LARGE : CLASS_SMALL;
+      request.arrival_ms = t;
+      requests.push_back(request);
+    }
+  }
+
+  printf("Running FIFO batching on %zu requests...\n", requests.size());
+  fflush(stdout);
+  PolicyResult fifo = run_policy(Policy::fifo, classes, requests, workers, max_batch, slices, reserve);
+  printf("Running EDF on %zu requests...\n", requests.size());
+  fflush(stdout);
+  PolicyResult edf = run_policy(Policy::edf, classes, requests, workers, max_batch, slices, reserve);
+
+  // offered work per second of wall time, from the cost model
+  double offered_ms = 0.0;
+  for (const Request &request : requests) {
+    offered_ms += estimate_cost_ms(classes[request.cls], classes[request.cls].matrices);
+  }
+
+  // print results
+  printf("\n===== Scheduler Results (CPU - OpenBLAS) =====\n");
+  for (int k = 0; k < CLASS_COUNT; ++k) {
+    const RequestClass &c = classes[k];
+    if (c.layout.solver == CpuSolver::sgesvd) {
+      printf("%-5s: %s %d x %d, %d matrices/request, deadline %.1f ms, est. %.3f ms/request (%.2f GFLOP/s)\n",
+             class_names[k], cpu_solver_name(c.layout.solver), c.layout.M, c.layout.N, c.matrices,
+             c.deadline_ms, estimate_cost_ms(c, c.matrices), c.flops_per_ms / 1e6);
+    } else {
+      printf("%-5s: %s %d x %d, %d matrices/request, deadline %.1f ms, est. %.3f ms/request (%.2f GFLOP/s)\n",
+             class_names[k], cpu_solver_name(c.layout.solver), c.layout.N, c.layout.N, c.matrices,
+             c.deadline_ms, estimate_cost_ms(c, c.matrices), c.flops_per_ms / 1e6);
+    }
+  }
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
+  printf("Offered load: %.0f requests/s for %d ms (%.2f%% large), estimated utilisation %.1f%%\n",
+         rate, duration, 100.0 * large_fraction, 100.0 * offered_ms / duration / workers);
+  printf("Workers: %d, max batch: %d, EDF slices per large job: %d, reserved for small: %d\n",
+         workers, max_batch, slices, std::min(reserve, workers - 1));
+  printf("  %-6s %-6s %9s %8s %10s %10s %10s %12s %10s\n", "policy", "class", "requests", "missed",
+         "p50 (ms)", "p99 (ms)", "max (ms)", "lateness", "cost ratio");
+  print_policy_result("fifo", fifo);
+  print_policy_result("edf", edf);
+  printf("Deadline-miss rate: fifo %.2f%%, edf %.2f%%\n",
+         fifo.requests ? 100.0 * fifo.misses / fifo.requests : 0.0,
+         edf.requests ? 100.0 * edf.misses / edf.requests : 0.0);
+  printf("(lateness: worst finish time past the deadline, negative when every request met it;\n"
+         " cost ratio: measured / estimated solve time)\n");
+  printf("==============================================\n\n");
+  print_environment();
+
+  // clean up
+  for (int k = 0; k < CLASS_COUNT; ++k) free(classes[k].pool);
+}
@@ -0,0 +1,391 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <random> // for random number generation and Poisson arrivals
+#include <vector> // for arrival schedules and latencies
+#include <cmath> // for sqrt
+#include <iostream> // for cout/cerr
+#include <fstream> // for trace files
+#include <chrono> // for high-resolution timing
+#include <cstring> // for memcpy
+#include <thread> // for producers and the dispatcher
+#include <atomic> // for counting finished producers
+#include <algorithm> // for std::sort, std::min
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the batched OpenBLAS paths
+#include "mpmc_queue.hpp" // for the submission queues
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "pareto.hpp" // for parse_int_list
+#include "telemetry.hpp" // for sorted_percentile
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Serve single-matrix requests on the CPU with dynamic micro-batching.
+//
+// Producer threads submit one matrix at a time following an open-loop arrival process (Poisson,
+// or a recorded trace rescaled to the offered rate). A dispatcher thread takes the queued
+// requests as one micro-batch as soon as max-batch requests are waiting or the oldest one has
+// waited max-wait-us, and solves the micro-batch with the batched OpenBLAS path. Requests are
+// submitted through the lock-free ring queue, or the mutex + condvar queue for comparison.
+// Latency is measured from the scheduled arrival time, so a late producer does not hide queueing.
+
+using Clock = std::chrono::steady_clock;
+
+// Arrival offsets in microseconds of a Poisson process with the given rate (requests/s).
+std::vector<double> poisson_arrivals(double rate, double duration_ms, int random_seed) {
+  std::vector<double> arrivals;
+  std::mt19937 gen(random_seed);
+  std::exponential_distribution<double> gap(rate / 1e6);
+  double t = gap(gen);
+  while (t < duration_ms * 1000.0) {
+    arrivals.push_back(t);
+    t += gap(gen);
+  }
+  return arrivals;
+}
+
+// Read arrival timestamps (microseconds, one per line) and shift them to start at zero.
+bool read_trace(const std::string &path, std::vector<double> *trace) {
+  std::ifstream in(path);
+  if (!in) return false;
+  double t;
+  while (in >> t) trace->push_back(t);
+  if (trace->empty()) return false;
+  std::sort(trace->begin(), trace->end());
+  double t0 = trace->front();
+  for (double &x : *trace) x -= t0;
+  return true;
+}
+
+// The trace with its time axis stretched so that its mean rate equals rate.
+std::vector<double> scale_trace(const std::vector<double> &trace, double rate) {
+  std::vector<double> arrivals = trace;
+  double span = trace.back();
+  if (trace.size() < 2 || span <= 0.0) return arrivals;
+  double trace_rate = (trace.size() - 1) / (span / 1e6);
+  for (double &x : arrivals) x *= trace_rate / rate;
+  return arrivals;
+}
+
+struct LoadResult {
+  double offered_rate;
+  int requests;
+  double throughput;    // completed requests per second
+  double mean_batch;
+  int batches;
+  float p50, p99, p999, max;  // end-to-end latency in ms
+};
+
+// Run one open-loop load level and collect the end-to-end latency of every request.
+template <typename Queue>
+LoadResult run_load(const CpuSolverLayout &layout, const float *pool, int pool_size,
+                    const std::vector<double> &arrivals_us, double offered_rate,
+                    int producers, int max_batch, int max_wait_us, size_t queue_capacity) {
+  int requests = (int)arrivals_us.size();
+  std::vector<float> latency_ms(requests, 0.0f);
+
+  Queue queue(queue_capacity);      // request indices in submission order
+  std::vector<Clock::time_point> enqueued(requests);
+  std::atomic<int> finished_producers{0};
+
+  Clock::time_point start = Clock::now() + std::chrono::milliseconds(10);
+  auto scheduled = [&](int r) {
+    return start + std::chrono::duration_cast<Clock::duration>(
+                       std::chrono::duration<double, std::micro>(arrivals_us[r]));
+  };
+
+  // producers: request r is submitted by producer r % producers at its scheduled time
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p]() {
+      for (int r = p; r < requests; r += producers) {
+        std::this_thread::sleep_until(scheduled(r));
+        enqueued[r] = Clock::now();
+        queue.push(r);
+      }
+      finished_producers.fetch_add(1, std::memory_order_release);
+    });
+  }
+
+  // dispatcher: coalesce queued requests into micro-batches
+  float *A = (float*)malloc(sizeof(float) * layout.strideA * max_batch);
+  float *W = (float*)malloc(sizeof(float) * layout.strideW * max_batch);
+  float *U = (float*)malloc(sizeof(float) * (layout.strideU ? layout.strideU : 1) * max_batch);
+  float *VT = (float*)malloc(sizeof(float) * (layout.strideVT ? layout.strideVT : 1) * max_batch);
+  std::vector<int> batch;
+  int batches = 0;
+  Clock::time_point last_completion = start;
+
+  while (true) {
+    batch.clear();
+
+    // wait for the first request; stop once the producers are done and the queue is drained
+    int r;
+    if (!queue.pop_until(r, Clock::now() + std::chrono::milliseconds(1))) {
+      if (finished_producers.load(std::memory_order_acquire) < producers) continue;
+      if (!queue.try_pop(r)) break;
+    }
+    batch.push_back(r);
+
+    // wait for a full micro-batch, at most until the oldest request times out
+    Clock::time_point deadline = enqueued[r] + std::chrono::microseconds(max_wait_us);
+    while ((int)batch.size() < max_batch) {
+      bool draining = finished_producers.load(std::memory_order_acquire) == producers;
+      if (draining ? !queue.try_pop(r) : !queue.pop_until(r, deadline)) break;
+      batch.push_back(r);
+    }
+
+    int count = (int)batch.size();
+    for (int i = 0; i < count; ++i) {
+      memcpy(A + i * layout.strideA, pool + (batch[i] % pool_size) * layout.strideA,
+             sizeof(float) * layout.strideA);
+    }
+    cpu_solver_batched(layout, A, W, U, VT, NULL, count);
+
+    Clock::time_point done = Clock::now();
+    for (int request : batch) {
+      latency_ms[request] = std::chrono::duration<float, std::milli>(done - scheduled(request)).count();
+    }
+    last_completion = done;
+    batches++;
+  }
+
+  for (std::thread &t : threads) t.join();
+  free(A);
+  free(W);
+  free(U);
+  free(VT);
+
+  LoadResult result = {};
+  result.offered_rate = offered_rate;
+  result.requests = requests;
+  result.batches = batches;
+  result.mean_batch = batches ? (double)requests / batches : 0.0;
+  double elapsed_s = std::chrono::duration<double>(last_completion - start).count();
+  result.throughput = (elapsed_s > 0.0) ? requests / elapsed_s : 0.0;
+
+  std::sort(latency_ms.begin(), latency_ms.end());
+  result.p50 = sorted_percentile(latency_ms, 50.0);
+  result.p99 = sorted_percentile(latency_ms, 99.0);
+  result.p999 = sorted_percentile(latency_ms, 99.9);
+  result.max = latency_ms.empty() ? 0.0f : latency_ms.back();
+  return result;
+}
+
+// Measure end-to-end latency and throughput of a micro-batching solver service under open-loop load.
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_service");
+
+  program.add_argument("--solver")
+      .help("Solver path (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyevd"));
+
+  program.add_argument("-m", "--rows")
+      .help("Number of rows (M, sgesvd only)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N, or number of columns for sgesvd)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation and arrivals")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("--pool")
+      .help("Number of distinct matrices cycled through by the requests")
+      .default_value(256)
+      .scan<'i', int>();
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--arrival")
+      .help("Arrival process (poisson, trace)")
+      .default_value(std::string("poisson"));
+
+  program.add_argument("--trace")
+      .help("Arrival trace for --arrival trace: one timestamp in microseconds per line");
+
+  program.add_argument("--rates")
+      .help("Comma-separated offered loads in requests per second")
+      .default_value(std::string("1000,2000,4000,8000"));
+
+  program.add_argument("-d", "--duration")
+      .help("Duration of each Poisson load level in milliseconds")
+      .default_value(2000)
+      .scan<'i', int>();
+
+  program.add_argument("-p", "--producers")
+      .help("Number of producer threads")
+      .default_value(4)
+      .scan<'i', int>();
+
+  program.add_argument("--max-batch")
+      .help("Largest micro-batch")
+      .default_value(32)
+      .scan<'i', int>();
+
+  program.add_argument("--max-wait-us")
+      .help("Longest time the oldest queued request waits for a fuller micro-batch")
+      .default_value(1000)
+      .scan<'i', int>();
+
+  program.add_argument("--queue")
+      .help("Submission queue (lockfree, mutex)")
+      .default_value(std::string("lockfree"));
+
+  program.add_argument("--queue-capacity")
+      .help("Capacity of the submission queue; producers block while it is full")
+      .default_value(4096)
+      .scan<'i', int>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str = program.get<std::string>("--solver");
+  int M = program.get<int>("--rows");
+  int N = program.get<int>("--size");
+  int random_seed = program.get<int>("--random-seed");
+  int pool_size = program.get<int>("--pool");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  std::string arrival = program.get<std::string>("--arrival");
+  std::vector<int> rates = parse_int_list(program.get<std::string>("--rates"));
+  int duration = program.get<int>("--duration");
+  int producers = program.get<int>("--producers");
+  int max_batch = program.get<int>("--max-batch");
+  int max_wait_us = program.get<int>("--max-wait-us");
+  std::string queue_str = program.get<std::string>("--queue");
+  int queue_capacity = program.get<int>("--queue-capacity");
+
+  CpuSolver solver;
+  if (!parse_cpu_solver(solver_str, &solver)) {
+    std::cerr << "Unknown solver: " << solver_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  bool lockfree = (queue_str == "lockfree");
+  if (!lockfree && queue_str != "mutex") {
+    std::cerr << "Unknown queue: " << queue_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::vector<double> trace;
+  if (arrival == "trace") {
+    auto path = program.present("--trace");
+    if (!path || !read_trace(*path, &trace)) {
+      std::cerr << "--arrival trace needs a readable, non-empty --trace file" << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+  } else if (arrival != "poisson") {
+    std::cerr << "Unknown arrival process: " << arrival << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (producers < 1) producers = 1;
+  if (max_batch < 1) max_batch = 1;
+  if (pool_size < 1) pool_size = 1;
+  if (queue_capacity < 1) queue_capacity = 1;
+
+  CpuSolverLayout layout = make_cpu_solver_layout(solver, M, N, M);
+  M = layout.M;
+
+  float *pool;
+  if (solver == CpuSolver::sgesvd) {
+    if (spectrum == SpectrumKind::random) {
+      pool = create_general_matrices(M, N, layout.lda, layout.strideA, pool_size, random_seed);
+    } else {
+      pool = create_general_matrices_with_spectrum<float>(M, N, layout.lda, layout.strideA, pool_size,
+                                                           random_seed, spectrum, cond);
+    }
+  } else {
+    if (spectrum == SpectrumKind::random) {
+      pool = create_symmetric_matrices(N, layout.lda, layout.strideA, pool_size, random_seed);
+    } else {
+      pool = create_symmetric_matrices_with_spectrum<float>(N, layout.lda, layout.strideA, pool_size,
+                                                             random_seed, spectrum, cond);
+    }
+  }
+
+  // one load level through the selected queue
+  auto run = [&](const std::vector<double> &arrivals, double offered_rate, int threads) {
+    if (lockfree) {
+      return run_load<MpmcRingQueue<int>>(layout, pool, pool_size, arrivals, offered_rate,
+                                          threads, max_batch, max_wait_us, queue_capacity);
+    }
+    return run_load<MutexQueue<int>>(layout, pool, pool_size, arrivals, offered_rate,
+                                     threads, max_batch, max_wait_us, queue_capacity);
+  };
+
+  // warm up the solver and the OpenMP team with one full micro-batch
+  printf("Performing warm-up with one micro-batch of %d...\n", max_batch);
+  {
+    std::vector<double> burst(max_batch, 0.0);
+    run(burst, 0.0, 1);
+  }
+
+  std::vector<LoadResult> results;
+  for (size_t i = 0; i < rates.size(); ++i) {
+    std::vector<double> arrivals = (arrival == "trace")
+        ? scale_trace(trace, rates[i])
+        : poisson_arrivals(rates[i], duration, random_seed + (int)i);
+    printf("Offered load %d req/s: %zu requests...\n", rates[i], arrivals.size());
+    results.push_back(run(arrivals, rates[i], producers));
+  }
+
+  // print results
+  printf("\n===== Service Results (CPU - OpenBLAS) =====\n");
+  printf("Solver: %s\n", cpu_solver_name(solver));
+  if (solver == CpuSolver::sgesvd) printf("Matrix size: %d x %d\n", M, N);
+  else printf("Matrix size: %d x %d\n", N, N);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
+  if (arrival == "trace") printf("Arrivals: trace (%zu requests, rescaled per load)\n", trace.size());
+  else printf("Arrivals: poisson, %d ms per load level\n", duration);
+  printf("Producers: %d\n", producers);
+  printf("Submission queue: %s (capacity %d)\n", lockfree ? "lock-free ring" : "mutex + condvar", queue_capacity);
+  printf("Micro-batch: up to %d requests or %d us\n", max_batch, max_wait_us);
+  printf("  %10s %9s %12s %10s %10s %10s %10s %10s\n",
+         "offered/s", "requests", "achieved/s", "mean batch", "p50 (ms)", "p99 (ms)", "p999 (ms)", "max (ms)");
+  for (const LoadResult &r : results) {
+    printf("  %10.0f %9d %12.1f %10.2f %10.3f %10.3f %10.3f %10.3f\n",
+           r.offered_rate, r.requests, r.throughput, r.mean_batch, r.p50, r.p99, r.p999, r.max);
+  }
+  printf("============================================\n\n");
+  print_environment();
+
+  // clean up
+  free(pool);
+}
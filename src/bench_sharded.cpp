@@ -0,0 +1,473 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for CPU lists and timing results
+#include <string> // for sysfs paths
+#include <cmath> // for sqrt in standard deviation calculation
+#include <iostream> // for cout/cerr
+#include <fstream> // for reading sysfs
+#include <cstring> // for memcpy
+#include <algorithm> // for std::min, std::max
+#include <sched.h> // for sched_setaffinity
+#include <signal.h> // for kill
+#include <pthread.h> // for the process-shared barrier
+#include <sys/mman.h> // for memfd_create and mmap
+#include <sys/wait.h> // for waitpid
+#include <time.h> // for clock_gettime
+#include <unistd.h> // for fork and ftruncate
+#include <omp.h> // for omp_set_num_threads
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the batched OpenBLAS paths
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Shard a batch across one worker process per NUMA node on the CPU.
+//
+// The pristine batch lives in one memfd mapping shared by all processes. Each worker pins itself
+// to the CPUs of its node, copies its contiguous slice of the batch into node-local memory and
+// solves it with its own OpenMP team. Iterations are synchronised by a process-shared barrier
+// and timed with CLOCK_MONOTONIC, so an iteration lasts from the first start to the last finish.
+// The same batch is also solved by a single process spanning every node for comparison.
+//
+// The launcher itself never enters an OpenMP region: generation, the single-process baseline
+// and every worker run in forked children, because the GNU OpenMP runtime does not survive a
+// fork once its thread pool exists.
+
+// Parse a sysfs CPU list such as "0-3,8-11".
+std::vector<int> parse_cpu_list(const std::string &text) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find(',', pos);
+    if (end == std::string::npos) end = text.size();
+    std::string item = text.substr(pos, end - pos);
+    size_t dash = item.find('-');
+    if (!item.empty() && item[0] >= '0' && item[0] <= '9') {
+      int first = std::stoi(item);
+      int last = (dash == std::string::npos) ? first : std::stoi(item.substr(dash + 1));
+      for (int c = first; c <= last; ++c) cpus.push_back(c);
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+
+// CPUs of every NUMA node that this process may run on. Without sysfs NUMA information the
+// whole affinity mask is one node.
+std::vector<std::vector<int>> numa_nodes() {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  sched_getaffinity(0, sizeof(allowed), &allowed);
+
+  std::vector<std::vector<int>> nodes;
+  for (int node = 0; ; ++node) {
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!in) break;
+    std::string line;
+    std::getline(in, line);
+    std::vector<int> cpus;
+    for (int c : parse_cpu_list(line)) {
+      if (c < CPU_SETSIZE && CPU_ISSET(c, &allowed)) cpus.push_back(c);
+    }
+    if (!cpus.empty()) nodes.push_back(cpus);
+  }
+
+  if (nodes.empty()) {
+    std::vector<int> cpus;
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+      if (CPU_ISSET(c, &allowed)) cpus.push_back(c);
+    }
+    nodes.push_back(cpus);
+  }
+  return nodes;
+}
+
+// Split the CPUs into the requested number of groups without letting a group straddle a node
+// boundary it does not have to: fewer shards than nodes take whole neighbouring nodes, more
+// shards are dealt to the nodes by CPUs per shard and each node is cut evenly.
+std::vector<std::vector<int>> make_shards(const std::vector<std::vector<int>> &nodes, int shards) {
+  int node_count = (int)nodes.size();
+  if (shards <= 0 || shards == node_count) return nodes;
+  std::vector<std::vector<int>> groups;
+
+  if (shards < node_count) {
+    for (int s = 0; s < shards; ++s) {
+      std::vector<int> group;
+      for (int n = node_count * s / shards; n < node_count * (s + 1) / shards; ++n) {
+        group.insert(group.end(), nodes[n].begin(), nodes[n].end());
+      }
+      groups.push_back(group);
+    }
+    return groups;
+  }
+
+  // one shard per node, then every extra one to the node with the most CPUs per shard
+  int all_cpus = 0;
+  for (const auto &node : nodes) all_cpus += (int)node.size();
+  shards = std::min(shards, all_cpus);
+  std::vector<int> per_node(node_count, 1);
+  for (int extra = shards - node_count; extra > 0; --extra) {
+    int best = -1;
+    for (int n = 0; n < node_count; ++n) {
+      if (per_node[n] >= (int)nodes[n].size()) continue;
+      if (best < 0 || nodes[n].size() * per_node[best] > nodes[best].size() * per_node[n]) best = n;
+    }
+    per_node[best]++;
+  }
+  for (int n = 0; n < node_count; ++n) {
+    size_t size = nodes[n].size();
+    for (int k = 0; k < per_node[n]; ++k) {
+      size_t first = size * k / per_node[n], last = size * (k + 1) / per_node[n];
+      groups.push_back(std::vector<int>(nodes[n].begin() + first, nodes[n].begin() + last));
+    }
+  }
+  return groups;
+}
+
+double monotonic_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+// Shared between the launcher and its children; followed by the timings and the batch.
+struct SharedHeader {
+  pthread_barrier_t barrier;
+  int generated;
+};
+
+// Fork, run body in the child and wait for it. Returns false if the child failed.
+template <typename Body>
+bool run_in_child(Body body) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    body();
+    fflush(stdout);
+    _exit(0);
+  }
+  int status = 0;
+  if (pid < 0 || waitpid(pid, &status, 0) < 0) return false;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Pin the calling process to cpus and size its OpenMP team accordingly.
+void pin_to_cpus(const std::vector<int> &cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int c : cpus) CPU_SET(c, &set);
+  sched_setaffinity(0, sizeof(set), &set);
+  omp_set_num_threads((int)cpus.size());
+}
+
+// Solve a contiguous slice of the batch for every iteration, recording start and end times.
+void solve_slice(const CpuSolverLayout &layout, const float *pristine, int first, int count,
+                 int warmup, int iterations, pthread_barrier_t *barrier,
+                 double *start_ms, double *end_ms, int stride) {
+  size_t size_A = layout.strideA * (size_t)count;
+
+  // node-local buffers: first touched after pinning
+  float *hA = (float*)malloc(sizeof(float) * (size_A ? size_A : 1));
+  float *hW = (float*)malloc(sizeof(float) * (layout.strideW * count + 1));
+  float *hU = (float*)malloc(sizeof(float) * ((layout.strideU ? layout.strideU : 1) * count + 1));
+  float *hVT = (float*)malloc(sizeof(float) * ((layout.strideVT ? layout.strideVT : 1) * count + 1));
+
+  for (int iter = -warmup; iter < iterations; ++iter) {
+    // Copy the original matrices for this iteration
+    memcpy(hA, pristine + first * layout.strideA, sizeof(float) * size_A);
+
+    if (barrier) pthread_barrier_wait(barrier);
+    double start = monotonic_ms();
+    cpu_solver_batched(layout, hA, hW, hU, hVT, NULL, count);
+    double end = monotonic_ms();
+
+    if (iter >= 0) {
+      start_ms[iter * stride] = start;
+      end_ms[iter * stride] = end;
+    }
+    if (barrier) pthread_barrier_wait(barrier);
+  }
+
+  free(hA);
+  free(hW);
+  free(hU);
+  free(hVT);
+}
+
+void statistics(const std::vector<double> &timings, double *avg, double *std_dev) {
+  *avg = 0.0;
+  for (double t : timings) *avg += t;
+  *avg /= timings.size();
+  *std_dev = 0.0;
+  for (double t : timings) *std_dev += (t - *avg) * (t - *avg);
+  *std_dev = sqrt(*std_dev / timings.size());
+}
+
+// Compare one multi-socket process with one pinned worker process per NUMA node.
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_sharded");
+
+  program.add_argument("--solver")
+      .help("Solver path (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyevd"));
+
+  program.add_argument("-m", "--rows")
+      .help("Number of rows (M, sgesvd only)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N, or number of columns for sgesvd)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-b", "--batch-count")
+      .help("Batch count")
+      .default_value(1024)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of iterations for timing")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("--warmup-iterations")
+      .help("Untimed iterations before timing (kept in step across the workers)")
+      .default_value(2)
+      .scan<'i', int>();
+
+  program.add_argument("--shards")
+      .help("Number of worker processes (0: one per NUMA node)")
+      .default_value(0)
+      .scan<'i', int>();
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str = program.get<std::string>("--solver");
+  int M = program.get<int>("--rows");
+  int N = program.get<int>("--size");
+  int batch_count = program.get<int>("--batch-count");
+  int random_seed = program.get<int>("--random-seed");
+  int iterations = program.get<int>("--iterations");
+  int warmup = program.get<int>("--warmup-iterations");
+  int shard_count = program.get<int>("--shards");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+
+  CpuSolver solver;
+  if (!parse_cpu_solver(solver_str, &solver)) {
+    std::cerr << "Unknown solver: " << solver_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (iterations < 1) iterations = 1;
+  if (warmup < 0) warmup = 0;
+  if (batch_count < 1) batch_count = 1;
+
+  CpuSolverLayout layout = make_cpu_solver_layout(solver, M, N, M);
+  M = layout.M;
+
+  std::vector<std::vector<int>> nodes = numa_nodes();
+  std::vector<std::vector<int>> shards = make_shards(nodes, shard_count);
+  int S = (int)shards.size();
+  int all_cpus = 0;
+  for (const auto &node : nodes) all_cpus += (int)node.size();
+
+  // one shared mapping: header, baseline and shard timings, pristine batch
+  size_t timing_count = (size_t)iterations * (2 + 2 * S);
+  size_t size_A = layout.strideA * (size_t)batch_count;
+  size_t offset_timings = (sizeof(SharedHeader) + 63) / 64 * 64;
+  size_t offset_batch = (offset_timings + sizeof(double) * timing_count + 63) / 64 * 64;
+  size_t shared_bytes = offset_batch + sizeof(float) * size_A;
+
+  int fd = memfd_create("bench_sharded", 0);
+  if (fd < 0 || ftruncate(fd, shared_bytes) != 0) {
+    perror("memfd_create");
+    return 1;
+  }
+  char *shared = (char*)mmap(NULL, shared_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (shared == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  SharedHeader *header = (SharedHeader*)shared;
+  double *base_start = (double*)(shared + offset_timings);
+  double *base_end = base_start + iterations;
+  double *shard_start = base_end + iterations;            // [iteration][shard]
+  double *shard_end = shard_start + (size_t)iterations * S;
+  float *pristine = (float*)(shared + offset_batch);
+
+  pthread_barrierattr_t attr;
+  pthread_barrierattr_init(&attr);
+  pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  pthread_barrier_init(&header->barrier, &attr, S);
+  pthread_barrierattr_destroy(&attr);
+
+  // generate the pristine batch in a child (the spectrum generator uses OpenMP)
+  run_in_child([&]() {
+    float *hA;
+    if (solver == CpuSolver::sgesvd) {
+      if (spectrum == SpectrumKind::random) {
+        hA = create_general_matrices(M, N, layout.lda, layout.strideA, batch_count, random_seed);
+      } else {
+        hA = create_general_matrices_with_spectrum<float>(M, N, layout.lda, layout.strideA, batch_count,
+                                                           random_seed, spectrum, cond);
+      }
+    } else {
+      if (spectrum == SpectrumKind::random) {
+        hA = create_symmetric_matrices(N, layout.lda, layout.strideA, batch_count, random_seed);
+      } else {
+        hA = create_symmetric_matrices_with_spectrum<float>(N, layout.lda, layout.strideA, batch_count,
+                                                             random_seed, spectrum, cond);
+      }
+    }
+    memcpy(pristine, hA, sizeof(float) * size_A);
+    free(hA);
+    header->generated = 1;
+  });
+  if (!header->generated) {
+    std::cerr << "Matrix generation failed" << std::endl;
+    return 1;
+  }
+
+  // baseline: one process, every CPU, the whole batch
+  printf("Single process: %d threads on %zu NUMA node(s)...\n", all_cpus, nodes.size());
+  fflush(stdout);
+  bool ok = run_in_child([&]() {
+    std::vector<int> cpus;
+    for (const auto &node : nodes) cpus.insert(cpus.end(), node.begin(), node.end());
+    pin_to_cpus(cpus);
+    solve_slice(layout, pristine, 0, batch_count, warmup, iterations, NULL, base_start, base_end, 1);
+  });
+
+  // sharded: one pinned process per group, contiguous slices of the batch
+  printf("Sharded: %d worker process(es)...\n", S);
+  fflush(stdout);
+  std::vector<pid_t> workers;
+  for (int s = 0; s < S && ok; ++s) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      ok = false;
+      break;
+    }
+    if (pid == 0) {
+      int first = (int)((long)batch_count * s / S);
+      int last = (int)((long)batch_count * (s + 1) / S);
+      pin_to_cpus(shards[s]);
+      solve_slice(layout, pristine, first, last - first, warmup, iterations, &header->barrier,
+                  shard_start + s, shard_end + s, S);
+      _exit(0);
+    }
+    workers.push_back(pid);
+  }
+  // reap the workers as they finish: the siblings of a worker that dies (or was never forked)
+  // would wait on the barrier forever, so they are killed as soon as one fails
+  std::vector<bool> reaped(workers.size(), false);
+  bool killed = false;
+  for (size_t finished = 0; finished < workers.size(); ++finished) {
+    if (!ok && !killed) {
+      for (size_t w = 0; w < workers.size(); ++w) {
+        if (!reaped[w]) kill(workers[w], SIGKILL);
+      }
+      killed = true;
+    }
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      ok = false;
+      break;
+    }
+    for (size_t w = 0; w < workers.size(); ++w) {
+      if (workers[w] == pid) reaped[w] = true;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+  }
+  if (!ok) {
+    std::cerr << "A worker process failed" << std::endl;
+    return 1;
+  }
+
+  // per-iteration wall time: first start to last finish
+  std::vector<double> base_timings, shard_timings;
+  std::vector<double> shard_busy(S, 0.0);
+  for (int iter = 0; iter < iterations; ++iter) {
+    base_timings.push_back(base_end[iter] - base_start[iter]);
+    double first = shard_start[iter * S], last = shard_end[iter * S];
+    for (int s = 0; s < S; ++s) {
+      first = std::min(first, shard_start[iter * S + s]);
+      last = std::max(last, shard_end[iter * S + s]);
+      shard_busy[s] += shard_end[iter * S + s] - shard_start[iter * S + s];
+    }
+    shard_timings.push_back(last - first);
+  }
+  double base_avg, base_std, shard_avg, shard_std;
+  statistics(base_timings, &base_avg, &base_std);
+  statistics(shard_timings, &shard_avg, &shard_std);
+
+  // print timing results
+  printf("\n===== Performance Results (CPU - sharded processes) =====\n");
+  printf("Solver: %s\n", cpu_solver_name(solver));
+  if (solver == CpuSolver::sgesvd) printf("Matrix size: %d x %d\n", M, N);
+  else printf("Matrix size: %d x %d\n", N, N);
+  printf("Batch count: %d\n", batch_count);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
+  printf("NUMA nodes: %zu, CPUs: %d\n", nodes.size(), all_cpus);
+  printf("Warm-up iterations: %d\n", warmup);
+  printf("Timing iterations: %d\n", iterations);
+  printf("  %-16s %9s %9s %12s %12s %16s %8s\n",
+         "mode", "processes", "threads", "avg (ms)", "stddev (ms)", "matrices/s", "speedup");
+  printf("  %-16s %9d %9d %12.3f %12.3f %16.1f %7.2fx\n", "single process", 1, all_cpus,
+         base_avg, base_std, batch_count / (base_avg / 1000.0), 1.0);
+  printf("  %-16s %9d %9s %12.3f %12.3f %16.1f %7.2fx\n", "sharded", S, "per node",
+         shard_avg, shard_std, batch_count / (shard_avg / 1000.0),
+         (shard_avg > 0.0) ? base_avg / shard_avg : 0.0);
+  for (int s = 0; s < S; ++s) {
+    int first = (int)((long)batch_count * s / S);
+    int last = (int)((long)batch_count * (s + 1) / S);
+    printf("    shard %d: %zu CPUs (%d-%d), matrices %d-%d, avg solve %.3f ms\n",
+           s, shards[s].size(), shards[s].front(), shards[s].back(), first, last - 1,
+           shard_busy[s] / iterations);
+  }
+  printf("=========================================================\n\n");
+  print_environment();
+
+  // clean up
+  pthread_barrier_destroy(&header->barrier);
+  munmap(shared, shared_bytes);
+  close(fd);
+}
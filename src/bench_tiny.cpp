@@ -0,0 +1,199 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for samples
+#include <sstream> // for splitting the size list
+#include <iostream> // for cout/cerr
+#include <chrono> // for the clock overhead comparison
+#include <cstring> // for memcpy
+#include <algorithm> // for std::sort, std::max
+
+#include <argparse/argparse.hpp>
+
+#include "cpu_solvers.hpp" // for the OpenBLAS paths
+#include "matrix_gen.hpp" // for the random test matrices
+#include "tsc_timer.hpp" // for the calibrated cycle counter
+#include "telemetry.hpp" // for sorted_percentile
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Latency of single tiny solves (2 x 2 to 8 x 8) on one CPU thread.
+//
+// A solve of a tiny matrix takes well under a microsecond to a few microseconds, about what a
+// pair of high_resolution_clock reads costs, so the batch benches cannot resolve it. Here
+// every sample times --min-sample-us or more of back-to-back solves with the fenced cycle
+// counter, less the counter's own overhead. Every solve works on a fresh copy of the next
+// matrix of a pool (the solvers overwrite their input), and the same loop with the copy only
+// is timed as a baseline and subtracted, so the net time is the solve alone.
+
+struct TinyResult {
+  int N;
+  int repetitions;
+  float copy_ns;                    // median of the copy-only baseline
+  float p50_ns, p10_ns, p90_ns;     // net solve time
+};
+
+TinyResult measure_size(CpuSolver solver, int N, int pool_size, int random_seed, int samples,
+                        double min_sample_ns) {
+  CpuSolverLayout layout = make_cpu_solver_layout(solver, N, N, N);
+  float *pool = (solver == CpuSolver::sgesvd)
+                    ? create_general_matrices(N, N, layout.lda, layout.strideA, pool_size, random_seed)
+                    : create_symmetric_matrices(N, layout.lda, layout.strideA, pool_size, random_seed);
+  float *hA = (float*)malloc(sizeof(float) * layout.strideA);
+  float *hW = (float*)malloc(sizeof(float) * layout.strideW);
+  float *hU = (float*)malloc(sizeof(float) * (layout.strideU ? layout.strideU : 1));
+  float *hVT = (float*)malloc(sizeof(float) * (layout.strideVT ? layout.strideVT : 1));
+  float *work = (float*)malloc(sizeof(float) * layout.lwork);
+  lapack_int *iwork = (lapack_int*)malloc(sizeof(lapack_int) * (layout.liwork > 0 ? layout.liwork : 1));
+  size_t bytes = sizeof(float) * layout.strideA;
+
+  auto copy = [&](long long i) {
+    memcpy(hA, pool + (i % pool_size) * layout.strideA, bytes);
+    asm volatile("" ::: "memory");  // keep the copy
+  };
+  auto solve = [&](long long i) {
+    memcpy(hA, pool + (i % pool_size) * layout.strideA, bytes);
+    cpu_solver_one(layout, hA, hW, hU, hVT, 0, work, iwork);
+  };
+
+  // warm the caches and the branch predictors, then size the samples
+  for (int i = 0; i < 4 * pool_size; ++i) solve(i);
+  TinyResult result = {};
+  result.N = N;
+  result.repetitions = tsc_repetitions(solve, min_sample_ns);
+
+  // interleave solve and baseline samples so both see the same machine state
+  std::vector<float> solve_ns, copy_ns;
+  long long next = 0;
+  for (int s = 0; s < samples; ++s) {
+    solve_ns.push_back((float)tsc_sample_ns(solve, result.repetitions, next));
+    copy_ns.push_back((float)tsc_sample_ns(copy, result.repetitions, next));
+    next += result.repetitions;
+  }
+  std::sort(solve_ns.begin(), solve_ns.end());
+  std::sort(copy_ns.begin(), copy_ns.end());
+  result.copy_ns = sorted_percentile(copy_ns, 50.0);
+  result.p50_ns = std::max(0.0f, sorted_percentile(solve_ns, 50.0) - result.copy_ns);
+  result.p10_ns = std::max(0.0f, sorted_percentile(solve_ns, 10.0) - result.copy_ns);
+  result.p90_ns = std::max(0.0f, sorted_percentile(solve_ns, 90.0) - result.copy_ns);
+
+  free(pool);
+  free(hA);
+  free(hW);
+  free(hU);
+  free(hVT);
+  free(work);
+  free(iwork);
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("bench_tiny");
+
+  program.add_argument("--solver")
+      .help("Solver path (ssyev, ssyevd, sgesvd)")
+      .default_value(std::string("ssyevd"));
+
+  program.add_argument("--sizes")
+      .help("Space-separated matrix sizes (N x N)")
+      .default_value(std::string("2 3 4 5 6 7 8"));
+
+  program.add_argument("--pool")
+      .help("Number of distinct matrices cycled through per size")
+      .default_value(64)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-s", "--samples")
+      .help("Number of timed samples per size")
+      .default_value(200)
+      .scan<'i', int>();
+
+  program.add_argument("--min-sample-us")
+      .help("Minimum duration of one sample in microseconds; sets the repetitions per sample")
+      .default_value(20.0f)
+      .scan<'f', float>();
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string solver_str = program.get<std::string>("--solver");
+  std::string sizes_str = program.get<std::string>("--sizes");
+  int pool_size = program.get<int>("--pool");
+  int random_seed = program.get<int>("--random-seed");
+  int samples = program.get<int>("--samples");
+  float min_sample_us = program.get<float>("--min-sample-us");
+
+  CpuSolver solver;
+  if (!parse_cpu_solver(solver_str, &solver)) {
+    std::cerr << "Unknown solver: " << solver_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::vector<int> sizes;
+  std::istringstream size_list(sizes_str);
+  for (int N; size_list >> N;) {
+    if (N < 1) {
+      std::cerr << "Invalid size: " << N << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+    sizes.push_back(N);
+  }
+  if (sizes.empty()) {
+    std::cerr << "No sizes given" << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (pool_size < 1) pool_size = 1;
+  if (samples < 1) samples = 1;
+
+  // rate and overhead of the counter, and for comparison the cost of a pair of clock reads
+  tsc_calibrate();
+  double clock_pair_ns = 1e30;
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t start = tsc_begin();
+    auto a = std::chrono::high_resolution_clock::now();
+    auto b = std::chrono::high_resolution_clock::now();
+    uint64_t stop = tsc_end();
+    asm volatile("" :: "r"(&a), "r"(&b) : "memory");
+    clock_pair_ns = std::min(clock_pair_ns, tsc_to_ns((double)tsc_elapsed(start, stop)));
+  }
+
+  std::vector<TinyResult> results;
+  for (int N : sizes) {
+    results.push_back(measure_size(solver, N, pool_size, random_seed, samples, min_sample_us * 1e3));
+    printf("  N = %d: %.1f ns\n", N, results.back().p50_ns);
+    fflush(stdout);
+  }
+
+  // print results
+  printf("\n===== Tiny Solve Latency (CPU - OpenBLAS, 1 thread) =====\n");
+  printf("Solver: %s\n", cpu_solver_name(solver));
+  printf("Counter: %.1f MHz, %s, resolution %.2f ns, overhead %llu ticks (%.1f ns, subtracted)\n",
+         tsc_ticks_per_ms() / 1e3, tsc_invariant() ? "invariant" : "NOT invariant",
+         tsc_to_ns(1.0), (unsigned long long)tsc_overhead(), tsc_to_ns((double)tsc_overhead()));
+  printf("high_resolution_clock pair: %.1f ns\n", clock_pair_ns);
+  printf("Samples per size: %d of >= %.1f us\n", samples, min_sample_us);
+  printf("  %4s %8s %12s %12s %12s %12s %14s\n", "N", "reps", "copy (ns)", "p10 (ns)", "p50 (ns)", "p90 (ns)", "solves/s");
+  for (const TinyResult &r : results) {
+    printf("  %4d %8d %12.1f %12.1f %12.1f %12.1f %14.0f\n", r.N, r.repetitions, r.copy_ns,
+           r.p10_ns, r.p50_ns, r.p90_ns, (r.p50_ns > 0.0f) ? 1e9 / r.p50_ns : 0.0);
+  }
+  printf("=========================================================\n\n");
+  print_environment();
+
+  return 0;
+}
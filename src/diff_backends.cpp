@@ -0,0 +1,347 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for per-matrix results
+#include <cmath> // for fabs
+#include <iostream> // for cout/cerr
+#include <string> // for backend names
+
+#include <argparse/argparse.hpp>
+
+#include "backends.hpp" // for the solver backends of this build
+#include "matrix_gen.hpp" // for spectrum-controlled matrices
+#include "result_diff.hpp" // for canonicalisation and the per-matrix comparison
+#include "env_fingerprint.hpp" // for the environment of the results
+
+// Example: Run two backends on the same seeded batch and compare their eigen/singular values and
+// vectors. Backends: openblas (LAPACKE ssyev / sgesvd), native (CPU Jacobi), rocsolver (syevj /
+// gesvdj strided batched); a build without OpenBLAS or ROCm has only the others. lapack:<provider>
+// loads a LAPACK library at run time, e.g. --reference lapack:reference --candidate lapack:openblas.
+//
+// Exit status: 0 when every matrix passes, 1 when any matrix fails or does not converge.
+
+// V (n x k, column j = right vector j) from V' (k x n)
+void transpose_vt(int k, int n, const float *VT, int ldvt, float *V, int ldv) {
+  for (int j = 0; j < k; ++j) {
+    for (int i = 0; i < n; ++i) V[i + (size_t)j * ldv] = VT[j + (size_t)i * ldvt];
+  }
+}
+
+// Eigenvalues (ascending, strideW = N) and eigenvectors (same layout as A) of the whole batch.
+// Returns the solve time in ms, without the copies.
+float solve_eigen(const SolverBackend &backend, int N, const float *hA, int lda, size_t strideA,
+                  int batch_count, float tolerance, int max_sweeps,
+                  float *W, float *V, int *info) {
+  size_t size_A = strideA * (size_t)batch_count;
+  BatchShape shape = {N, N, lda, strideA, batch_count, tolerance, max_sweeps};
+
+  float *dA = (float*)backend.allocate(sizeof(float) * size_A);
+  float *dW = (float*)backend.allocate(sizeof(float) * N * batch_count);
+  int *dInfo = (int*)backend.allocate(sizeof(int) * batch_count);
+  backend.copy_to_backend(dA, hA, sizeof(float) * size_A);
+
+  auto start = backend_timer_start(backend);
+  backend.solve_eigen(shape, dA, dW, dInfo);
+  float time_ms = backend_timer_stop(backend, start);
+
+  backend.copy_to_host(V, dA, sizeof(float) * size_A);
+  backend.copy_to_host(W, dW, sizeof(float) * N * batch_count);
+  backend.copy_to_host(info, dInfo, sizeof(int) * batch_count);
+
+  backend.release(dA);
+  backend.release(dW);
+  backend.release(dInfo);
+  return time_ms;
+}
+
+// Singular values (descending, strideS = k), U (M x k, ldu = M) and V (N x k, ldv = N) of the
+// whole batch, k = min(M, N). Returns the solve time in ms, without the copies.
+float solve_svd(const SolverBackend &backend, int M, int N, const float *hA, int lda, size_t strideA,
+                int batch_count, float tolerance, int max_sweeps,
+                float *S, float *U, float *V, int *info) {
+  int k = (M < N) ? M : N;
+  size_t size_A = strideA * (size_t)batch_count;
+  size_t strideU = (size_t)M * k, strideV = (size_t)N * k, strideVT = (size_t)k * N;
+  BatchShape shape = {M, N, lda, strideA, batch_count, tolerance, max_sweeps};
+  float *VT = (float*)malloc(sizeof(float) * strideVT * batch_count);
+
+  float *dA = (float*)backend.allocate(sizeof(float) * size_A);
+  float *dS = (float*)backend.allocate(sizeof(float) * k * batch_count);
+  float *dU = (float*)backend.allocate(sizeof(float) * strideU * batch_count);
+  float *dVT = (float*)backend.allocate(sizeof(float) * strideVT * batch_count);
+  int *dInfo = (int*)backend.allocate(sizeof(int) * batch_count);
+  backend.copy_to_backend(dA, hA, sizeof(float) * size_A);
+
+  auto start = backend_timer_start(backend);
+  backend.solve_svd(shape, dA, dS, dU, dVT, dInfo);
+  float time_ms = backend_timer_stop(backend, start);
+
+  backend.copy_to_host(S, dS, sizeof(float) * k * batch_count);
+  backend.copy_to_host(U, dU, sizeof(float) * strideU * batch_count);
+  backend.copy_to_host(VT, dVT, sizeof(float) * strideVT * batch_count);
+  backend.copy_to_host(info, dInfo, sizeof(int) * batch_count);
+
+  #pragma omp parallel for
+  for (int b = 0; b < batch_count; ++b) {
+    transpose_vt(k, N, VT + b * strideVT, k, V + b * strideV, N);
+  }
+
+  backend.release(dA);
+  backend.release(dS);
+  backend.release(dU);
+  backend.release(dVT);
+  backend.release(dInfo);
+  free(VT);
+  return time_ms;
+}
+
+// Compare two solver backends on the same batch and gate on the differences.
+int main(int argc, char *argv[]) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("diff_backends");
+
+  program.add_argument("-p", "--problem")
+      .help("Problem to compare (eigen, svd)")
+      .default_value(std::string("eigen"));
+
+  program.add_argument("--reference")
+      .help("Reference backend (" + backend_names() + ", lapack:<provider>)")
+      .default_value(std::string(solver_backends().front()->name));
+
+  program.add_argument("--candidate")
+      .help("Candidate backend (" + backend_names() + ", lapack:<provider>)")
+      .default_value(std::string(solver_backends().back()->name));
+
+  program.add_argument("-m", "--rows")
+      .help("Number of rows (M, svd only)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N for eigen, number of columns for svd)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-b", "--batch-count")
+      .help("Batch count")
+      .default_value(2)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-t", "--tolerance")
+      .help("Tolerance for the Jacobi backends (<= 0: machine precision)")
+      .default_value(0.0f)
+      .scan<'f', float>();
+
+  program.add_argument("-j", "--max-sweeps")
+      .help("Maximum number of sweeps for the Jacobi backends")
+      .default_value(100)
+      .scan<'i', int>();
+
+  program.add_argument("--spectrum")
+      .help("Spectrum of the generated matrices (random, geometric, arithmetic, clustered, repeated)")
+      .default_value(std::string("random"));
+
+  program.add_argument("--cond")
+      .help("Condition number of the generated matrices (ignored for random)")
+      .default_value(1000.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--value-threshold")
+      .help("Value threshold in units of N * machine epsilon * max |value|")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--angle-threshold")
+      .help("Subspace angle threshold in units of N * machine epsilon * max |value| / gap")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  program.add_argument("--cluster-tol")
+      .help("Values closer than this times max |value| are compared as one subspace")
+      .default_value(1e-3f)
+      .scan<'f', float>();
+
+  program.add_argument("--failures-only")
+      .help("Only list the matrices that fail")
+      .default_value(false)
+      .implicit_value(true);
+
+  // 引数の解析
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  std::string problem = program.get<std::string>("--problem");
+  std::string reference = program.get<std::string>("--reference");
+  std::string candidate = program.get<std::string>("--candidate");
+  int M = program.get<int>("--rows");
+  int N = program.get<int>("--size");
+  int batch_count = program.get<int>("--batch-count");
+  int random_seed = program.get<int>("--random-seed");
+  float tolerance = program.get<float>("--tolerance");
+  int max_sweeps = program.get<int>("--max-sweeps");
+  std::string spectrum_str = program.get<std::string>("--spectrum");
+  float cond = program.get<float>("--cond");
+  bool failures_only = program.get<bool>("--failures-only");
+
+  DiffParams params;
+  params.value_factor = program.get<float>("--value-threshold");
+  params.angle_factor = program.get<float>("--angle-threshold");
+  params.cluster_tol = program.get<float>("--cluster-tol");
+
+  SpectrumKind spectrum;
+  if (!parse_spectrum_kind(spectrum_str, &spectrum)) {
+    std::cerr << "Unknown spectrum: " << spectrum_str << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  bool svd = (problem == "svd");
+  if (!svd && problem != "eigen") {
+    std::cerr << "Unknown problem: " << problem << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+  if (!svd) M = N;
+
+  std::string backend_error;
+  const SolverBackend *reference_backend = find_backend(reference, &backend_error);
+  const SolverBackend *candidate_backend = reference_backend ? find_backend(candidate, &backend_error) : NULL;
+  if (!reference_backend || !candidate_backend) {
+    print_backend_error(reference_backend ? candidate : reference, backend_error);
+    std::cerr << program;
+    return 1;
+  }
+
+  int k = (M < N) ? M : N;
+  int max_mn = (M < N) ? N : M;
+  int lda = M;
+  size_t strideA = (size_t)lda * N;
+
+  float *hA;
+  if (svd) {
+    if (spectrum == SpectrumKind::random) {
+      hA = create_general_matrices(M, N, lda, strideA, batch_count, random_seed);
+    } else {
+      hA = create_general_matrices_with_spectrum<float>(M, N, lda, strideA, batch_count, random_seed,
+                                                         spectrum, cond);
+    }
+  } else {
+    if (spectrum == SpectrumKind::random) {
+      hA = create_symmetric_matrices(N, lda, strideA, batch_count, random_seed);
+    } else {
+      hA = create_symmetric_matrices_with_spectrum<float>(N, lda, strideA, batch_count, random_seed,
+                                                           spectrum, cond);
+    }
+  }
+
+  // outputs of both backends
+  size_t strideW = k;
+  size_t strideU = svd ? (size_t)M * k : strideA;
+  size_t strideV = (size_t)N * k;
+  float *W_ref = (float*)malloc(sizeof(float) * strideW * batch_count);
+  float *W_cand = (float*)malloc(sizeof(float) * strideW * batch_count);
+  float *U_ref = (float*)malloc(sizeof(float) * strideU * batch_count);
+  float *U_cand = (float*)malloc(sizeof(float) * strideU * batch_count);
+  float *V_ref = svd ? (float*)malloc(sizeof(float) * strideV * batch_count) : NULL;
+  float *V_cand = svd ? (float*)malloc(sizeof(float) * strideV * batch_count) : NULL;
+  std::vector<int> info_ref(batch_count), info_cand(batch_count);
+
+  float time_ref, time_cand;
+  if (svd) {
+    time_ref = solve_svd(*reference_backend, M, N, hA, lda, strideA, batch_count, tolerance, max_sweeps,
+                         W_ref, U_ref, V_ref, info_ref.data());
+    time_cand = solve_svd(*candidate_backend, M, N, hA, lda, strideA, batch_count, tolerance, max_sweeps,
+                          W_cand, U_cand, V_cand, info_cand.data());
+  } else {
+    time_ref = solve_eigen(*reference_backend, N, hA, lda, strideA, batch_count, tolerance, max_sweeps,
+                           W_ref, U_ref, info_ref.data());
+    time_cand = solve_eigen(*candidate_backend, N, hA, lda, strideA, batch_count, tolerance, max_sweeps,
+                            W_cand, U_cand, info_cand.data());
+  }
+
+  // compare every matrix in parallel
+  std::vector<MatrixDiff> diffs(batch_count);
+  size_t lwork = subspace_angle_workspace_size(max_mn, k);
+
+  #pragma omp parallel
+  {
+    // Allocate thread-local workspace
+    float *thread_work = (float*)malloc(sizeof(float) * lwork);
+
+    #pragma omp for
+    for (int b = 0; b < batch_count; ++b) {
+      if (svd) {
+        diffs[b] = diff_svd(M, N,
+                            W_ref + b * strideW, U_ref + b * strideU, M, V_ref + b * strideV, N,
+                            info_ref[b],
+                            W_cand + b * strideW, U_cand + b * strideU, M, V_cand + b * strideV, N,
+                            info_cand[b], params, thread_work);
+      } else {
+        diffs[b] = diff_eigen(N,
+                              W_ref + b * strideW, U_ref + b * strideU, lda, info_ref[b],
+                              W_cand + b * strideW, U_cand + b * strideU, lda, info_cand[b],
+                              params, thread_work);
+      }
+    }
+
+    // Free thread-local workspace
+    free(thread_work);
+  }
+
+  // print the comparison
+  int failures = 0;
+  MatrixDiff worst = {};
+  for (const MatrixDiff &d : diffs) {
+    if (!d.pass) failures++;
+    if (!(d.value_error / d.value_bound <= worst.value_error / worst.value_bound)) {
+      worst.value_error = d.value_error;
+      worst.value_bound = d.value_bound;
+    }
+    if (!(d.angle_ratio <= worst.angle_ratio)) worst.angle_ratio = d.angle_ratio;
+    if (!(d.angle <= worst.angle)) worst.angle = d.angle;
+  }
+
+  printf("\n===== Backend Comparison =====\n");
+  if (svd) printf("Problem: svd, %d x %d\n", M, N);
+  else printf("Problem: eigen, %d x %d\n", N, N);
+  printf("Reference: %s, candidate: %s\n", reference.c_str(), candidate.c_str());
+  printf("Batch count: %d\n", batch_count);
+  printf("Solve time: reference %.3f ms, candidate %.3f ms\n", time_ref, time_cand);
+  if (spectrum == SpectrumKind::random) {
+    printf("Spectrum: random\n");
+  } else {
+    printf("Spectrum: %s (cond %.1e)\n", spectrum_kind_name(spectrum), cond);
+  }
+  printf("Thresholds: value %g, angle %g, cluster tolerance %.1e\n",
+         params.value_factor, params.angle_factor, params.cluster_tol);
+  print_diff_header();
+  for (int b = 0; b < batch_count; ++b) {
+    if (!failures_only || !diffs[b].pass) print_matrix_diff(b, diffs[b]);
+  }
+  printf("Worst value error: %.3e (bound %.3e)\n", worst.value_error, worst.value_bound);
+  printf("Worst subspace angle: sin %.3e, %.3f of its bound\n", worst.angle, worst.angle_ratio);
+  printf("Result: %s (%d of %d matrices failed)\n", failures ? "FAIL" : "PASS", failures, batch_count);
+  printf("==============================\n\n");
+  print_environment();
+
+  // clean up
+  free(hA);
+  free(W_ref);
+  free(W_cand);
+  free(U_ref);
+  free(U_cand);
+  free(V_ref);
+  free(V_cand);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,788 @@
+#include <stdio.h>   // for printf
+#include <stdlib.h> // for malloc
+#include <vector> // for jobs and timing results
+#include <algorithm> // for min_element
+#include <omp.h> // for the thread counts of the tune grid
+#include <chrono> // for the warm-up clock
+#include <iostream> // for cout/cerr
+#include <fstream> // for the configuration file
+#include <sstream> // for splitting lists and configuration lines
+#include <string> // for routine and backend names
+
+#include <argparse/argparse.hpp>
+
+#include "backends.hpp" // for the solver backends of this build
+#include "routine_registry.hpp" // for the routines
+#include "solve_batched.hpp" // for the tune table and the tuned dispatch
+#include "matrix_gen.hpp" // for the random test matrices
+#include "flops.hpp" // for the flop counts
+#include "env_fingerprint.hpp" // for the environment of the results
+#ifdef BENCH_HAVE_OPENBLAS
+#include "validate_host.hpp" // for validating the tune candidates
+#endif
+
+// Example: One driver for the solver routines on every backend of the build. Runs one
+// configuration from the command line or a list of configurations from a file in one process, so
+// the backends are initialised once and can be compared side by side.
+//
+//   solverbench syev --backend "openblas native" -n 32 -b 1000
+//   solverbench syev --backend native --isa avx2 -n 32 -b 1000
+//   solverbench syevd --backend "openblas lapack:reference" -n 64 -b 100
+//   solverbench gesvd --backend "lapack:openblas lapack:reference" -m 64 -n 32 -b 100
+//   solverbench run configs.txt     (one "<routine> <options>" per line, # for comments)
+//   solverbench tune --shapes "16 32 64x32" --batches "16 256" -o solverbench.table
+//   solverbench syev --backend "tuned openblas" --table solverbench.table -n 24 -b 100
+//   solverbench list
+
+// First call, time-based warm-up and timed iterations. reset restores the input (untimed), solve
+// runs the routine once.
+template <typename Reset, typename Solve>
+void time_routine(const RoutineConfig &config, const SolverBackend &backend, Reset reset, Solve solve,
+                  RoutineTimes *times) {
+  reset();
+  auto start = backend_timer_start(backend);
+  solve();
+  times->first_ms = backend_timer_stop(backend, start);
+
+  auto warmup_start = std::chrono::steady_clock::now();
+  float warmup_elapsed = 0.0f;
+  times->warmup_count = 0;
+  while (warmup_elapsed < config.warmup_time) {
+    reset();
+    solve();
+    backend.synchronize();
+    times->warmup_count++;
+    warmup_elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - warmup_start).count();
+  }
+
+  for (int iter = 0; iter < config.iterations; ++iter) {
+    reset();
+    start = backend_timer_start(backend);
+    solve();
+    times->timings.push_back(backend_timer_stop(backend, start));
+  }
+}
+
+int count_failures(const SolverBackend &backend, const int *dInfo, int batch_count) {
+  std::vector<int> info(batch_count);
+  backend.copy_to_host(info.data(), dInfo, sizeof(int) * batch_count);
+  int failures = 0;
+  for (int v : info) failures += (v != 0);
+  return failures;
+}
+
+// syev / syevd: eigenvalues and eigenvectors of symmetric N x N matrices, by implicit QR
+// (solve_eigen) and by divide and conquer (solve_eigen_dc)
+double syev_routine_flops(int, int N) {
+  return ssyev_flops(N);
+}
+
+double syevd_routine_flops(int, int N) {
+  return ssyevd_flops(N);
+}
+
+bool run_eigen(const RoutineConfig &config, const SolverBackend &backend,
+               void (*solve)(const BatchShape &, float *, float *, int *), RoutineTimes *times) {
+  if (!solve) return false;
+  int N = config.N, lda = N;
+  size_t strideA = (size_t)lda * N;
+  size_t size_A = strideA * config.batch_count;
+  BatchShape shape = {N, N, lda, strideA, config.batch_count, config.tolerance, config.max_sweeps};
+  float *hA = create_symmetric_matrices(N, lda, strideA, config.batch_count, config.random_seed);
+
+  float *dA = (float*)backend.allocate(sizeof(float) * size_A);
+  float *dW = (float*)backend.allocate(sizeof(float) * N * config.batch_count);
+  int *dInfo = (int*)backend.allocate(sizeof(int) * config.batch_count);
+
+  time_routine(config, backend,
+               [&]() { backend.copy_to_backend(dA, hA, sizeof(float) * size_A); },
+               [&]() { solve(shape, dA, dW, dInfo); },
+               times);
+  times->failures = count_failures(backend, dInfo, config.batch_count);
+#ifdef BENCH_HAVE_OPENBLAS
+  if (config.validate_threshold > 0.0f) {
+    // one more solve of the pristine batch, checked on the host
+    backend.copy_to_backend(dA, hA, sizeof(float) * size_A);
+    solve(shape, dA, dW, dInfo);
+    backend.synchronize();
+    float *hV = (float*)malloc(sizeof(float) * size_A);
+    float *hW = (float*)malloc(sizeof(float) * N * config.batch_count);
+    backend.copy_to_host(hV, dA, sizeof(float) * size_A);
+    backend.copy_to_host(hW, dW, sizeof(float) * N * config.batch_count);
+    EigenValidation validation = validate_eigen_host(N, hA, lda, strideA, hV, lda, strideA, hW, N,
+                                                     times->failures, config.batch_count,
+                                                     config.validate_threshold);
+    times->validation_failures = validation.residual.failures + validation.orthogonality.failures;
+    free(hV);
+    free(hW);
+  }
+#endif
+
+  backend.release(dA);
+  backend.release(dW);
+  backend.release(dInfo);
+  free(hA);
+  return true;
+}
+
+bool run_syev(const RoutineConfig &config, const SolverBackend &backend, RoutineTimes *times) {
+  return run_eigen(config, backend, backend.solve_eigen, times);
+}
+
+bool run_syevd(const RoutineConfig &config, const SolverBackend &backend, RoutineTimes *times) {
+  return run_eigen(config, backend, backend.solve_eigen_dc, times);
+}
+
+static const Routine syev_routine = {
+    "syev", "Symmetric eigenvalues and eigenvectors (N x N, float)", true, syev_routine_flops, run_syev};
+BENCH_REGISTER_ROUTINE(syev_routine);
+
+static const Routine syevd_routine = {
+    "syevd", "Symmetric eigenvalues and eigenvectors, divide and conquer (N x N, float)", true,
+    syevd_routine_flops, run_syevd};
+BENCH_REGISTER_ROUTINE(syevd_routine);
+
+// gesvd: economy-size SVD of general M x N matrices
+double gesvd_routine_flops(int M, int N) {
+  return sgesvd_economy_flops(M, N);
+}
+
+bool run_gesvd(const RoutineConfig &config, const SolverBackend &backend, RoutineTimes *times) {
+  if (!backend.solve_svd) return false;
+  int M = config.M, N = config.N, lda = M;
+  int k = (M < N) ? M : N;
+  size_t strideA = (size_t)lda * N;
+  size_t size_A = strideA * config.batch_count;
+  BatchShape shape = {M, N, lda, strideA, config.batch_count, config.tolerance, config.max_sweeps};
+  float *hA = create_general_matrices<float>(M, N, lda, strideA, config.batch_count, config.random_seed);
+
+  float *dA = (float*)backend.allocate(sizeof(float) * size_A);
+  float *dS = (float*)backend.allocate(sizeof(float) * k * config.batch_count);
+  float *dU = (float*)backend.allocate(sizeof(float) * M * k * config.batch_count);
+  float *dVT = (float*)backend.allocate(sizeof(float) * k * N * config.batch_count);
+  int *dInfo = (int*)backend.allocate(sizeof(int) * config.batch_count);
+
+  time_routine(config, backend,
+               [&]() { backend.copy_to_backend(dA, hA, sizeof(float) * size_A); },
+               [&]() { backend.solve_svd(shape, dA, dS, dU, dVT, dInfo); },
+               times);
+  times->failures = count_failures(backend, dInfo, config.batch_count);
+#ifdef BENCH_HAVE_OPENBLAS
+  if (config.validate_threshold > 0.0f) {
+    // one more solve of the pristine batch, checked on the host
+    size_t size_S = (size_t)k * config.batch_count;
+    size_t size_U = (size_t)M * k * config.batch_count, size_VT = (size_t)k * N * config.batch_count;
+    backend.copy_to_backend(dA, hA, sizeof(float) * size_A);
+    backend.solve_svd(shape, dA, dS, dU, dVT, dInfo);
+    backend.synchronize();
+    float *hS = (float*)malloc(sizeof(float) * size_S);
+    float *hU = (float*)malloc(sizeof(float) * size_U);
+    float *hVT = (float*)malloc(sizeof(float) * size_VT);
+    backend.copy_to_host(hS, dS, sizeof(float) * size_S);
+    backend.copy_to_host(hU, dU, sizeof(float) * size_U);
+    backend.copy_to_host(hVT, dVT, sizeof(float) * size_VT);
+    SvdValidation validation = validate_svd_host(M, N, hA, lda, strideA, hS, k, hU, M, (size_t)M * k,
+                                                 hVT, k, (size_t)k * N, times->failures, config.batch_count,
+                                                 config.validate_threshold);
+    times->validation_failures = validation.reconstruction.failures + validation.left_orthogonality.failures +
+                                 validation.right_orthogonality.failures;
+    free(hS);
+    free(hU);
+    free(hVT);
+  }
+#endif
+
+  backend.release(dA);
+  backend.release(dS);
+  backend.release(dU);
+  backend.release(dVT);
+  backend.release(dInfo);
+  free(hA);
+  return true;
+}
+
+static const Routine gesvd_routine = {
+    "gesvd", "Singular values and vectors (M x N, float, economy size)", false, gesvd_routine_flops, run_gesvd};
+BENCH_REGISTER_ROUTINE(gesvd_routine);
+
+// geqrf: Householder QR of general M x N matrices
+bool run_geqrf(const RoutineConfig &config, const SolverBackend &backend, RoutineTimes *times) {
+  if (!backend.solve_qr) return false;
+  int M = config.M, N = config.N, lda = M;
+  int k = (M < N) ? M : N;
+  size_t strideA = (size_t)lda * N;
+  size_t size_A = strideA * config.batch_count;
+  BatchShape shape = {M, N, lda, strideA, config.batch_count, config.tolerance, config.max_sweeps};
+  double *hA = create_general_matrices<double>(M, N, lda, strideA, config.batch_count, config.random_seed);
+
+  double *dA = (double*)backend.allocate(sizeof(double) * size_A);
+  double *dTau = (double*)backend.allocate(sizeof(double) * k * config.batch_count);
+
+  time_routine(config, backend,
+               [&]() { backend.copy_to_backend(dA, hA, sizeof(double) * size_A); },
+               [&]() { backend.solve_qr(shape, dA, dTau); },
+               times);
+  times->failures = 0;
+
+  backend.release(dA);
+  backend.release(dTau);
+  free(hA);
+  return true;
+}
+
+static const Routine geqrf_routine = {
+    "geqrf", "Householder QR (M x N, double)", false, geqrf_flops, run_geqrf};
+BENCH_REGISTER_ROUTINE(geqrf_routine);
+
+// The "tuned" backend: solve_batched() on the table bound here, that of the job being run
+// (--table), to check the dispatch against the backends it chooses from. solverbench tune times
+// every strategy through it too, so device strategies pay the staging solve_batched adds.
+static const TuneTable *tuned_table = NULL;
+
+void tuned_solve_eigen(const BatchShape &shape, float *A, float *W, int *info) {
+  solve_batched(*tuned_table, shape, A, W, info);
+}
+
+void tuned_solve_svd(const BatchShape &shape, float *A, float *S, float *U, float *VT, int *info) {
+  solve_batched(*tuned_table, shape, A, S, U, VT, info);
+}
+
+void tuned_solve_qr(const BatchShape &shape, double *A, double *tau) {
+  solve_batched(*tuned_table, shape, A, tau);
+}
+
+const SolverBackend &tuned_backend() {
+  static const SolverBackend backend = {
+      "tuned", "solve_batched() with the strategies of --table",
+      host_allocate, host_release, host_copy, host_copy,
+      tuned_solve_eigen, NULL, tuned_solve_svd, tuned_solve_qr, host_synchronize};
+  return backend;
+}
+
+// A routine, one configuration and the backends to run it on.
+struct BenchJob {
+  const Routine *routine;
+  RoutineConfig config;
+  std::vector<const SolverBackend*> backends;
+  Isa isa;           // kernels of the native backend
+  TuneTable table;   // strategies of the tuned backend
+};
+
+// Split a list separated by spaces or commas.
+std::vector<std::string> split_list(std::string list) {
+  std::replace(list.begin(), list.end(), ',', ' ');
+  std::istringstream iss(list);
+  std::vector<std::string> items;
+  std::string item;
+  while (iss >> item) items.push_back(item);
+  return items;
+}
+
+// Parse "<routine> <options>" into a job. Prints the error and the routine's help on failure.
+bool parse_job(const std::vector<std::string> &args, BenchJob *job) {
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("solverbench " + args[0]);
+
+  program.add_argument("--backend")
+      .help("Backends to run on, separated by spaces or commas (" + backend_names() + ", lapack:<provider>, tuned)")
+      .default_value(backend_names());
+
+  program.add_argument("--isa")
+      .help("Instruction set of the native backend's kernels (auto, generic, avx2, avx512)")
+      .default_value(std::string("auto"));
+
+  program.add_argument("--table")
+      .help("Tune table of the tuned backend (solverbench tune)");
+
+  program.add_argument("-m", "--rows")
+      .help("Number of rows (M, ignored for syev and syevd)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-n", "--size")
+      .help("Matrix size (N x N for syev and syevd, number of columns otherwise)")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-b", "--batch-count")
+      .help("Batch count")
+      .default_value(2)
+      .scan<'i', int>();
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of iterations for timing")
+      .default_value(10)
+      .scan<'i', int>();
+
+  program.add_argument("-w", "--warmup-time")
+      .help("Warm-up time in milliseconds before timing")
+      .default_value(200)
+      .scan<'i', int>();
+
+  program.add_argument("-t", "--tolerance")
+      .help("Tolerance for the Jacobi backends (<= 0: machine precision)")
+      .default_value(0.0f)
+      .scan<'f', float>();
+
+  program.add_argument("-j", "--max-sweeps")
+      .help("Maximum number of sweeps for the Jacobi backends")
+      .default_value(100)
+      .scan<'i', int>();
+
+  // 引数の解析
+  try {
+    program.parse_args(args);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return false;
+  }
+
+  // 値の取得
+  job->routine = find_routine(args[0]);
+  job->config.M = program.get<int>("--rows");
+  job->config.N = program.get<int>("--size");
+  job->config.batch_count = program.get<int>("--batch-count");
+  job->config.random_seed = program.get<int>("--random-seed");
+  job->config.iterations = program.get<int>("--iterations");
+  job->config.warmup_time = program.get<int>("--warmup-time");
+  job->config.tolerance = program.get<float>("--tolerance");
+  job->config.max_sweeps = program.get<int>("--max-sweeps");
+  job->config.validate_threshold = 0.0f;
+  for (const char *option : {"--rows", "--size", "--batch-count", "--iterations"}) {
+    if (program.get<int>(option) < 1) {
+      std::cerr << "Invalid " << option << ": " << program.get<int>(option) << " (must be at least 1)" << std::endl;
+      std::cerr << program;
+      return false;
+    }
+  }
+  if (job->routine->square) job->config.M = job->config.N;
+
+  std::string isa_str = program.get<std::string>("--isa");
+  if (!parse_isa(isa_str, &job->isa)) {
+    std::cerr << "Unknown ISA: " << isa_str << std::endl;
+    std::cerr << program;
+    return false;
+  }
+  if (!isa_supported(job->isa)) {
+    std::cerr << "ISA not supported by this CPU: " << isa_str << " (supported: " << isa_supported_names() << ")" << std::endl;
+    return false;
+  }
+
+  job->table.entries.clear();
+  if (program.present("--table")) {
+    std::string table_error;
+    if (!tune_table_load(program.get<std::string>("--table"), &job->table, &table_error)) {
+      std::cerr << table_error << std::endl;
+      return false;
+    }
+  }
+
+  job->backends.clear();
+  for (const std::string &name : split_list(program.get<std::string>("--backend"))) {
+    if (name == "tuned") {
+      if (!program.present("--table")) {
+        std::cerr << "--backend tuned needs --table" << std::endl;
+        std::cerr << program;
+        return false;
+      }
+      job->backends.push_back(&tuned_backend());
+      continue;
+    }
+    std::string backend_error;
+    const SolverBackend *backend = find_backend(name, &backend_error);
+    if (!backend) {
+      print_backend_error(name, backend_error);
+      std::cerr << program;
+      return false;
+    }
+    job->backends.push_back(backend);
+  }
+  if (job->backends.empty()) {
+    std::cerr << "No backend given" << std::endl;
+    std::cerr << program;
+    return false;
+  }
+  return true;
+}
+
+// Measure every strategy on a grid of routines, shapes and batch counts and save the winners.
+// Strategies whose results fail the validate.hpp checks are dropped before ranking.
+int run_tune(const std::vector<std::string> &args) {
+  int max_threads = omp_get_max_threads();
+
+  // ArgumentParserの設定
+  argparse::ArgumentParser program("solverbench tune");
+
+  program.add_argument("--routines")
+      .help("Routines to tune, separated by spaces or commas")
+      .default_value(std::string("syev gesvd geqrf"));
+
+  program.add_argument("--shapes")
+      .help("Matrix shapes, N (N x N) or MxN; syev takes the square ones")
+      .default_value(std::string("8 16 32 64"));
+
+  program.add_argument("--batches")
+      .help("Batch counts")
+      .default_value(std::string("1 16 256"));
+
+  program.add_argument("--backend")
+      .help("Backends to measure (" + backend_names() + ", lapack:<provider>)")
+      .default_value(backend_names());
+
+  program.add_argument("--isas")
+      .help("Instruction sets of the native backend (default: all supported)")
+      .default_value(isa_supported_names());
+
+  program.add_argument("--threads")
+      .help("OpenMP thread counts to split the batch over (default: 1 and all)")
+      .default_value(max_threads > 1 ? "1 " + std::to_string(max_threads) : std::string("1"));
+
+  program.add_argument("-r", "--random-seed")
+      .help("Random seed for matrix generation")
+      .default_value(42)
+      .scan<'i', int>();
+
+  program.add_argument("-i", "--iterations")
+      .help("Number of iterations for timing")
+      .default_value(5)
+      .scan<'i', int>();
+
+  program.add_argument("-w", "--warmup-time")
+      .help("Warm-up time in milliseconds before timing")
+      .default_value(20)
+      .scan<'i', int>();
+
+  program.add_argument("--validate-threshold")
+      .help("Drop strategies whose results fail validation, threshold in units of n * machine epsilon")
+      .default_value(100.0f)
+      .scan<'f', float>();
+
+  program.add_argument("-o", "--output")
+      .help("Tune table to write")
+      .default_value(std::string("solverbench.table"));
+
+  // 引数の解析
+  try {
+    program.parse_args(args);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // 値の取得
+  int random_seed = program.get<int>("--random-seed");
+  int iterations = program.get<int>("--iterations");
+  int warmup_time = program.get<int>("--warmup-time");
+  float validate_threshold = program.get<float>("--validate-threshold");
+  std::string output = program.get<std::string>("--output");
+
+  std::vector<const Routine*> routines;
+  for (const std::string &name : split_list(program.get<std::string>("--routines"))) {
+    const Routine *routine = find_routine(name);
+    if (!routine) {
+      std::cerr << "Unknown routine: " << name << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+    routines.push_back(routine);
+  }
+
+  std::vector<std::pair<int, int>> shapes;
+  for (const std::string &shape : split_list(program.get<std::string>("--shapes"))) {
+    int M, N;
+    char x, extra;
+    std::istringstream iss(shape);
+    if (shape.find('x') == std::string::npos) {
+      if (!(iss >> N) || iss >> extra) N = 0;
+      M = N;
+    } else if (!(iss >> M >> x >> N) || x != 'x' || iss >> extra) {
+      M = N = 0;
+    }
+    if (M < 1 || N < 1) {
+      std::cerr << "Invalid shape: " << shape << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+    shapes.push_back({M, N});
+  }
+
+  std::vector<int> batches;
+  for (const std::string &batch : split_list(program.get<std::string>("--batches"))) {
+    int batch_count = atoi(batch.c_str());
+    if (batch_count < 1) {
+      std::cerr << "Invalid batch count: " << batch << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+    batches.push_back(batch_count);
+  }
+
+  std::vector<int> thread_counts;
+  for (const std::string &threads : split_list(program.get<std::string>("--threads"))) {
+    int t = atoi(threads.c_str());
+    if (t < 1) {
+      std::cerr << "Invalid thread count: " << threads << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+    thread_counts.push_back(t);
+  }
+
+  std::vector<Isa> isas;
+  for (const std::string &name : split_list(program.get<std::string>("--isas"))) {
+    Isa isa;
+    if (!parse_isa(name, &isa) || !isa_supported(isa)) {
+      std::cerr << "ISA not supported by this CPU: " << name << " (supported: " << isa_supported_names() << ")" << std::endl;
+      return 1;
+    }
+    isas.push_back(isa);
+  }
+
+  // the strategies: every backend, native once per ISA, host backends once per thread count
+  std::vector<TuneStrategy> candidates;
+  for (const std::string &name : split_list(program.get<std::string>("--backend"))) {
+    std::string backend_error;
+    const SolverBackend *backend = find_backend(name, &backend_error);
+    if (!backend) {
+      print_backend_error(name, backend_error);
+      std::cerr << program;
+      return 1;
+    }
+    std::vector<Isa> backend_isas = (backend == &native_backend()) ? isas : std::vector<Isa>{isa_best()};
+    std::vector<int> backend_threads = solve_batched_on_host(backend) ? thread_counts : std::vector<int>{0};
+    for (Isa isa : backend_isas) {
+      for (int threads : backend_threads) {
+        candidates.push_back({backend->name, isa, threads});
+      }
+    }
+  }
+
+  // measure the grid
+  struct TuneResult {
+    TuneEntry best;
+    std::string second;
+    float second_ms;
+  };
+  std::vector<TuneResult> results;
+  TuneTable table;
+
+  for (const Routine *routine : routines) {
+    for (const std::pair<int, int> &shape : shapes) {
+      if (routine->square && shape.first != shape.second) continue;
+      for (int batch_count : batches) {
+        RoutineConfig config = {shape.first, shape.second, batch_count, random_seed, iterations, warmup_time,
+                                0.0f, 100, validate_threshold};
+        printf("Tuning %s %d x %d, batch %d...\n", routine->name, config.M, config.N, batch_count);
+
+        TuneResult result = {{routine->name, config.M, config.N, batch_count, "", 0.0f}, "-", 0.0f};
+        for (const TuneStrategy &strategy : candidates) {
+          // a table of this strategy alone, run the way solve_batched will run it
+          std::string name = tune_strategy_name(strategy);
+          TuneTable single;
+          single.entries.push_back({routine->name, config.M, config.N, batch_count, name, 0.0f});
+          tuned_table = &single;
+          RoutineTimes times = {};
+          bool supported = routine->run(config, tuned_backend(), &times);
+          if (!supported || times.timings.empty() || times.failures) continue;
+          if (times.validation_failures) {
+            printf("  %s dropped: %d failed validation checks\n", name.c_str(), times.validation_failures);
+            continue;
+          }
+
+          float avg_time = 0.0f;
+          for (float t : times.timings) avg_time += t;
+          avg_time /= times.timings.size();
+
+          if (result.best.strategy.empty() || avg_time < result.best.time_ms) {
+            if (!result.best.strategy.empty()) {
+              result.second = result.best.strategy;
+              result.second_ms = result.best.time_ms;
+            }
+            result.best.strategy = name;
+            result.best.time_ms = avg_time;
+          } else if (result.second_ms == 0.0f || avg_time < result.second_ms) {
+            result.second = name;
+            result.second_ms = avg_time;
+          }
+        }
+        if (result.best.strategy.empty()) continue;
+        results.push_back(result);
+        table.entries.push_back(result.best);
+      }
+    }
+  }
+
+  if (!tune_table_save(table, output)) {
+    std::cerr << "Cannot write " << output << std::endl;
+    return 1;
+  }
+
+  // print the winners
+  printf("\n===== solverbench Tune =====\n");
+  printf("Strategies: %zu per point, %d iterations each\n", candidates.size(), iterations);
+#ifdef BENCH_HAVE_OPENBLAS
+  printf("Validation: syev and gesvd results within %g n eps, geqrf not validated\n", validate_threshold);
+#else
+  printf("Validation: none (needs OpenBLAS for the host products)\n");
+#endif
+  printf("%-7s %11s %7s %-22s %10s %-22s %10s %7s\n", "routine", "shape", "batch", "fastest", "avg ms",
+         "runner-up", "avg ms", "gain");
+  for (const TuneResult &r : results) {
+    char shape[32];
+    snprintf(shape, sizeof(shape), "%dx%d", r.best.M, r.best.N);
+    printf("%-7s %11s %7d %-22s %10.3f ", r.best.routine.c_str(), shape, r.best.batch_count,
+           r.best.strategy.c_str(), r.best.time_ms);
+    if (r.second_ms > 0.0f) printf("%-22s %10.3f %6.2fx\n", r.second.c_str(), r.second_ms, r.second_ms / r.best.time_ms);
+    else printf("%-22s %10s %7s\n", "-", "-", "-");
+  }
+  printf("Table: %s (%zu entries)\n", output.c_str(), table.entries.size());
+  printf("============================\n\n");
+  print_environment();
+
+  return 0;
+}
+
+void print_usage() {
+  std::cerr << "Usage: solverbench <routine> [options]  (solverbench <routine> --help for the options)" << std::endl;
+  std::cerr << "       solverbench run <file>           (one \"<routine> [options]\" per line)" << std::endl;
+  std::cerr << "       solverbench tune [options]       (solverbench tune --help for the options)" << std::endl;
+  std::cerr << "       solverbench list" << std::endl;
+  std::cerr << "Routines:";
+  for (const Routine *routine : routine_registry()) std::cerr << " " << routine->name;
+  std::cerr << std::endl << "Backends: " << backend_names() << std::endl;
+}
+
+// Run registered routines on the backends of this build, one configuration or a file of them.
+int main(int argc, char *argv[]) {
+  std::string command = (argc > 1) ? argv[1] : "";
+  std::vector<BenchJob> jobs;
+
+  if (command == "list") {
+    printf("Routines:\n");
+    for (const Routine *routine : routine_registry()) printf("  %-8s %s\n", routine->name, routine->description);
+    printf("Backends:\n");
+    for (const SolverBackend *backend : solver_backends()) printf("  %-10s %s\n", backend->name, backend->description);
+    printf("LAPACK providers (--backend lapack:<provider or library path>):\n");
+    for (const std::string &provider : lapack_provider_names()) {
+      LapackProvider p;
+      std::string error;
+      if (lapack_provider_open(provider, &p, &error)) {
+        printf("  %-10s %s%s, threading: %s\n", provider.c_str(), p.path.c_str(),
+               p.config.empty() ? "" : (" (" + p.config + ")").c_str(), lapack_provider_threading(p));
+        lapack_provider_close(&p);
+      } else {
+        printf("  %-10s not available (%s)\n", provider.c_str(), error.c_str());
+      }
+    }
+    return 0;
+  } else if (command == "tune") {
+    return run_tune(std::vector<std::string>(argv + 1, argv + argc));
+  } else if (command == "run" && argc == 3) {
+    std::ifstream file(argv[2]);
+    if (!file) {
+      std::cerr << "Cannot read " << argv[2] << std::endl;
+      return 1;
+    }
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+      line_number++;
+      line = line.substr(0, line.find('#'));
+      std::istringstream iss(line);
+      std::vector<std::string> args;
+      std::string token;
+      while (iss >> token) args.push_back(token);
+      if (args.empty()) continue;
+
+      if (!find_routine(args[0])) {
+        std::cerr << argv[2] << ":" << line_number << ": Unknown routine: " << args[0] << std::endl;
+        print_usage();
+        return 1;
+      }
+      BenchJob job;
+      if (!parse_job(args, &job)) {
+        std::cerr << "in " << argv[2] << ":" << line_number << std::endl;
+        return 1;
+      }
+      jobs.push_back(job);
+    }
+  } else if (find_routine(command)) {
+    BenchJob job;
+    if (!parse_job(std::vector<std::string>(argv + 1, argv + argc), &job)) return 1;
+    jobs.push_back(job);
+  } else {
+    if (!command.empty()) std::cerr << "Unknown routine: " << command << std::endl;
+    print_usage();
+    return 1;
+  }
+
+  // run every job on each of its backends
+  struct ResultRow {
+    const BenchJob *job;
+    const SolverBackend *backend;
+    Isa isa;
+    bool supported;
+    RoutineTimes times;
+  };
+  std::vector<ResultRow> rows;
+
+  for (const BenchJob &job : jobs) {
+    for (const SolverBackend *backend : job.backends) {
+      select_native_isa(job.isa);
+      tuned_table = &job.table;
+      printf("Running %s %d x %d, batch %d on %s...\n", job.routine->name, job.config.M, job.config.N,
+             job.config.batch_count, backend->name);
+      ResultRow row = {&job, backend, job.isa, false, {}};
+      row.supported = job.routine->run(job.config, *backend, &row.times);
+      rows.push_back(row);
+    }
+  }
+
+  // print timing results; "vs first" is relative to the first backend of the same job, the native
+  // backend is shown with the ISA of its kernels
+  printf("\n===== solverbench Results =====\n");
+  printf("%-7s %11s %7s %-22s %10s %10s %10s %11s %9s %8s %5s\n", "routine", "shape", "batch", "backend",
+         "first ms", "avg ms", "min ms", "us/matrix", "GFLOPS", "vs first", "fails");
+  float first_avg = 0.0f;
+  for (const ResultRow &row : rows) {
+    const RoutineConfig &config = row.job->config;
+    char shape[32];
+    snprintf(shape, sizeof(shape), "%dx%d", config.M, config.N);
+    std::string backend_label = row.backend->name;
+    if (row.backend == &native_backend()) backend_label += std::string("/") + isa_name(row.isa);
+    if (row.backend == &tuned_backend()) {
+      const TuneEntry *entry = tune_table_lookup(row.job->table, row.job->routine->name, config.M, config.N,
+                                                 config.batch_count);
+      backend_label += ":" + (entry ? entry->strategy : std::string("fallback"));
+    }
+    printf("%-7s %11s %7d %-22s ", row.job->routine->name, shape, config.batch_count, backend_label.c_str());
+    if (row.backend == row.job->backends.front()) first_avg = 0.0f;
+    if (!row.supported || row.times.timings.empty()) {
+      printf("%10s\n", "n/a");
+      continue;
+    }
+
+    float avg_time = 0.0f;
+    for (float t : row.times.timings) avg_time += t;
+    avg_time /= row.times.timings.size();
+    float min_time = *std::min_element(row.times.timings.begin(), row.times.timings.end());
+    double gflops = row.job->routine->flops(config.M, config.N) * config.batch_count / (avg_time * 1e6);
+    if (row.backend == row.job->backends.front()) first_avg = avg_time;
+
+    printf("%10.3f %10.3f %10.3f %11.3f %9.2f ", row.times.first_ms, avg_time, min_time,
+           avg_time * 1000.0f / config.batch_count, gflops);
+    if (first_avg > 0.0f) printf("%7.2fx %5d\n", first_avg / avg_time, row.times.failures);
+    else printf("%8s %5d\n", "-", row.times.failures);
+  }
+  printf("==============================\n\n");
+  print_environment();
+
+  return 0;
+}